@@ -0,0 +1,119 @@
+#include <hydra/kernel.h>
+#include <hydra/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// measures moving data through a pipe from one process to another
+
+#define TRANSFER_SIZE (16 * 1024 * 1024)
+#define MAX_CHUNK_SIZE (64 * 1024)
+
+typedef struct
+{
+    size_t capacity;
+    size_t chunk_size;
+} pipe_config_t;
+
+static const pipe_config_t configs[] = {
+    {4096, 512},
+    {4096, 4096},
+    {4096, 64 * 1024},
+    {64 * 1024, 4096},
+    {64 * 1024, 64 * 1024},
+};
+
+// the child reads until the end of the file and reports how much it got
+static void sink(int data_fd, int result_fd, char *buffer, size_t chunk_size)
+{
+    uint64_t total = 0;
+    int64_t n;
+    while ((n = (int64_t)syscall_read((uint64_t)data_fd, (uint8_t *)buffer, chunk_size)) > 0)
+    {
+        total += (uint64_t)n;
+    }
+
+    syscall_write((uint64_t)result_fd, (const uint8_t *)&total, sizeof(total));
+    syscall_exit(0);
+}
+
+static int measure(const pipe_config_t *config, char *buffer)
+{
+    int data[2];
+    int result[2];
+    if (syscall_pipe(data, config->capacity) < 0 || syscall_pipe(result, 0) < 0)
+    {
+        fputs("failed to create the pipes\n", stdout);
+        return 1;
+    }
+
+    int64_t pid = (int64_t)syscall_fork();
+    if (pid == 0)
+    {
+        syscall_close((uint64_t)data[1]);
+        syscall_close((uint64_t)result[0]);
+        sink(data[0], result[1], buffer, config->chunk_size);
+    }
+
+    syscall_close((uint64_t)data[0]);
+    syscall_close((uint64_t)result[1]);
+
+    uint64_t start = time_get_ns();
+    size_t written = 0;
+    while (written < TRANSFER_SIZE)
+    {
+        int64_t n = (int64_t)syscall_write((uint64_t)data[1], (const uint8_t *)buffer, config->chunk_size);
+        if (n <= 0)
+        {
+            break;
+        }
+        written += (size_t)n;
+    }
+    syscall_close((uint64_t)data[1]);
+
+    // the sink answers once it has seen the end of the file
+    uint64_t received = 0;
+    int64_t n = (int64_t)syscall_read((uint64_t)result[0], (uint8_t *)&received, sizeof(received));
+    uint64_t elapsed = time_get_ns() - start;
+    syscall_close((uint64_t)result[0]);
+
+    if (n != sizeof(received) || received != written)
+    {
+        printf("capacity %lu, %lu byte chunks: wrote %lu bytes, the reader got %lu\n", config->capacity, config->chunk_size, written, received);
+        return 1;
+    }
+
+    if (elapsed == 0)
+    {
+        elapsed = 1;
+    }
+
+    uint64_t kib_per_s = (uint64_t)received * 1000000000 / elapsed / 1024;
+    printf("capacity %lu, %lu byte chunks: %lu us, %lu.%02lu MiB/s\n", config->capacity, config->chunk_size, elapsed / 1000,
+           kib_per_s / 1024, (kib_per_s % 1024) * 100 / 1024);
+
+    return 0;
+}
+
+int main(void)
+{
+    char *buffer = malloc(MAX_CHUNK_SIZE);
+    if (!buffer)
+    {
+        fputs("out of memory\n", stdout);
+        return 1;
+    }
+
+    printf("moving %d MiB between two processes\n", TRANSFER_SIZE / 1024 / 1024);
+
+    for (size_t i = 0; i < sizeof(configs) / sizeof(configs[0]); i++)
+    {
+        if (measure(&configs[i], buffer) != 0)
+        {
+            free(buffer);
+            return 1;
+        }
+    }
+
+    free(buffer);
+    return 0;
+}
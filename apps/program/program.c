@@ -1,5 +1,6 @@
 #include <hydra/kernel.h>
 #include <hydra/video.h>
+#include <hydra/time.h>
 #include <canvas/canvas.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -8,6 +9,10 @@
 canvas_icon_t load_png_from_file(const char *path);
 void free_image(canvas_icon_t *img);
 
+#define FRAME_RATE 60
+#define FRAME_NS (NSEC_PER_SEC / FRAME_RATE)
+#define FRAME_COUNT (FRAME_RATE * 5)
+
 int main(int argc, char **argv)
 {
     video_rect_t rect;
@@ -31,8 +36,6 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    canvas_fill(0xFF202020);
-
     canvas_icon_t icon = load_png_from_file("/resources/logo-small.png");
     if (!icon.pixels)
     {
@@ -40,11 +43,44 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    canvas_draw_icon_scaled(icon.width / 2, 0, rect.height, rect.height, &icon);
+    uint32_t size = rect.height / 2;
+    uint32_t max_x = rect.width > size ? rect.width - size : 0;
+    uint32_t x = 0;
+    int dx = 4;
 
-    free_image(&icon);
+    // timestamps come from the time page, so pacing costs no syscalls
+    uint64_t start = time_get_ns();
+    uint64_t deadline = start;
+    uint64_t missed = 0;
+
+    for (int frame = 0; frame < FRAME_COUNT; frame++)
+    {
+        canvas_fill(0xFF202020);
+        canvas_draw_icon_scaled(x, rect.height / 4, size, size, &icon);
+        update_display(fb, &rect);
+
+        if ((dx < 0 && x < (uint32_t)-dx) || (dx > 0 && x + dx > max_x))
+        {
+            dx = -dx;
+        }
+        x += dx;
 
-    update_display(fb, &rect);
+        deadline += FRAME_NS;
+        uint64_t now = time_get_ns();
+        if (now > deadline)
+        {
+            missed++;
+            deadline = now;
+            continue;
+        }
+
+        syscall_nanosleep(deadline - now);
+    }
+
+    uint64_t elapsed = time_get_ns() - start;
+    printf("%d frames in %lu ms, %lu missed deadlines\n", FRAME_COUNT, elapsed / 1000000, missed);
+
+    free_image(&icon);
 
     return 0;
 }
@@ -0,0 +1,85 @@
+#include <hydra/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// compares reading a file with small and large read syscalls
+
+#define READ_FILE "/resources/logo.png"
+#define SAMPLES 4
+
+static int measure(FILE *f, char *buffer, size_t chunk_size)
+{
+    uint64_t best_ns = 0;
+    size_t total = 0;
+
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        fseek(f, 0, SEEK_SET);
+
+        size_t read = 0;
+        uint64_t start = time_get_ns();
+        for (;;)
+        {
+            size_t n = fread(buffer, 1, chunk_size, f);
+            if (n == 0)
+            {
+                break;
+            }
+            read += n;
+        }
+        uint64_t elapsed = time_get_ns() - start;
+
+        if (read == 0)
+        {
+            printf("%lu byte reads: nothing was read\n", chunk_size);
+            return 1;
+        }
+
+        total = read;
+        if (best_ns == 0 || elapsed < best_ns)
+        {
+            best_ns = elapsed;
+        }
+    }
+
+    if (best_ns == 0)
+    {
+        best_ns = 1;
+    }
+
+    uint64_t kib_per_s = (uint64_t)total * 1000000000 / best_ns / 1024;
+    printf("%lu byte reads: %lu bytes in %lu us, %lu.%02lu MiB/s\n", chunk_size, total, best_ns / 1000,
+           kib_per_s / 1024, (kib_per_s % 1024) * 100 / 1024);
+
+    return 0;
+}
+
+int main(void)
+{
+    FILE *f = fopen(READ_FILE, "r");
+    if (!f)
+    {
+        fputs("failed to open " READ_FILE "\n", stdout);
+        return 1;
+    }
+
+    char *buffer = malloc(1024 * 1024);
+    if (!buffer)
+    {
+        fputs("out of memory\n", stdout);
+        fclose(f);
+        return 1;
+    }
+
+    printf("reading " READ_FILE ", best of %d\n", SAMPLES);
+
+    int status = measure(f, buffer, 4 * 1024);
+    if (status == 0)
+    {
+        status = measure(f, buffer, 1024 * 1024);
+    }
+
+    free(buffer);
+    fclose(f);
+    return status;
+}
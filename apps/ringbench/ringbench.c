@@ -0,0 +1,94 @@
+#include <hydra/kernel.h>
+#include <hydra/ring.h>
+#include <hydra/time.h>
+#include <stdio.h>
+
+// compares small positional reads issued one syscall at a time with the same reads batched through the ring
+
+#define READ_FILE "/resources/logo.png"
+#define READ_SIZE 512
+#define NUM_READS 256
+
+static char buffers[NUM_READS][READ_SIZE];
+
+static int measure_syscalls(uint64_t stream)
+{
+    uint64_t start = time_get_ns();
+    for (int i = 0; i < NUM_READS; i++)
+    {
+        if (syscall_pread(stream, (uint8_t *)buffers[i], READ_SIZE, (size_t)i * READ_SIZE) < 0)
+        {
+            printf("pread %d failed\n", i);
+            return 1;
+        }
+    }
+    uint64_t elapsed = time_get_ns() - start;
+
+    printf("%d preads: %lu us, %d syscalls\n", NUM_READS, elapsed / 1000, NUM_READS);
+    return 0;
+}
+
+static int measure_ring(ring_t *ring, uint64_t stream)
+{
+    uint64_t start = time_get_ns();
+    for (int i = 0; i < NUM_READS; i++)
+    {
+        ring_sqe_t *sqe = ring_get_sqe(ring);
+        sqe->opcode = RING_OP_READ;
+        sqe->stream = (int64_t)stream;
+        sqe->addr = (uint64_t)buffers[i];
+        sqe->len = READ_SIZE;
+        sqe->offset = (int64_t)i * READ_SIZE;
+        sqe->user_data = (uint64_t)i;
+    }
+
+    int64_t submitted = ring_submit(ring, NUM_READS, 0);
+
+    int failed = 0;
+    for (int i = 0; i < NUM_READS; i++)
+    {
+        ring_cqe_t *cqe = ring_wait_cqe(ring);
+        if (!cqe)
+        {
+            printf("ring: only %d of %d reads completed\n", i, NUM_READS);
+            return 1;
+        }
+
+        if (cqe->result < 0)
+        {
+            failed++;
+        }
+        ring_cqe_seen(ring);
+    }
+    uint64_t elapsed = time_get_ns() - start;
+
+    printf("%d ring reads: %lu us, 1 syscall, %ld submitted, %d failed\n", NUM_READS, elapsed / 1000, submitted, failed);
+    return failed != 0;
+}
+
+int main(void)
+{
+    FILE *f = fopen(READ_FILE, "r");
+    if (!f)
+    {
+        fputs("failed to open " READ_FILE "\n", stdout);
+        return 1;
+    }
+
+    ring_t ring;
+    if (ring_init(&ring, NUM_READS) < 0)
+    {
+        fputs("failed to set up the ring\n", stdout);
+        fclose(f);
+        return 1;
+    }
+
+    int status = measure_syscalls((uint64_t)f);
+    if (status == 0)
+    {
+        status = measure_ring(&ring, (uint64_t)f);
+    }
+
+    fclose(f);
+    return status;
+}
@@ -0,0 +1,104 @@
+#include <hydra/kernel.h>
+#include <hydra/time.h>
+#include <stdio.h>
+
+// measures how late a 1 ms sleeper wakes up while another process keeps the disk busy
+
+#define SLEEP_NS 1000000ULL
+#define SAMPLES 1000
+
+#define LOAD_FILE "/bin/program"
+#define LOAD_PASSES 16
+
+static char buffer[4096] __attribute__((aligned(4096)));
+
+static void disk_load(void)
+{
+    for (int pass = 0; pass < LOAD_PASSES; pass++)
+    {
+        FILE *f = fopen(LOAD_FILE, "r");
+        if (!f)
+        {
+            fputs("failed to open " LOAD_FILE "\n", stdout);
+            syscall_exit(1);
+        }
+
+        fseek(f, 0, SEEK_END);
+        size_t size = ftell(f);
+        fseek(f, 0, SEEK_SET);
+
+        for (size_t offset = 0; offset < size; offset += sizeof(buffer))
+        {
+            size_t n = size - offset < sizeof(buffer) ? size - offset : sizeof(buffer);
+            fread(buffer, 1, n, f);
+        }
+
+        fclose(f);
+    }
+
+    syscall_exit(0);
+}
+
+static void print_latency(const char *name, const sched_latency_t *latency)
+{
+    if (latency->count == 0)
+    {
+        printf("%s: no samples\n", name);
+        return;
+    }
+
+    printf("%s: %lu samples, avg %lu us, max %lu us\n", name, latency->count, latency->total_ns / latency->count / 1000, latency->max_ns / 1000);
+    for (int i = 0; i < SCHED_LATENCY_BUCKETS; i++)
+    {
+        if (latency->histogram[i])
+        {
+            printf("  < %lu us: %lu\n", 2UL << i, latency->histogram[i]);
+        }
+    }
+}
+
+int main(void)
+{
+    int64_t pid = syscall_fork();
+    if (pid == 0)
+    {
+        disk_load();
+    }
+
+    sched_latency_t sleep_latency = {0};
+    while (sleep_latency.count < SAMPLES && syscall_ping(pid) == (uint64_t)pid)
+    {
+        uint64_t start = time_get_ns();
+        syscall_nanosleep(SLEEP_NS);
+        uint64_t elapsed = time_get_ns() - start;
+        uint64_t late = elapsed > SLEEP_NS ? elapsed - SLEEP_NS : 0;
+
+        sleep_latency.count++;
+        sleep_latency.total_ns += late;
+        if (late > sleep_latency.max_ns)
+        {
+            sleep_latency.max_ns = late;
+        }
+
+        int bucket = 0;
+        while (bucket < SCHED_LATENCY_BUCKETS - 1 && late / 1000 >= (2UL << bucket))
+        {
+            bucket++;
+        }
+        sleep_latency.histogram[bucket]++;
+    }
+
+    sched_stats_t stats;
+    if (syscall_sched_stats(&stats) < 0)
+    {
+        fputs("failed to get scheduler stats\n", stdout);
+        return 1;
+    }
+
+    print_latency("sleep overshoot", &sleep_latency);
+    print_latency("kernel wakeup", &stats.wakeup);
+    print_latency("kernel preemption", &stats.preempt);
+    printf("%lu context switches\n", stats.switches);
+
+    return 0;
+}
@@ -28,6 +28,10 @@ char *shell_getline(char *line)
     uint8_t size = 0;
     while (size < 49)
     {
+        // sleeps until there is input instead of spinning on the keyboard
+        poll_fd_t input = {.fd = (int32_t)(uint64_t)stdin, .events = POLLIN, .revents = 0};
+        syscall_poll(&input, 1, -1);
+
         char ascii = fgetc(stdin);
         if (ascii == 0)
         {
@@ -164,57 +168,48 @@ int shell_launch(char **args)
         return 1;
     }
 
-    int fd = syscall_pipe();
-    if (fd < 0)
+    int fds[2];
+    if (syscall_pipe(fds, 0) < 0)
     {
         fputs("failed to pipe\n", stdout);
+        free(path);
+        return 1;
     }
 
-    int64_t pid = syscall_fork();
+    uint16_t num_args;
+    for (num_args = 0; args[num_args] != NULL; num_args++);
+
+    process_create_info_t create_info = {
+        .args = (const char **)args,
+        .num_args = num_args,
+        .envars = NULL,
+        .num_envars = 0,
+        .stdin_idx = (uint64_t)stdin,
+        .stdout_idx = (uint64_t)fds[1],
+        .stderr_idx = (uint64_t)stderr,
+    };
+
+    int64_t pid = syscall_spawn(path, &create_info);
+    free(path);
+
+    // the child holds its own write end, the pipe reaches its end once the child is gone
+    syscall_close((uint64_t)fds[1]);
+
     if (pid < 0)
     {
-        fputs("failed to fork process\n", stdout);
-        free(path);
-        syscall_exit(1);
-    }
-    
-    if (pid == 0)
-    {
-        uint16_t num_args;
-        for (num_args = 0; args[num_args] != NULL; num_args++);
-
-        process_create_info_t create_info = {
-            .args = (const char **)args,
-            .num_args = num_args,
-            .envars = NULL,
-            .num_envars = 0,
-            .stdin_idx = (uint64_t)stdin,
-            .stdout_idx = (uint64_t)fd,
-            .stderr_idx = (uint64_t)stderr,
-        };
-        syscall_exec(path, &create_info);
-
         fputs("failed to execute process\n", stdout);
-        free(path);
-        syscall_exit(1);
+        syscall_close((uint64_t)fds[0]);
+        return 1;
     }
 
-    free(path);
-
-    char c = 0;
-    do
+    char buffer[256];
+    int64_t n;
+    while ((n = (int64_t)syscall_read((uint64_t)fds[0], (uint8_t *)buffer, sizeof(buffer))) > 0)
     {
-        c = fgetc((FILE *)fd);
-        if (c == 0)
-        {
-            continue;
-        }
-        
-        fputc(c, stdout);
+        syscall_write((uint64_t)stdout, (const uint8_t *)buffer, (size_t)n);
     }
-    while (syscall_ping(pid) == pid || c != 0);
 
-    syscall_close((uint64_t)fd);
+    syscall_close((uint64_t)fds[0]);
 
     return pid;
 }
@@ -0,0 +1,108 @@
+#include <hydra/kernel.h>
+#include <hydra/time.h>
+#include <stdio.h>
+
+// compares launching a program with fork + exec against spawn
+
+#define LAUNCH_FILE "/bin/program"
+#define SAMPLES 8
+
+typedef struct
+{
+    uint64_t launch_ns; // until the launcher can continue
+    uint64_t total_ns;  // until the child has exited
+} launch_result_t;
+
+static process_create_info_t create_info(void)
+{
+    process_create_info_t info = {
+        .args = NULL,
+        .num_args = 0,
+        .envars = NULL,
+        .num_envars = 0,
+        .stdin_idx = (uint64_t)stdin,
+        .stdout_idx = (uint64_t)stdout,
+        .stderr_idx = (uint64_t)stderr,
+    };
+    return info;
+}
+
+static int64_t launch_fork_exec(void)
+{
+    int64_t pid = syscall_fork();
+    if (pid == 0)
+    {
+        process_create_info_t info = create_info();
+        syscall_exec(LAUNCH_FILE, &info);
+
+        fputs("failed to execute " LAUNCH_FILE "\n", stdout);
+        syscall_exit(1);
+    }
+
+    return pid;
+}
+
+static int64_t launch_spawn(void)
+{
+    process_create_info_t info = create_info();
+    return syscall_spawn(LAUNCH_FILE, &info);
+}
+
+static int measure(const char *name, int64_t (*launch)(void))
+{
+    launch_result_t sum = {0};
+    launch_result_t max = {0};
+
+    for (int i = 0; i < SAMPLES; i++)
+    {
+        uint64_t start = time_get_ns();
+        int64_t pid = launch();
+        uint64_t launched = time_get_ns();
+        if (pid < 0)
+        {
+            printf("%s: launch failed\n", name);
+            return 1;
+        }
+
+        while (syscall_ping(pid) == (uint64_t)pid)
+        {
+            syscall_yield();
+        }
+        uint64_t exited = time_get_ns();
+
+        launch_result_t r = {launched - start, exited - start};
+        sum.launch_ns += r.launch_ns;
+        sum.total_ns += r.total_ns;
+        if (r.launch_ns > max.launch_ns)
+        {
+            max.launch_ns = r.launch_ns;
+        }
+        if (r.total_ns > max.total_ns)
+        {
+            max.total_ns = r.total_ns;
+        }
+    }
+
+    printf("%s: launch avg %lu us max %lu us, until exit avg %lu us max %lu us\n", name,
+           sum.launch_ns / SAMPLES / 1000, max.launch_ns / 1000,
+           sum.total_ns / SAMPLES / 1000, max.total_ns / 1000);
+
+    return 0;
+}
+
+int main(void)
+{
+    printf("launching " LAUNCH_FILE " %d times each\n", SAMPLES);
+
+    if (measure("fork + exec", &launch_fork_exec) != 0)
+    {
+        return 1;
+    }
+
+    if (measure("spawn", &launch_spawn) != 0)
+    {
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <hydra/kernel.h>
+#include <stdio.h>
+#include <string.h>
+
+// runs a program with syscall tracing and prints every call followed by a latency summary
+
+#define RECORD_BATCH 32
+
+static const char *const syscall_names[SYSCALL_COUNT] = SYSCALL_NAMES;
+static syscall_trace_record_t records[RECORD_BATCH];
+
+static void print_records(uint64_t pid)
+{
+    int64_t n;
+    while ((n = syscall_trace_read(pid, records, RECORD_BATCH)) > 0)
+    {
+        for (int64_t i = 0; i < n; i++)
+        {
+            syscall_trace_record_t *r = &records[i];
+            const char *name = r->num < SYSCALL_COUNT ? syscall_names[r->num] : "unknown";
+            printf("[%lu] %s(0x%lx, 0x%lx, 0x%lx) = %ld <%lu ns>\n", r->tid, name, r->args[0], r->args[1], r->args[2], r->result, r->duration_ns);
+        }
+    }
+}
+
+static void print_stats(const syscall_stats_t *stats)
+{
+    printf("%-24s %8s %10s %10s\n", "syscall", "calls", "avg ns", "max ns");
+    for (int i = 0; i < SYSCALL_COUNT; i++)
+    {
+        const syscall_stat_t *stat = &stats->calls[i];
+        if (stat->count == 0)
+        {
+            continue;
+        }
+
+        printf("%-24s %8lu %10lu %10lu\n", syscall_names[i], stat->count, stat->total_ns / stat->count, stat->max_ns);
+        for (int j = 0; j < SYSCALL_LATENCY_BUCKETS; j++)
+        {
+            if (stat->histogram[j])
+            {
+                printf("    < %lu ns: %lu\n", 256UL << j, stat->histogram[j]);
+            }
+        }
+    }
+
+    if (stats->dropped)
+    {
+        printf("%lu events were dropped\n", stats->dropped);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fputs("usage: strace <program> [args]\n", stdout);
+        return 1;
+    }
+
+    char path[128];
+    if (strchr(argv[1], '/'))
+    {
+        strncpy(path, argv[1], sizeof(path) - 1);
+    }
+    else
+    {
+        strcpy(path, "/bin/");
+        strncat(path, argv[1], sizeof(path) - 6);
+    }
+    path[sizeof(path) - 1] = '\0';
+
+    process_create_info_t create_info = {
+        .args = (const char **)&argv[1],
+        .num_args = (size_t)(argc - 1),
+        .envars = NULL,
+        .num_envars = 0,
+        .stdin_idx = (uint64_t)stdin,
+        .stdout_idx = (uint64_t)stdout,
+        .stderr_idx = (uint64_t)stderr,
+    };
+
+    int64_t pid = syscall_spawn((const uint8_t *)path, &create_info);
+    if (pid < 0)
+    {
+        printf("strace: failed to run %s\n", path);
+        return 1;
+    }
+
+    // calls the child makes before this are not traced, usually it has not run yet
+    if (syscall_trace((uint64_t)pid, SYSTRACE_STATS | SYSTRACE_EVENTS | SYSTRACE_INHERIT) < 0)
+    {
+        fputs("strace: failed to enable tracing\n", stdout);
+        return 1;
+    }
+
+    while (syscall_ping((uint64_t)pid) == (uint64_t)pid)
+    {
+        print_records((uint64_t)pid);
+        syscall_yield();
+    }
+
+    // the trace of the exited child is kept until it has been read
+    syscall_stats_t stats;
+    int have_stats = syscall_trace_stats((uint64_t)pid, &stats) >= 0;
+    print_records((uint64_t)pid);
+
+    if (have_stats)
+    {
+        print_stats(&stats);
+    }
+
+    return 0;
+}
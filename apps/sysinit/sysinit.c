@@ -3,28 +3,21 @@
 
 int64_t start_shell(void)
 {
-    int64_t pid = syscall_fork();
+    const char *envp = "PATH=/bin";
+
+    process_create_info_t create_info = {
+        .args = NULL,
+        .num_args = 0,
+        .envars = &envp,
+        .num_envars = 1,
+        .stdin_idx = (uint64_t)stdin,
+        .stdout_idx = (uint64_t)stdout,
+        .stderr_idx = (uint64_t)stderr,
+    };
+
+    int64_t pid = syscall_spawn("/bin/shell", &create_info);
     if (pid < 0)
     {
-        fputs("SYSINIT -- ERROR UNRECOVERABLE -- FAILED TO FORK PROCESS\n", stdout);
-        syscall_exit(1);
-    }
-
-    if (pid == 0)
-    {
-        const char *envp = "PATH=/bin";
-
-        process_create_info_t create_info = {
-            .args = NULL,
-            .num_args = 0,
-            .envars = &envp,
-            .num_envars = 1,
-            .stdin_idx = (uint64_t)stdin,
-            .stdout_idx = (uint64_t)stdout,
-            .stderr_idx = (uint64_t)stderr,
-        };
-        syscall_exec("/bin/shell", &create_info);
-
         fputs("SYSINIT -- ERROR UNRECOVERABLE -- FAILED TO EXECUTE PROCESS\n", stdout);
         syscall_exit(1);
     }
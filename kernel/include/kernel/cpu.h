@@ -0,0 +1,19 @@
+#ifndef _KERNEL_CPU_H
+#define _KERNEL_CPU_H
+
+#include <stdint.h>
+#include <kernel/status.h>
+
+#define MSR_APIC_BASE 0x1B
+#define MSR_TSC_DEADLINE 0x6E0
+
+uint64_t cpu_read_msr(uint32_t msr);
+void cpu_write_msr(uint32_t msr, uint64_t value);
+void cpu_cpuid(uint32_t leaf, uint32_t subleaf, uint32_t *eax, uint32_t *ebx, uint32_t *ecx, uint32_t *edx);
+uint64_t cpu_read_tsc(void);
+
+// disables interrupts and returns the previous rflags for cpu_irq_restore
+uint64_t cpu_irq_save(void);
+void cpu_irq_restore(uint64_t flags);
+
+#endif
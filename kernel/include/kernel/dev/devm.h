@@ -2,6 +2,7 @@
 #define _KERNEL_DEVM_H
 
 #include <kernel/status.h>
+#include <kernel/proc/waitqueue.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
@@ -86,6 +87,8 @@ typedef struct
     uint8_t blockdev_type;
     char model[BLOCKDEV_MODEL_MAX_LEN];
     bool available;
+
+    wait_queue_t wait; // woken through device_notify when input or packets arrive
 } device_t;
 
 typedef struct device_ops
@@ -95,8 +98,12 @@ typedef struct device_ops
     // inputdev
     int (*poll)(inputpacket_t *packet, device_t *dev);
 
+    // inputdev, net: whether a read would find something
+    bool (*has_data)(device_t *dev);
+
     // chardev
     int (*write)(char c, chardev_color_t fg, chardev_color_t bg, device_t *dev);
+    int (*write_buffer)(const char *data, size_t size, chardev_color_t fg, chardev_color_t bg, device_t *dev);
 
     // blockdev
     int (*read_block)(uint64_t lba, uint8_t *data, device_t *dev);
@@ -152,6 +159,8 @@ device_t *get_device_by_type(device_type_t type, size_t index);
 int device_free(device_t *dev);
 int device_poll(inputpacket_t *packet, device_t *dev);
 int device_write(char c, chardev_color_t fg, chardev_color_t bg, device_t *dev);
+// falls back to write per character for drivers without write_buffer
+int device_write_buffer(const char *data, size_t size, chardev_color_t fg, chardev_color_t bg, device_t *dev);
 int device_read_block(uint64_t lba, uint8_t *data, device_t *dev);
 int device_write_block(uint64_t lba, const uint8_t *data, device_t *dev);
 int device_eject(device_t *dev);
@@ -160,4 +169,9 @@ int device_get_display_rect(video_rect_t *rect, int display, device_t *dev);
 uint32_t *device_create_framebuffer(video_rect_t *rect, int display, device_t *dev);
 int device_update_display(video_rect_t *rect, void *framebuffer, device_t *dev);
 
+// false for devices without has_data
+bool device_has_data(device_t *dev);
+// wakes everyone polling the device, drivers call it once new data is there
+void device_notify(device_t *dev);
+
 #endif
\ No newline at end of file
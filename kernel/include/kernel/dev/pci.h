@@ -2,6 +2,7 @@
 #define _KERNEL_PCI_H
 
 #include <kernel/status.h>
+#include <kernel/isr.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
@@ -12,6 +13,14 @@
 #define MAX_FUNCTION 8
 #define MAX_PCI_DEVICES (MAX_BUS * MAX_DEVICE * MAX_FUNCTION)
 
+#define PCI_CAP_PTR_OFFSET 0x34
+#define PCI_CAP_ID_MSI 0x05
+#define PCI_CAP_ID_VNDR 0x09
+#define PCI_CAP_ID_MSIX 0x11
+
+#define PCI_VECTOR_BASE 0x30
+#define PCI_VECTOR_END 0xEE
+
 enum bar_type
 {
     BAR_TYPE_MEMORY_MAPPING = 0,
@@ -37,10 +46,21 @@ typedef struct _pci_device
     uint8_t subclass_code;
     uint8_t prog_if;
     uint8_t header_type;
+    uint8_t interrupt_line;
     base_address_register_t bars[MAX_BARS];
+
+    uint8_t msi_cap;
+    uint8_t msix_cap;
+    uint16_t msix_table_size;
+    volatile uint32_t *msix_table;
 } pci_device_t;
 
 uint32_t pci_read(uint8_t bus, uint8_t device, uint8_t function, uint8_t offset);
+void pci_write(uint8_t bus, uint8_t device, uint8_t function, uint8_t offset, uint32_t value);
+uint16_t pci_read_word(uint8_t bus, uint8_t device, uint8_t function, uint8_t offset);
+void pci_write_word(uint8_t bus, uint8_t device, uint8_t function, uint8_t offset, uint16_t value);
+uint8_t pci_read_byte(uint8_t bus, uint8_t device, uint8_t function, uint8_t offset);
+void pci_read_bytes(uint8_t bus, uint8_t device, uint8_t function, uint8_t offset, void *buffer, uint8_t size);
 
 int pci_init(void);
 void pci_free(void);
@@ -48,4 +68,15 @@ void pci_free(void);
 pci_device_t *pci_get_device(uint64_t id);
 void pci_enable_device(pci_device_t *dev);
 
+// returns the config space offset of the capability or 0, pass 0 as start to search from the beginning
+uint8_t pci_find_capability(pci_device_t *dev, uint8_t cap_id, uint8_t start);
+
+int pci_alloc_vector(void (*handler)(interrupt_frame_t *));
+void pci_free_vector(int vector);
+
+KRES pci_enable_msi(pci_device_t *dev, uint8_t vector);
+KRES pci_enable_msix(pci_device_t *dev);
+KRES pci_set_msix_vector(pci_device_t *dev, uint16_t entry, uint8_t vector);
+void pci_disable_msi(pci_device_t *dev);
+
 #endif
\ No newline at end of file
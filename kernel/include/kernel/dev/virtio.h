@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <kernel/status.h>
 #include <kernel/dev/pci.h>
+#include <kernel/isr.h>
 
 #define VIRTIO_STATUS_ACKNOWLEDGE 0x1
 #define VIRTIO_STATUS_DRIVER 0x2
@@ -19,8 +20,12 @@
 #define VIRTIO_PCI_CAP_SHARED_MEMORY_CFG 8
 #define VIRTIO_PCI_CAP_VENDOR_CFG 9
 
-#define PCI_CAP_PTR_OFFSET 0x34
-#define PCI_CAP_ID_VNDR 0x09
+#define VIRTIO_MSI_NO_VECTOR 0xFFFF
+
+#define VIRTIO_ISR_QUEUE 0x1
+
+#define VIRTIO_MAX_LEGACY_QUEUES 8
+#define VIRTIO_MAX_LEGACY_DEVICES 8
 
 typedef struct __attribute__((packed))
 {
@@ -73,6 +78,12 @@ typedef struct __attribute__((packed))
     void *device_cfg;
     uint8_t *isr;
     uint32_t notify_off_multiplier;
+    pci_device_t *pci_dev;
+    bool msix;
+
+    // without msi-x all queues share the legacy line, the isr does not say which queue it was for
+    void (*legacy_handlers[VIRTIO_MAX_LEGACY_QUEUES])(interrupt_frame_t *);
+    size_t num_legacy_handlers;
 } virtio_device_t;
 
 struct virtq_desc
@@ -118,13 +129,16 @@ typedef struct
 
     int queue_index;
     uint16_t queue_size;
+    int vector;
 
     virtio_pci_common_cfg_t *common;
 } virtqueue_t;
 
 virtio_device_t *virtio_init(pci_device_t *pci_dev, uint32_t (*feature_negotiate)(uint32_t features, virtio_device_t *device, bool *abort));
 KRES virtio_start(virtio_device_t *dev);
-virtqueue_t *virtio_setup_queue(virtio_device_t *device, int queue_index);
+// with msi-x every queue gets its own vector, otherwise every handler of the device runs on its legacy line
+virtqueue_t *virtio_setup_queue(virtio_device_t *device, int queue_index, void (*handler)(interrupt_frame_t *));
+void virtio_ack_interrupt(virtio_device_t *dev);
 
 KRES virtio_send_buffer(virtio_device_t *dev, virtqueue_t *vq, uint64_t buf, uint32_t len, uint8_t flags, bool wait);
 KRES virtio_send(virtio_device_t *dev, virtqueue_t *vq, uint64_t cmd, uint32_t cmd_len, uint64_t resp, uint32_t resp_len);
@@ -0,0 +1,21 @@
+#ifndef _KERNEL_FPU_H
+#define _KERNEL_FPU_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <kernel/status.h>
+
+struct _task;
+
+int fpu_init(void);
+size_t fpu_state_size(void);
+bool fpu_xsave_enabled(void);
+
+// lazy switching: the state is only moved when the next task touches the fpu
+void fpu_switch(struct _task *next);
+int fpu_handle_trap(struct _task *task); // #NM
+int fpu_clone(struct _task *dst, struct _task *src);
+void fpu_release(struct _task *task);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef _KERNEL_DCACHE_H
+#define _KERNEL_DCACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ the dentry cache remembers what a filesystem found when it looked up a name in a directory
+ entries are keyed by (filesystem instance, parent directory, name), where the filesystem picks what identifies
+ its directories (fat32 uses the first cluster), and hold a small filesystem specific blob
+ a negative entry records that the name does not exist, so probing for missing files stays in memory as well
+ the filesystem keeps the cache coherent by inserting or removing entries whenever it changes a directory
+*/
+
+#define DCACHE_NAME_MAX 64 // longer names are never cached
+#define DCACHE_DATA_SIZE 32
+#define DCACHE_BUCKETS 256
+#define DCACHE_MAX_ENTRIES 1024 // least recently used entries are recycled beyond this
+
+#define DCACHE_MISS 0
+#define DCACHE_HIT 1
+#define DCACHE_NEGATIVE 2
+
+typedef struct _dentry
+{
+    const void *fs; // filesystem instance, e.g. the mount's fs_data
+    uint64_t parent;
+    uint32_t hash;
+    bool negative;
+    char name[DCACHE_NAME_MAX];
+    uint8_t data[DCACHE_DATA_SIZE];
+
+    struct _dentry *hash_next;
+    struct _dentry *lru_prev; // more recently used
+    struct _dentry *lru_next;
+} dentry_t;
+
+// returns DCACHE_*, data receives size bytes of the blob on a hit
+int dcache_lookup(const void *fs, uint64_t parent, const char *name, void *data, size_t size);
+// data NULL inserts a negative entry, an existing entry for the name is replaced
+void dcache_insert(const void *fs, uint64_t parent, const char *name, const void *data, size_t size);
+void dcache_remove(const void *fs, uint64_t parent, const char *name);
+// drops every entry of a filesystem instance, e.g. before it goes away
+void dcache_invalidate(const void *fs);
+
+#endif
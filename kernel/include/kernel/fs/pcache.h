@@ -0,0 +1,53 @@
+#ifndef _KERNEL_PCACHE_H
+#define _KERNEL_PCACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <kernel/proc/syscall_table.h>
+
+/*
+ the page cache keeps file data in whole pages, keyed by (mount, inode number, page index)
+ vfs_read fills it and vfs_write, clearing and deleting drop what they change, filesystems never see it
+ it is bounded by PCACHE_MAX_PAGES and gives its least recently used pages back whenever the pmm runs out
+ pages read ahead of a sequential reader are flagged so the stats can tell how many of them were used
+*/
+
+#define PCACHE_MAX_PAGES 4096 // 16 MiB
+#define PCACHE_BUCKETS 1024
+
+typedef struct _cached_page
+{
+    const void *mount;
+    uint64_t ino;
+    uint64_t index;
+    size_t size; // valid bytes, less than a page at the end of the file
+    uint8_t *data;
+    bool readahead; // prefetched and not read yet
+
+    struct _cached_page *hash_next;
+    struct _cached_page *lru_prev; // more recently used
+    struct _cached_page *lru_next;
+} cached_page_t;
+
+void pcache_init(void);
+
+// copies size bytes from offset within the page, false if the page is not cached or holds less than that
+bool pcache_read(const void *mount, uint64_t ino, uint64_t index, size_t offset, void *buf, size_t size);
+// true if the page is cached, without touching the stats or the lru order
+bool pcache_contains(const void *mount, uint64_t ino, uint64_t index);
+// caches size bytes of a page, replacing an older copy
+void pcache_insert(const void *mount, uint64_t ino, uint64_t index, const void *data, size_t size);
+
+// taken before reading a page ahead, pcache_insert_readahead drops the page if anything was invalidated since
+uint64_t pcache_generation(void);
+void pcache_insert_readahead(const void *mount, uint64_t ino, uint64_t index, const void *data, size_t size, uint64_t since);
+// drops the pages from first_index on
+void pcache_invalidate(const void *mount, uint64_t ino, uint64_t first_index);
+
+// frees up to num_pages least recently used pages, returns how many
+size_t pcache_reclaim(size_t num_pages);
+
+void pcache_get_stats(pcache_stats_t *stats);
+
+#endif
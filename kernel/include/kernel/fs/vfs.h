@@ -11,9 +11,14 @@
 
 #include <kernel/dev/devm.h>
 #include <kernel/proc/stream.h>
+#include <kernel/proc/workqueue.h>
 
 #define MAX_PATH 128
 
+// read-ahead window in pages, doubled on every sequential read and reset by any other
+#define READAHEAD_MIN_PAGES 4
+#define READAHEAD_MAX_PAGES 64
+
 #define FS_FILE 0x01
 #define FS_DIRECTORY 0x02
 #define FS_SYMLINK 0x03
@@ -36,6 +41,14 @@ typedef struct _mount_node
     cvector(struct _mount_node *) children;
 } mount_node_t;
 
+/*
+ an open file, the filesystem resolves the path once in fs_open and keeps everything it needs for i/o in fs_node
+ (fat32 keeps the first cluster, the size and where the directory entry lives), so fs_read and fs_write never see a path
+ they are handed the position to work at and leave the offset alone, vfs_read and vfs_write move it
+ cloned streams share the node together with its offset, fs_close runs once the last of them is closed
+ vfs_read watches the offsets it is called with and, while they follow on from each other, has the workqueue
+ fill the page cache ahead of the reader, the queued work holds a reference of its own
+*/
 typedef struct _file_node
 {
     char local_path[MAX_PATH];
@@ -53,7 +66,15 @@ typedef struct _file_node
     uint16_t last_access_date;
     uint32_t flags;
 
-    uint64_t _data; // private data for fs implementation
+    void *fs_node; // owned by the filesystem
+    uint64_t ino; // stable id of the file within its mount, 0 keeps its data out of the page cache
+    size_t refcount; // set to 1 by vfs_open
+
+    size_t ra_next; // offset a sequential read continues from
+    size_t ra_window; // pages, 0 while the access pattern is random
+    uint64_t ra_index; // next page for the work to read ahead
+    uint64_t ra_end; // first page past the read-ahead range
+    work_t ra_work;
 } file_node_t;
 
 typedef struct
@@ -69,8 +90,8 @@ typedef struct _filesystem
 
     stream_t *(*fs_open)(const char *, uint8_t, mount_node_t *);
     int (*fs_close)(stream_t *);
-    int (*fs_read)(stream_t *, size_t, uint8_t *);
-    int (*fs_write)(stream_t *, size_t, const uint8_t *);
+    int (*fs_read)(stream_t *, size_t, size_t, uint8_t *); // offset, size, buffer
+    int (*fs_write)(stream_t *, size_t, size_t, const uint8_t *);
     int (*fs_readdir)(stream_t *, int, char *);
     int (*fs_delete)(stream_t *);
 } filesystem_t;
@@ -91,9 +112,13 @@ int vfs_mount_filesystem(filesystem_t *fs, const char *path);
 #define SEEK_TYPE_END 2
 
 stream_t *vfs_open(const char *path, uint8_t action);
-int vfs_close(stream_t *stream);
+int vfs_close(stream_t *stream); // drops the stream's reference to its node
+void vfs_hold(file_node_t *node); // for another stream on the same node
 int vfs_read(stream_t *stream, size_t size, uint8_t *buf);
 int vfs_write(stream_t *stream, size_t size, const uint8_t *buf);
+// at offset, the offset of the stream stays where it is
+int vfs_pread(stream_t *stream, size_t offset, size_t size, uint8_t *buf);
+int vfs_pwrite(stream_t *stream, size_t offset, size_t size, const uint8_t *buf);
 int vfs_readdir(stream_t *stream, int index, dirent_t *dirent);
 int vfs_delete(stream_t *stream); // doesnt close node
 int vfs_seek(stream_t *stream, size_t n, uint8_t type);
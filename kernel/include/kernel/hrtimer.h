@@ -0,0 +1,28 @@
+#ifndef _KERNEL_HRTIMER_H
+#define _KERNEL_HRTIMER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <kernel/status.h>
+
+typedef struct _hrtimer
+{
+    uint64_t expires; // absolute time_get_ns() value
+    void (*func)(struct _hrtimer *timer);
+    void *data;
+
+    size_t index; // position in the heap
+    bool active;
+} hrtimer_t;
+
+void hrtimer_init(hrtimer_t *timer, void (*func)(hrtimer_t *timer), void *data);
+KRES hrtimer_start(hrtimer_t *timer, uint64_t expires);
+void hrtimer_cancel(hrtimer_t *timer);
+
+uint64_t hrtimer_next_expiry(void);
+
+// runs the callbacks of all timers that expired at now, called from the clockevent interrupt
+void hrtimer_run(uint64_t now);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef _KERNEL_LAPIC_H
+#define _KERNEL_LAPIC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <kernel/status.h>
+#include <kernel/vmm.h>
+
+#define LAPIC_SPURIOUS_VECTOR 0xEF
+#define LAPIC_TIMER_VECTOR 0xEE
+
+int lapic_init(page_table_t *pml4);
+void lapic_eoi(void);
+uint8_t lapic_get_id(void);
+uint64_t lapic_get_base(void);
+
+// one-shot clockevent, uses tsc-deadline mode when the cpu supports it
+int lapic_timer_init(uint64_t tsc_frequency);
+void lapic_timer_oneshot(uint64_t delta_ns);
+void lapic_timer_stop(void);
+bool lapic_timer_tsc_deadline(void);
+
+#endif
@@ -2,6 +2,7 @@
 #define _KERNEL_LOG_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdbool.h>
 #include <kernel/status.h>
 
@@ -13,12 +14,13 @@ typedef enum
     LOG_LEVEL_ERROR,
 } log_level_t;
 
-KRES klog_write_e9_and_vga(char c, log_level_t level);
-KRES klog_write_e9(char c, log_level_t level);
-KRES klog_write_vga(char c, log_level_t level);
-KRES klog_write_null(char c, log_level_t level);
+// every message reaches the writer in one call
+KRES klog_write_e9_and_vga(const char *str, size_t size, log_level_t level);
+KRES klog_write_e9(const char *str, size_t size, log_level_t level);
+KRES klog_write_vga(const char *str, size_t size, log_level_t level);
+KRES klog_write_null(const char *str, size_t size, log_level_t level);
 
-KRES klog_init(KRES (*write_func)(char c, log_level_t level));
+KRES klog_init(KRES (*write_func)(const char *str, size_t size, log_level_t level));
 KRES klog(log_level_t level, const char *fmt, ...);
 KRES klog_raw(log_level_t level, const char *fmt, ...);
 
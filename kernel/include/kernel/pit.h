@@ -8,8 +8,10 @@
 int pit_init(uint32_t frequency);
 void pit_set_frequency(uint32_t frequency);
 uint32_t pit_get_frequency(void);
+uint64_t pit_get_ticks(void);
 void register_pit_handler(void (*func)(interrupt_frame_t *frame, uint32_t frequency));
 
+// busy waits, safe to use from several places at once
 void sleep(uint64_t ms);
 
 #endif
\ No newline at end of file
@@ -13,6 +13,9 @@ void *pmm_alloc(void);
 void *pmm_alloc_contiguous(size_t num_pages);
 void pmm_free(uint64_t *page);
 
+// called when pmm_alloc finds no free page, returns how many pages it freed
+void pmm_set_reclaim(size_t (*reclaim)(size_t num_pages));
+
 uint64_t get_max_addr(void);
 
 typedef struct
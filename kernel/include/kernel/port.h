@@ -2,6 +2,7 @@
 #define _KERNEL_PORT_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include <kernel/status.h>
 
 uint8_t port_byte_in(uint16_t port);
@@ -11,4 +12,7 @@ void port_word_out(uint16_t port, uint16_t data);
 uint32_t port_dword_in(uint16_t port);
 void port_dword_out(uint16_t port, uint32_t data);
 
+// one rep outsb instead of a call per byte
+void port_bytes_out(uint16_t port, const uint8_t *data, size_t size);
+
 #endif
\ No newline at end of file
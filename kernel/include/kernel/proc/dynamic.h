@@ -0,0 +1,31 @@
+#ifndef _KERNEL_DYNAMIC_H
+#define _KERNEL_DYNAMIC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <kernel/status.h>
+#include <kernel/proc/image.h>
+
+/*
+ shared objects are linked in the kernel when their image is loaded
+ every shared object gets its own load address that stays the same in every process,
+ so the relocated pages can be cached together with the image and binding costs nothing at exec
+*/
+
+#define DYNAMIC_LIBRARY_PATH "/lib/"
+#define DYNAMIC_LIBRARY_VADDR_BASE 0x100000000
+#define DYNAMIC_LIBRARY_ALIGN 0x200000
+#define DYNAMIC_MAX_DEPTH 8
+#define DYNAMIC_MAX_OBJECTS 16
+
+// reserves address space for a shared object of the given size
+uintptr_t dynamic_reserve(size_t size);
+
+// loads the DT_NEEDED dependencies and applies every relocation to the cached pages
+KRES dynamic_link(exec_image_t *image, unsigned int depth);
+
+// breadth first list of the image and all objects it depends on, every object only once
+size_t dynamic_collect(exec_image_t *root, exec_image_t **objs, size_t max);
+
+#endif
@@ -56,6 +56,32 @@
 
 #define SHN_UNDEF 0
 
+#define DT_NULL 0
+#define DT_NEEDED 1
+#define DT_PLTRELSZ 2
+#define DT_HASH 4
+#define DT_STRTAB 5
+#define DT_SYMTAB 6
+#define DT_RELA 7
+#define DT_RELASZ 8
+#define DT_RELAENT 9
+#define DT_JMPREL 23
+
+#define STB_LOCAL 0
+#define STB_GLOBAL 1
+#define STB_WEAK 2
+
+#define R_X86_64_NONE 0
+#define R_X86_64_64 1
+#define R_X86_64_COPY 5
+#define R_X86_64_GLOB_DAT 6
+#define R_X86_64_JUMP_SLOT 7
+#define R_X86_64_RELATIVE 8
+
+#define ELF64_ST_BIND(i) ((i) >> 4)
+#define ELF64_R_SYM(i) ((i) >> 32)
+#define ELF64_R_TYPE(i) ((i) & 0xffffffffL)
+
 typedef uint64_t Elf64_Addr;
 typedef uint64_t Elf64_Off;
 typedef uint16_t Elf64_Half;
@@ -128,6 +154,13 @@ typedef struct
     Elf64_Xword st_size; /* Size of object (e.g., common) */
 } Elf64_Sym;
 
+typedef struct
+{
+    Elf64_Addr r_offset; /* Address of reference */
+    Elf64_Xword r_info; /* Symbol index and type of relocation */
+    Elf64_Sxword r_addend; /* Constant part of expression */
+} Elf64_Rela;
+
 typedef struct
 {
     stream_t *file;
@@ -136,12 +169,8 @@ typedef struct
     Elf64_Phdr *pheader;
 } elf_file_t;
 
-struct _process;
-
 uint64_t elf_entry(elf_file_t *file);
-elf_file_t *elf_load(const char *path);
+elf_file_t *elf_load(const char *path); // reads and validates the headers of executables and shared objects
 void elf_free(elf_file_t *file);
-int elf_load_and_map(struct _process *proc, elf_file_t *elf_file);
-int elf_load_and_map_copy(struct _process *proc, elf_file_t *elf_file, struct _process *original); // copys the data sections (useful for forking)
 
 #endif
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef _KERNEL_EPOLL_H
+#define _KERNEL_EPOLL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <kernel/status.h>
+#include <kernel/proc/poll.h>
+
+/*
+ an epoll instance keeps its interest set registered on the queues of the streams
+ a wakeup moves the item onto the ready list, so waiting only looks at streams that changed
+ items are level triggered, they stay on the ready list until their stream is no longer ready
+*/
+
+#define EPOLL_ITEM_QUEUES 1 // queues a single stream registers
+
+typedef struct _epoll_item
+{
+    struct _epoll *epoll;
+    stream_t *stream;
+    int32_t fd;
+    epoll_event_t event;
+
+    wait_entry_t entries[EPOLL_ITEM_QUEUES];
+    size_t num_entries;
+    bool ready;
+
+    struct _epoll_item *next;         // interest set
+    struct _epoll_item *ready_next;   // ready list
+    struct _epoll_item *stream_next;  // other items watching the same stream
+} epoll_item_t;
+
+typedef struct _epoll
+{
+    epoll_item_t *items;
+    epoll_item_t *ready;
+    wait_queue_t wait; // tasks in epoll_wait
+
+    uint32_t refcount; // streams sharing the instance after a fork
+} epoll_t;
+
+epoll_t *epoll_create(void);
+void epoll_hold(epoll_t *epoll);
+void epoll_put(epoll_t *epoll);
+
+// fd only identifies the item, event is ignored for EPOLL_CTL_DEL
+KRES epoll_ctl(epoll_t *epoll, int op, int32_t fd, stream_t *stream, const epoll_event_t *event);
+
+// timeout_ns < 0 waits forever, returns the number of events
+int64_t epoll_wait(epoll_t *epoll, task_t *task, epoll_event_t *events, size_t max, int64_t timeout_ns);
+
+// ready as long as the ready list is not empty
+uint32_t epoll_poll(epoll_t *epoll, poll_table_t *table);
+
+// drops the items watching a stream that is being freed
+void epoll_forget(stream_t *stream);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef _KERNEL_FUTEX_H
+#define _KERNEL_FUTEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <kernel/status.h>
+#include <kernel/proc/task.h>
+
+/*
+ waiters are queued in a hash table keyed on the address space and the user virtual address
+ user space only calls in here when a lock is contended
+*/
+
+#define FUTEX_HASH_SIZE 64
+
+// blocks while *uaddr == val, timeout_ns 0 waits forever
+KRES futex_wait(task_t *task, uint32_t *uaddr, uintptr_t vaddr, uint32_t val, uint64_t timeout_ns);
+
+// returns the number of woken tasks
+size_t futex_wake(page_table_t *pml4, uintptr_t vaddr, size_t count);
+
+// drops a task that is killed while waiting
+void futex_cancel(task_t *task);
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef _KERNEL_IMAGE_H
+#define _KERNEL_IMAGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <kernel/status.h>
+#include <kernel/fs/vfs.h>
+#include <kernel/proc/elf.h>
+
+/*
+ executable images are loaded once and kept in a cache keyed by path, size and write time
+ read only segments are mapped from the cached frames into every process running the image,
+ writable segments get private copies
+*/
+
+#define IMAGE_CACHE_MAX 16
+#define IMAGE_MAX_DEPS 8
+
+typedef struct
+{
+    Elf64_Phdr phdr;
+    void **pages; // physical addresses, contents as mapped at phdr.p_vaddr rounded down
+    size_t num_pages;
+} exec_image_segment_t;
+
+typedef struct _exec_image
+{
+    char path[MAX_PATH];
+    size_t filesize;
+    uint16_t write_time;
+    uint16_t write_date;
+
+    Elf64_Ehdr header;
+    exec_image_segment_t *segments; // PT_LOAD only
+    size_t num_segments;
+
+    uintptr_t base;    // load address of a shared object, 0 for executables
+    uintptr_t dynamic; // link time address of PT_DYNAMIC, 0 if statically linked
+    struct _exec_image *deps[IMAGE_MAX_DEPS];
+    size_t num_deps;
+
+    uint32_t refcount; // processes mapping the image
+    bool cached;       // false once replaced by a newer version of the file
+
+    struct _exec_image *next;
+} exec_image_t;
+
+struct _process;
+
+// returns a referenced image, only reads the file if it is not cached or changed on disk
+exec_image_t *image_get(const char *path);
+// depth counts the shared objects loaded on the way there, it stops dependency cycles
+exec_image_t *image_get_depth(const char *path, unsigned int depth);
+void image_hold(exec_image_t *image);
+void image_put(exec_image_t *image);
+
+uint64_t image_entry(exec_image_t *image);
+
+// access the cached contents by link time address, fails outside of the loaded segments
+KRES image_read(exec_image_t *image, uintptr_t vaddr, void *buf, size_t size);
+KRES image_write(exec_image_t *image, uintptr_t vaddr, const void *buf, size_t size);
+
+// maps every segment of the image and its shared objects into proc, writable pages are copied from original if given (fork)
+int image_map(struct _process *proc, exec_image_t *image, struct _process *original);
+
+#endif
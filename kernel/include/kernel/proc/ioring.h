@@ -0,0 +1,97 @@
+#ifndef _KERNEL_IORING_H
+#define _KERNEL_IORING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <kernel/status.h>
+#include <kernel/proc/task.h>
+#include <kernel/proc/workqueue.h>
+
+/*
+ a submission and a completion ring shared with the process at PROCESS_IO_RING_VADDR
+ the process fills entries and moves sq_tail, the kernel consumes them and moves cq_tail
+ entries are drained by io_ring_enter or by the workqueue, completions wake futex waiters on cq_tail
+ operations never wait, a read or write on a pipe that is not ready completes with RES_WOULDBLOCK
+*/
+
+#define IO_RING_MAX_ENTRIES 256
+
+#define IO_RING_OP_NOP 0
+#define IO_RING_OP_READ 1  // offset < 0 uses the stream position
+#define IO_RING_OP_WRITE 2 // offset < 0 uses the stream position
+#define IO_RING_OP_OPEN 3  // addr is the path, len the open action
+#define IO_RING_OP_CLOSE 4
+#define IO_RING_OP_SEEK 5 // len is the seek type
+
+#define IO_RING_ENTER_ASYNC (1 << 0) // hand the entries to the kernel worker and return right away
+
+typedef struct
+{
+    volatile uint32_t sq_head; // written by the kernel
+    volatile uint32_t sq_tail; // written by the process
+    volatile uint32_t cq_head; // written by the process
+    volatile uint32_t cq_tail; // written by the kernel
+    uint32_t sq_entries;
+    uint32_t cq_entries;
+    uint32_t sq_offset; // from the start of the ring
+    uint32_t cq_offset;
+    uint32_t reserved[8];
+} io_ring_header_t; // all fields are naturally aligned, packing would make taking their address unsafe
+
+typedef struct
+{
+    uint8_t opcode;
+    uint8_t flags;
+    uint16_t reserved0;
+    uint32_t reserved1;
+    int64_t stream;
+    uint64_t addr;
+    uint64_t len;
+    int64_t offset;
+    uint64_t user_data;
+} __attribute__((packed)) io_ring_sqe_t;
+
+typedef struct
+{
+    uint64_t user_data;
+    int64_t result;
+} __attribute__((packed)) io_ring_cqe_t;
+
+typedef struct _io_ring
+{
+    process_t *proc;
+    io_ring_header_t *header; // kernel view of the shared pages
+    io_ring_sqe_t *sqes;
+    io_ring_cqe_t *cqes;
+    uint8_t *pages;
+    size_t num_pages;
+
+    // the process can write the whole header, the kernel only trusts its own copies and reads sq_tail and cq_head
+    uint32_t sq_entries;
+    uint32_t cq_entries;
+
+    // private copies, the shared indices are only published
+    uint32_t sq_head;
+    uint32_t cq_tail;
+
+    work_t work;
+    volatile bool busy; // someone is draining the ring
+    volatile uint32_t work_refs; // queued or running ring_work instances, each holds a pointer to the ring
+    volatile bool dead; // the process is exiting
+} io_ring_t;
+
+// returns the user address of the ring
+int64_t io_ring_setup(process_t *proc, uint32_t entries);
+
+// returns the number of consumed submissions
+int64_t io_ring_enter(process_t *proc, uint32_t to_submit, uint32_t min_complete, uint32_t flags);
+
+// drops queued submissions and waits for a drain in progress to let go of the ring, the process must be able to block
+void io_ring_shutdown(process_t *proc);
+void io_ring_free(process_t *proc);
+
+// runs one operation on behalf of the process, lives next to the syscalls
+int64_t syscall_ring_execute(process_t *proc, const io_ring_sqe_t *sqe);
+
+#endif
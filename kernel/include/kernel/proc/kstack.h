@@ -0,0 +1,26 @@
+#ifndef _KERNEL_KSTACK_H
+#define _KERNEL_KSTACK_H
+
+#include <stdint.h>
+#include <kernel/status.h>
+#include <kernel/vmm.h>
+
+/*
+ kernel stacks live in the last pml4 slot, which is shared by every address space
+ each slot is an unmapped guard page followed by the stack itself
+*/
+
+#define KERNEL_STACK_REGION 0xFFFFFF8000000000
+#define KERNEL_STACK_PML4_INDEX 511
+#define KERNEL_STACK_PAGES 4
+#define KERNEL_STACK_SIZE (KERNEL_STACK_PAGES * PAGE_SIZE)
+#define KERNEL_STACK_MAX 512
+
+int kstack_init(page_table_t *kernel_pml4);
+void kstack_share(page_table_t *pml4);
+
+// returns the top of the stack or 0
+uintptr_t kstack_alloc(void);
+void kstack_free(uintptr_t top);
+
+#endif
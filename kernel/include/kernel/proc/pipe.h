@@ -0,0 +1,63 @@
+#ifndef _KERNEL_PIPE_H
+#define _KERNEL_PIPE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <kernel/status.h>
+#include <kernel/pmm.h>
+#include <kernel/proc/waitqueue.h>
+#include <kernel/proc/stream.h>
+
+/*
+ a pipe is a ring buffer shared by a read and a write end
+ readers block while it is empty and see the end of the file once the last writer is gone,
+ writers block while it is full and fail once the last reader is gone
+*/
+
+#define PIPE_DEFAULT_CAPACITY PAGE_SIZE
+#define PIPE_MAX_CAPACITY (16 * PAGE_SIZE)
+
+typedef struct _pipe
+{
+    uint8_t *buffer;
+    size_t capacity; // whole pages
+    size_t read_offset;
+    size_t used;
+
+    uint32_t readers;
+    uint32_t writers;
+
+    // a splice works on the buffer with interrupts enabled, everyone else on that side waits meanwhile
+    bool read_busy;
+    bool write_busy;
+
+    wait_queue_t read_wait;  // readers waiting for data
+    wait_queue_t write_wait; // writers waiting for room
+} pipe_t;
+
+// capacity 0 is the default, others are rounded up to pages, the pipe starts without ends
+pipe_t *pipe_create(size_t capacity);
+// only for a pipe that never got an end
+void pipe_free(pipe_t *pipe);
+
+// ends count their references, the pipe is freed with the last one
+void pipe_open(pipe_t *pipe, bool write);
+void pipe_close(pipe_t *pipe, bool write);
+
+// returns once there is any data, bytes_read is 0 at the end of the file
+// nonblock fails with -RES_WOULDBLOCK instead of waiting
+KRES pipe_read(pipe_t *pipe, uint8_t *data, size_t size, bool nonblock, size_t *bytes_read);
+
+// returns once everything is written, -RES_UNAVAILABLE if nobody reads before that
+// nonblock writes what fits and only fails if that is nothing
+KRES pipe_write(pipe_t *pipe, const uint8_t *data, size_t size, bool nonblock, size_t *bytes_written);
+
+// splice straight between the pipe buffer and another stream, without a copy in between
+// from fills one contiguous free range and blocks like a write while there is none
+// it reads in at *pos when pos is set, the offset of in is neither used nor moved then
+KRES pipe_splice_from(pipe_t *pipe, stream_t *in, const size_t *pos, size_t size, bool nonblock, size_t *moved);
+// to blocks like a read until there is data, then drains what is there up to size
+KRES pipe_splice_to(pipe_t *pipe, stream_t *out, size_t size, bool nonblock, size_t *moved);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef _KERNEL_POLL_H
+#define _KERNEL_POLL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <kernel/status.h>
+#include <kernel/proc/task.h>
+#include <kernel/proc/stream.h>
+#include <kernel/proc/waitqueue.h>
+#include <kernel/proc/syscall_table.h>
+
+/*
+ stream_poll reports the queues that announce a change of its events through poll_wait
+ poll puts the waiting task on them, epoll a callback that moves the stream onto its ready list
+*/
+
+typedef struct _poll_table
+{
+    task_t *task; // NULL for callback entries
+    void (*func)(wait_entry_t *entry);
+    void *data;
+
+    wait_entry_t *entries;
+    size_t count;
+    size_t max;
+} poll_table_t;
+
+void poll_wait(poll_table_t *table, wait_queue_t *queue);
+
+// removes every entry of the table from its queue
+void poll_table_release(poll_table_t *table);
+
+// streams[i] belongs to fds[i] and is NULL for closed ones, timeout_ns < 0 waits forever
+// returns the number of entries with events
+int64_t poll_streams(task_t *task, stream_t **streams, poll_fd_t *fds, size_t count, int64_t timeout_ns);
+
+// arms the timeout of a task that is about to block, false if it could not be armed
+bool poll_timeout_start(task_t *task, int64_t timeout_ns);
+
+#endif
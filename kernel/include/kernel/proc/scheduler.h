@@ -1,6 +1,36 @@
 #ifndef _KERNEL_SCHEDULER_H
 #define _KERNEL_SCHEDULER_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SCHED_LATENCY_BUCKETS 16 // bucket i counts latencies below 2^(i + 1) microseconds
+
+typedef struct
+{
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t histogram[SCHED_LATENCY_BUCKETS];
+} __attribute__((packed)) sched_latency_t;
+
+typedef struct
+{
+    uint64_t switches;
+    sched_latency_t wakeup;  // blocked task woken up until it runs
+    sched_latency_t preempt; // tick in kernel mode until the next safe point
+} __attribute__((packed)) sched_stats_t;
+
+struct _task;
+
 void scheduler_init(void);
 
-#endif
\ No newline at end of file
+// the kernel is only preempted at safe points, a tick in kernel mode just requests it
+void set_need_resched(void);
+bool need_resched(void);
+void cond_resched(void);
+
+void scheduler_account_switch(struct _task *prev, struct _task *next);
+void scheduler_get_stats(sched_stats_t *stats);
+
+#endif
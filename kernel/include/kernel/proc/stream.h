@@ -7,34 +7,36 @@
 typedef enum
 {
     STREAM_TYPE_NULL = 0,
-    STREAM_TYPE_BIDIRECTIONAL = 1,
+    STREAM_TYPE_PIPE = 1,
     STREAM_TYPE_FILE = 2,
-    STREAM_TYPE_DRIVER = 3
+    STREAM_TYPE_DRIVER = 3,
+    STREAM_TYPE_EPOLL = 4
 } stream_type_t;
 
+#define STREAM_FLAG_READ (1 << 0)  // read end of a pipe
+#define STREAM_FLAG_WRITE (1 << 1) // write end of a pipe
+#define STREAM_FLAG_NONBLOCK (1 << 2) // fail with RES_WOULDBLOCK instead of waiting
+
 struct _file_node;
 struct _mount_node;
-
-typedef struct
-{
-    uint8_t *buffer;
-    uint32_t refcount;
-    size_t write_offset;
-    size_t read_offset;
-    size_t max_size;
-} shared_ring_buffer_t;
+struct _pipe;
+struct _epoll;
+struct _epoll_item;
+struct _poll_table;
 
 typedef struct
 {
     stream_type_t type;
-    uint8_t flags; // not yet used
+    uint8_t flags;
     struct _mount_node *mount;
+    struct _epoll_item *watchers; // epoll instances interested in this stream
+    size_t refcount; // 1 for the stream table, stream_hold adds one for whoever must outlive a close
 
     union
     {
         struct
         {
-            shared_ring_buffer_t *buffer;
+            struct _pipe *pipe;
         };
 
         struct
@@ -46,17 +48,37 @@ typedef struct
         {
             device_t *device;
         };
+
+        struct
+        {
+            struct _epoll *epoll;
+        };
     };
 } stream_t;
 
-stream_t *stream_create_bidirectional(uint8_t flags);
+// flags is STREAM_FLAG_READ or STREAM_FLAG_WRITE, the stream holds a reference to that end
+stream_t *stream_create_pipe(struct _pipe *pipe, uint8_t flags);
 stream_t *stream_create_file(struct _file_node *node, struct _mount_node *mount);
 stream_t *stream_create_driver(uint8_t flags, device_t *device, struct _mount_node *mount);
+stream_t *stream_create_epoll(struct _epoll *epoll);
 
+void stream_hold(stream_t *stream);
+// drops a reference, the last one closes the stream
 void stream_free(stream_t *stream);
 
 int stream_read(stream_t *stream, uint8_t *data, size_t size, size_t *bytes_read);
 int stream_write(stream_t *stream, const uint8_t *data, size_t size, size_t *bytes_written);
+// never wait, whatever the flags of the stream say, a pipe that is not ready fails with RES_WOULDBLOCK
+int stream_read_nowait(stream_t *stream, uint8_t *data, size_t size, size_t *bytes_read);
+int stream_write_nowait(stream_t *stream, const uint8_t *data, size_t size, size_t *bytes_written);
+int stream_pread(stream_t *stream, uint8_t *data, size_t size, size_t offset, size_t *bytes_read);
+int stream_pwrite(stream_t *stream, const uint8_t *data, size_t size, size_t offset, size_t *bytes_written);
+// moves data between two streams inside the kernel, a pipe on either side is used as the buffer
+// otherwise bounce has to hold size bytes, moved is 0 at the end of the input
+// with pos set, in has to be a file and is read at *pos without touching its offset
+int stream_splice(stream_t *in, stream_t *out, const size_t *pos, size_t size, uint8_t *bounce, size_t *moved);
+// returns the POLL* events that are ready, table collects the queues that announce a change
+uint32_t stream_poll(stream_t *stream, struct _poll_table *table);
 int stream_flush(stream_t *stream);
 stream_t *stream_clone(stream_t *src);
 
@@ -0,0 +1,190 @@
+// generated by scripts/gensyscalls.py from kernel/syscalls/syscalls.tbl, do not edit
+
+#ifndef _KERNEL_SYSCALL_TABLE_H
+#define _KERNEL_SYSCALL_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SYSCALL_READ 0
+#define SYSCALL_WRITE 1
+#define SYSCALL_FORK 2
+#define SYSCALL_EXIT 3
+#define SYSCALL_PING 4
+#define SYSCALL_EXEC 5
+#define SYSCALL_ALLOC 6
+#define SYSCALL_OPEN 7
+#define SYSCALL_CLOSE 8
+#define SYSCALL_VIDEO_GET_DISPLAY_RECT 9
+#define SYSCALL_VIDEO_CREATE_FRAMEBUFFER 10
+#define SYSCALL_VIDEO_UPDATE_DISPLAY 11
+#define SYSCALL_PIPE 12
+#define SYSCALL_LSEEK 13
+#define SYSCALL_CLOCK_GETTIME 14
+#define SYSCALL_NANOSLEEP 15
+#define SYSCALL_SCHED_STATS 16
+#define SYSCALL_THREAD_CREATE 17
+#define SYSCALL_THREAD_EXIT 18
+#define SYSCALL_THREAD_JOIN 19
+#define SYSCALL_YIELD 20
+#define SYSCALL_GETTID 21
+#define SYSCALL_FUTEX_WAIT 22
+#define SYSCALL_FUTEX_WAKE 23
+#define SYSCALL_SPAWN 24
+#define SYSCALL_READV 25
+#define SYSCALL_WRITEV 26
+#define SYSCALL_PREAD 27
+#define SYSCALL_PWRITE 28
+#define SYSCALL_RING_SETUP 29
+#define SYSCALL_RING_ENTER 30
+#define SYSCALL_TRACE 31
+#define SYSCALL_TRACE_STATS 32
+#define SYSCALL_TRACE_READ 33
+#define SYSCALL_SPLICE 34
+#define SYSCALL_POLL 35
+#define SYSCALL_EPOLL_CREATE 36
+#define SYSCALL_EPOLL_CTL 37
+#define SYSCALL_EPOLL_WAIT 38
+#define SYSCALL_FCNTL 39
+#define SYSCALL_PCACHE_STATS 40
+
+#define SYSCALL_COUNT 41
+
+#define SYSCALL_FLAG_NORETURN (1 << 0)
+
+// X(number, name, flags) for every syscall in order
+#define SYSCALL_TABLE(X) \
+    X(0, read, 0) \
+    X(1, write, 0) \
+    X(2, fork, 0) \
+    X(3, exit, SYSCALL_FLAG_NORETURN) \
+    X(4, ping, 0) \
+    X(5, exec, 0) \
+    X(6, alloc, 0) \
+    X(7, open, 0) \
+    X(8, close, 0) \
+    X(9, video_get_display_rect, 0) \
+    X(10, video_create_framebuffer, 0) \
+    X(11, video_update_display, 0) \
+    X(12, pipe, 0) \
+    X(13, lseek, 0) \
+    X(14, clock_gettime, 0) \
+    X(15, nanosleep, 0) \
+    X(16, sched_stats, 0) \
+    X(17, thread_create, 0) \
+    X(18, thread_exit, SYSCALL_FLAG_NORETURN) \
+    X(19, thread_join, 0) \
+    X(20, yield, 0) \
+    X(21, gettid, 0) \
+    X(22, futex_wait, 0) \
+    X(23, futex_wake, 0) \
+    X(24, spawn, 0) \
+    X(25, readv, 0) \
+    X(26, writev, 0) \
+    X(27, pread, 0) \
+    X(28, pwrite, 0) \
+    X(29, ring_setup, 0) \
+    X(30, ring_enter, 0) \
+    X(31, trace, 0) \
+    X(32, trace_stats, 0) \
+    X(33, trace_read, 0) \
+    X(34, splice, 0) \
+    X(35, poll, 0) \
+    X(36, epoll_create, 0) \
+    X(37, epoll_ctl, 0) \
+    X(38, epoll_wait, 0) \
+    X(39, fcntl, 0) \
+    X(40, pcache_stats, 0) \
+
+
+// types passed through syscalls, pasted into both generated headers
+
+typedef struct
+{
+    const char **args;
+    size_t num_args;
+
+    const char **envars;
+    size_t num_envars;
+
+    uint64_t stdin_idx;
+    uint64_t stdout_idx;
+    uint64_t stderr_idx;
+} __attribute__((packed)) process_create_info_t;
+
+typedef struct
+{
+    void *base;
+    size_t len;
+} __attribute__((packed)) iovec_t;
+
+#define SYSTRACE_STATS (1 << 0)   // count calls and keep latency histograms
+#define SYSTRACE_EVENTS (1 << 1)  // record every call in the trace buffer
+#define SYSTRACE_INHERIT (1 << 2) // processes created by the traced process are traced as well
+
+#define SYSCALL_LATENCY_BUCKETS 16 // bucket i counts latencies below 2^(i + 8) nanoseconds, the last one everything above
+
+typedef struct
+{
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t histogram[SYSCALL_LATENCY_BUCKETS];
+} __attribute__((packed)) syscall_stat_t;
+
+typedef struct
+{
+    uint64_t dropped; // events overwritten before they were read
+    syscall_stat_t calls[SYSCALL_COUNT];
+} __attribute__((packed)) syscall_stats_t;
+
+typedef struct
+{
+    uint64_t time_ns; // at entry
+    uint64_t duration_ns;
+    uint64_t tid;
+    uint32_t num;
+    uint32_t reserved;
+    int64_t args[6];
+    int64_t result;
+} __attribute__((packed)) syscall_trace_record_t;
+
+#define POLLIN (1 << 0)   // a read would not block
+#define POLLOUT (1 << 2)  // a write would not block
+#define POLLERR (1 << 3)  // every read end of the pipe is closed, always reported
+#define POLLHUP (1 << 4)  // every write end of the pipe is closed, always reported
+#define POLLNVAL (1 << 5) // not an open stream
+
+typedef struct
+{
+    int32_t fd; // negative entries are skipped
+    int16_t events;
+    int16_t revents;
+} __attribute__((packed)) poll_fd_t;
+
+#define EPOLL_CTL_ADD 1
+#define EPOLL_CTL_DEL 2
+#define EPOLL_CTL_MOD 3
+
+typedef struct
+{
+    uint32_t events; // POLL* flags
+    uint64_t data;   // handed back untouched
+} __attribute__((packed)) epoll_event_t;
+
+#define F_GETFL 1 // returns the O_* flags of the stream
+#define F_SETFL 2 // replaces the O_* flags of the stream
+
+#define O_NONBLOCK (1 << 0) // reads and writes fail with RES_WOULDBLOCK instead of waiting
+
+typedef struct
+{
+    uint64_t hits; // file pages served from memory
+    uint64_t misses; // file pages read from the filesystem
+    uint64_t evictions; // pages dropped to make room or under memory pressure
+    uint64_t pages; // pages currently cached
+    uint64_t readahead; // pages prefetched for sequential readers
+    uint64_t readahead_hits; // prefetched pages that were read afterwards
+} __attribute__((packed)) pcache_stats_t;
+
+#endif
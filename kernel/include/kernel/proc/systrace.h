@@ -0,0 +1,45 @@
+#ifndef _KERNEL_SYSTRACE_H
+#define _KERNEL_SYSTRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <kernel/status.h>
+#include <kernel/proc/task.h>
+#include <kernel/proc/syscall_table.h>
+
+/*
+ per process syscall accounting, enabled with the trace syscall
+ events go into a ring that overwrites the oldest entries, traces of exited processes are kept until they are read
+*/
+
+#define SYSTRACE_EVENTS_SIZE 256
+#define SYSTRACE_MAX_ORPHANS 8
+
+typedef struct _syscall_trace
+{
+    uint64_t pid;
+    uint32_t flags;
+    syscall_stats_t stats;
+
+    syscall_trace_record_t *events; // NULL without SYSTRACE_EVENTS
+    uint64_t head; // next event to read
+    uint64_t tail; // next event to write
+
+    struct _syscall_trace *next; // orphan list
+} syscall_trace_t;
+
+// flags 0 turns tracing off and drops what was recorded
+KRES systrace_enable(process_t *proc, uint32_t flags);
+KRES systrace_inherit(process_t *child, process_t *parent);
+
+// called on every syscall of a traced process with the tsc at entry and exit
+void systrace_record(process_t *proc, uint64_t num, const int64_t args[6], int64_t result, uint64_t entry_tsc, uint64_t exit_tsc);
+
+// the trace of a running or exited process
+syscall_trace_t *systrace_find(uint64_t pid);
+size_t systrace_read(syscall_trace_t *trace, syscall_trace_record_t *records, size_t max);
+
+// keeps unread events around after the process is gone
+void systrace_release(process_t *proc);
+
+#endif
@@ -7,13 +7,18 @@
 #include <kernel/status.h>
 #include <kernel/vmm.h>
 #include <kernel/proc/elf.h>
+#include <kernel/proc/image.h>
 #include <kernel/proc/stream.h>
+#include <kernel/hrtimer.h>
 
 /*
  kernel:    0x100000
  process:   0x400000
  stack:     0x800000
+ io ring:   0x8F0000
+ time page: 0x8FF000
  heap:      0x1000000
+ libraries: 0x100000000
 */
 
 #define PROCESS_VADDR 0x400000
@@ -21,9 +26,14 @@
 #define PROCESS_STACK_VADDR_BASE 0x800000
 #define PROCESS_STACK_SIZE 4096 * 64
 
+#define PROCESS_IO_RING_VADDR 0x8F0000 // below the time page, framebuffers start at 0x900000
+
+#define PROCESS_TIME_PAGE_VADDR 0x8FF000
+
 #define PROCESS_HEAP_VADDR_BASE 0x1000000
 
-#define PROCESS_MAX_STREAMS 8
+#define PROCESS_INITIAL_STREAMS 64 // the stream table doubles from here when it runs full
+#define PROCESS_MAX_STREAMS 4096
 #define PROCESS_MAX_HEAP_PAGES 1024 * 16
 
 typedef struct
@@ -34,28 +44,61 @@ typedef struct
 } __attribute__((packed)) task_state_t;
 
 struct _process;
+struct _io_ring;
+struct _syscall_trace;
+struct _wait_entry;
+
+#define TASK_STATUS_READY 0
+#define TASK_STATUS_BLOCKED 1
+#define TASK_STATUS_DEAD 2
 
 typedef struct _task
 {
     void **stack_pages; // physical addresses
     size_t num_stack_pages;
-    task_state_t state;
+    task_state_t state; // user state at the last syscall, used by fork and to start the task
+    void *fpu_state; // allocated on first fpu use
+
+    uintptr_t kernel_stack; // top of the kernel stack
+    uint64_t kernel_rsp;    // saved by switch_context
+
+    volatile uint8_t status;
+    hrtimer_t timeout;
+    struct _wait_entry *wait_entries; // wait queues the task is sleeping on
+    uint64_t wake_time; // for scheduling latency accounting
+    uint64_t syscall_tsc; // entry of the current syscall, only set while traced
+
+    uint64_t tid;
+    struct _process *proc; // NULL for kernel threads
+    void (*func)(void *);  // kernel thread entry
+    void *arg;
+
+    struct _task *next;        // run list
+    struct _task *thread_next; // other threads of the same process
+    struct _task *joiner;      // woken when the thread exits
 } task_t;
 
 typedef struct _process
 {
-    task_t task;
-    elf_file_t *elf;
+    task_t task; // main thread
+    task_t *threads; // every other thread
+    uint32_t num_threads; // including the main thread
+
+    exec_image_t *image;
 
     char path[MAX_PATH];
     page_table_t *pml4;
-    void **data_pages; // physical addresses
+    void **data_pages; // physical addresses of the private copies of writable segments
     size_t num_data_pages;
 
     void *heap_pages[PROCESS_MAX_HEAP_PAGES];
     size_t num_heap_pages;
 
-    stream_t *streams[PROCESS_MAX_STREAMS];
+    stream_t **streams; // indexed by the stream handles user space sees
+    uint64_t *streams_used; // bitmap, new streams take the lowest free index
+    size_t streams_size;
+    struct _io_ring *io_ring; // set up on request, not inherited by fork
+    struct _syscall_trace *syscall_trace; // NULL unless the process is traced
 
     char **arguments;
     uint16_t num_arguments;
@@ -72,7 +115,7 @@ void syscall_init(void);
 
 process_t *process_create(const char *path);
 void process_free(process_t *proc);
-process_t *process_clone(process_t *proc);
+process_t *process_clone(process_t *proc, task_t *task); // task is the thread that forks
 
 int process_set_args(process_t *proc, char **args, uint16_t num_args);
 int process_set_envars(process_t *proc, char **envars, uint16_t num_envars);
@@ -83,14 +126,32 @@ int process_set_stderr(process_t *proc, stream_t *stderr);
 
 int setup_initial_stack(process_t *proc);
 void *process_allocate_page(process_t *proc);
-size_t process_insert_stream(process_t *proc, stream_t *stream);
-size_t process_insert_file(process_t *proc, const char *path, uint8_t open_action);
+// both return the new index or a negative error, the table takes over the stream
+int64_t process_insert_stream(process_t *proc, stream_t *stream);
+int64_t process_insert_file(process_t *proc, const char *path, uint8_t open_action);
+stream_t *process_get_stream(process_t *proc, int64_t index); // NULL for closed or invalid indices
+stream_t *process_hold_stream(process_t *proc, int64_t index); // with a reference, dropped by stream_free
 void process_remove_stream(process_t *proc, size_t index);
 
 int process_register(process_t *proc);
 int process_unregister(process_t *proc);
 int execute_next_process(void);
 process_t *get_current_process(void);
+void process_exit(process_t *proc);
+
+// kernel threads share the kernel address space and never enter user mode
+task_t *kthread_create(void (*func)(void *), void *arg);
+
+// user threads share the address space, streams and heap of their process
+task_t *thread_create(process_t *proc, uint64_t rip, uint64_t rsp, uint64_t arg);
+void thread_exit(task_t *task);
+int thread_join(task_t *task, uint64_t tid);
+
+task_t *get_current_task(void);
+void task_wakeup(task_t *task);
+
+// switches to the next ready task, returns once the caller is scheduled again
+void schedule(void);
 process_t *get_process_from_pid(uint64_t pid);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef _KERNEL_UACCESS_H
+#define _KERNEL_UACCESS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <kernel/status.h>
+#include <kernel/proc/task.h>
+
+/*
+ syscalls run on the kernel pml4, user memory is reached through the identity mapped frames
+ these walk the page tables of the process page by page, since neighbouring user pages are rarely neighbouring frames
+*/
+
+KRES copy_from_user(process_t *proc, void *dest, uintptr_t src, size_t size);
+KRES copy_to_user(process_t *proc, uintptr_t dest, const void *src, size_t size);
+
+// returns the length of the string without the terminator
+int64_t strncpy_from_user(process_t *proc, char *dest, uintptr_t src, size_t size);
+char *strdup_from_user(process_t *proc, uintptr_t src, size_t max);
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef _KERNEL_WAITQUEUE_H
+#define _KERNEL_WAITQUEUE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <kernel/status.h>
+
+/*
+ tasks sleep on a wait queue until whoever changes the condition wakes them
+ entries live on the kernel stack of the waiting task, all calls need interrupts disabled
+ an entry with a callback is not tied to a task, waking it only runs the callback
+*/
+
+struct _task;
+struct _wait_queue;
+
+typedef struct _wait_entry
+{
+    struct _task *task;
+    struct _wait_queue *queue;
+    bool woken;
+
+    void (*func)(struct _wait_entry *entry); // instead of waking the task
+    void *data;
+
+    struct _wait_entry *next;      // in the queue
+    struct _wait_entry *task_next; // other queues the task is on
+} wait_entry_t;
+
+typedef struct _wait_queue
+{
+    wait_entry_t *head;
+} wait_queue_t;
+
+void wait_queue_init(wait_queue_t *queue);
+
+// a task can be on several queues before it blocks, every entry has to be removed again
+void wait_queue_add(wait_queue_t *queue, wait_entry_t *entry, struct _task *task);
+void wait_queue_add_callback(wait_queue_t *queue, wait_entry_t *entry, void (*func)(wait_entry_t *entry), void *data);
+void wait_queue_remove(wait_entry_t *entry);
+
+// blocks the task once, the caller checks its condition again afterwards
+void wait_queue_sleep(wait_queue_t *queue, struct _task *task);
+
+void wait_queue_wake_all(wait_queue_t *queue);
+
+// drops the entries of a task that is killed while waiting
+void wait_queue_cancel(struct _task *task);
+
+#endif
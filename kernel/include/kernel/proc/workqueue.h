@@ -0,0 +1,25 @@
+#ifndef _KERNEL_WORKQUEUE_H
+#define _KERNEL_WORKQUEUE_H
+
+#include <stdbool.h>
+#include <kernel/status.h>
+
+typedef struct _work
+{
+    void (*func)(struct _work *work);
+    void *data;
+
+    volatile bool pending;
+    struct _work *next;
+} work_t;
+
+int workqueue_init(void);
+
+void work_init(work_t *work, void (*func)(work_t *work), void *data);
+
+// safe to call from interrupt handlers, returns false if the work was already pending
+bool work_queue(work_t *work);
+// takes pending work off the queue, returns false if it was not pending, it may still be running
+bool work_cancel(work_t *work);
+
+#endif
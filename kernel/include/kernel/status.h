@@ -14,6 +14,7 @@
 #define RES_UNAVAILABLE 6
 #define RES_TIMEOUT 7
 #define RES_ACCESS_DENIED 8
+#define RES_WOULDBLOCK 9 // a non-blocking stream is not ready
 
 #define RES_EUNKNOWN 10 // TODO: remove
 #define RES_ETEST 11
@@ -0,0 +1,53 @@
+#ifndef _KERNEL_TIME_H
+#define _KERNEL_TIME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <kernel/status.h>
+#include <kernel/isr.h>
+
+#define NSEC_PER_SEC 1000000000ULL
+#define NSEC_PER_MSEC 1000000ULL
+
+#define TIME_TICK_HZ 100
+
+#define CLOCK_REALTIME 0
+#define CLOCK_MONOTONIC 1
+
+typedef struct
+{
+    int64_t tv_sec;
+    int64_t tv_nsec;
+} timespec_t;
+
+// read-only page mapped into every process at PROCESS_TIME_PAGE_VADDR
+// ns = ns_base + (((rdtsc - tsc_base) * mult) >> shift), retry while seq is odd or changed
+typedef struct
+{
+    volatile uint32_t seq;
+    uint32_t valid; // 0 if there is no usable tsc
+    uint32_t mult;
+    uint32_t shift;
+    uint64_t tsc_base;
+    uint64_t ns_base;
+    uint64_t tsc_frequency;
+} __attribute__((packed)) time_page_t;
+
+int time_init(void);
+
+// monotonic nanoseconds since time_init
+uint64_t time_get_ns(void);
+uint64_t time_get_tsc_frequency(void);
+// 0 without a usable tsc
+uint64_t time_tsc_to_ns(uint64_t cycles);
+
+// physical address of the time page
+void *time_get_page(void);
+
+// tick handlers run every 1/TIME_TICK_HZ seconds and may not return (scheduler)
+void register_tick_handler(void (*func)(interrupt_frame_t *frame));
+
+// called when the earliest hrtimer changed
+void clockevent_reprogram(void);
+
+#endif
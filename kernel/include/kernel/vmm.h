@@ -27,9 +27,11 @@ typedef struct page_table
 int pml4_map(page_table_t *pml4, void *virt, void *phys, uint64_t flags);
 int pml4_map_range(page_table_t *pml4, void *virt, void *phys, size_t num, uint64_t flags);
 uint64_t pml4_get_phys(page_table_t *pml4, void *virt, bool user);
+uint64_t pml4_get_entry(page_table_t *pml4, void *virt); // 4 KiB page table entry, 0 if not present
 
 // WARNING: pml4 needs to be a physical address
 int pml4_switch(page_table_t *pml4);
+page_table_t *pml4_get_current(void);
 
 void *page_align_address_lower(void *addr);
 void *page_align_address_higer(void *addr);
@@ -0,0 +1,58 @@
+#include <kernel/cpu.h>
+
+uint64_t cpu_read_msr(uint32_t msr)
+{
+    uint32_t low, high;
+    __asm__ volatile("rdmsr" : "=a"(low), "=d"(high) : "c"(msr));
+    return ((uint64_t)high << 32) | low;
+}
+
+void cpu_write_msr(uint32_t msr, uint64_t value)
+{
+    __asm__ volatile("wrmsr" : : "c"(msr), "a"((uint32_t)value), "d"((uint32_t)(value >> 32)));
+}
+
+void cpu_cpuid(uint32_t leaf, uint32_t subleaf, uint32_t *eax, uint32_t *ebx, uint32_t *ecx, uint32_t *edx)
+{
+    uint32_t a, b, c, d;
+    __asm__ volatile("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "a"(leaf), "c"(subleaf));
+
+    if (eax)
+    {
+        *eax = a;
+    }
+    if (ebx)
+    {
+        *ebx = b;
+    }
+    if (ecx)
+    {
+        *ecx = c;
+    }
+    if (edx)
+    {
+        *edx = d;
+    }
+}
+
+uint64_t cpu_read_tsc(void)
+{
+    uint32_t low, high;
+    __asm__ volatile("rdtsc" : "=a"(low), "=d"(high));
+    return ((uint64_t)high << 32) | low;
+}
+
+uint64_t cpu_irq_save(void)
+{
+    uint64_t flags;
+    __asm__ volatile("pushfq; popq %0; cli" : "=r"(flags) : : "memory");
+    return flags;
+}
+
+void cpu_irq_restore(uint64_t flags)
+{
+    if (flags & 0x200)
+    {
+        __asm__ volatile("sti" : : : "memory");
+    }
+}
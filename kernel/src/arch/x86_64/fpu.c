@@ -0,0 +1,239 @@
+#include <kernel/fpu.h>
+#include <kernel/cpu.h>
+#include <kernel/pmm.h>
+#include <kernel/string.h>
+#include <kernel/log.h>
+#include <kernel/proc/task.h>
+
+#define CPUID_FEAT_ECX_XSAVE (1 << 26)
+#define CPUID_FEAT_ECX_AVX (1 << 28)
+#define CPUID_XSAVE_EAX_XSAVEOPT (1 << 0)
+
+#define CR0_TS (1 << 3)
+#define CR4_OSXSAVE (1 << 18)
+
+#define XCR0_X87 (1 << 0)
+#define XCR0_SSE (1 << 1)
+#define XCR0_AVX (1 << 2)
+
+#define FXSAVE_AREA_SIZE 512
+#define MXCSR_DEFAULT 0x1F80
+
+static bool use_xsave = false;
+static bool use_xsaveopt = false;
+static uint64_t xcr0 = 0;
+static size_t state_size = FXSAVE_AREA_SIZE;
+
+static void *initial_state = NULL; // state after fninit, copied into every new task
+static task_t *fpu_owner = NULL;   // task whose state is currently loaded in the registers
+
+static inline uint64_t read_cr0(void)
+{
+    uint64_t cr0;
+    __asm__ volatile("movq %%cr0, %0" : "=r"(cr0));
+    return cr0;
+}
+
+static inline void set_ts(void)
+{
+    __asm__ volatile("movq %0, %%cr0" : : "r"(read_cr0() | CR0_TS) : "memory");
+}
+
+static inline void clts(void)
+{
+    __asm__ volatile("clts" : : : "memory");
+}
+
+static inline void xsetbv(uint32_t reg, uint64_t value)
+{
+    __asm__ volatile("xsetbv" : : "c"(reg), "a"((uint32_t)value), "d"((uint32_t)(value >> 32)));
+}
+
+static void fpu_save(void *area)
+{
+    if (use_xsaveopt)
+    {
+        __asm__ volatile("xsaveopt64 (%0)" : : "r"(area), "a"(0xFFFFFFFF), "d"(0xFFFFFFFF) : "memory");
+    }
+    else if (use_xsave)
+    {
+        __asm__ volatile("xsave64 (%0)" : : "r"(area), "a"(0xFFFFFFFF), "d"(0xFFFFFFFF) : "memory");
+    }
+    else
+    {
+        __asm__ volatile("fxsave64 (%0)" : : "r"(area) : "memory");
+    }
+}
+
+static void fpu_restore(void *area)
+{
+    if (use_xsave)
+    {
+        __asm__ volatile("xrstor64 (%0)" : : "r"(area), "a"(0xFFFFFFFF), "d"(0xFFFFFFFF) : "memory");
+    }
+    else
+    {
+        __asm__ volatile("fxrstor64 (%0)" : : "r"(area) : "memory");
+    }
+}
+
+// areas are whole pages, so the 64 byte alignment xsave needs comes for free
+static void *fpu_alloc_state(void)
+{
+    void *area = pmm_alloc();
+    if (!area)
+    {
+        return NULL;
+    }
+
+    memcpy(area, initial_state, state_size);
+    return area;
+}
+
+int fpu_init(void)
+{
+    uint32_t ecx;
+    cpu_cpuid(1, 0, NULL, NULL, &ecx, NULL);
+
+    if (ecx & CPUID_FEAT_ECX_XSAVE)
+    {
+        uint64_t cr4;
+        __asm__ volatile("movq %%cr4, %0" : "=r"(cr4));
+        __asm__ volatile("movq %0, %%cr4" : : "r"(cr4 | CR4_OSXSAVE));
+
+        xcr0 = XCR0_X87 | XCR0_SSE;
+        if (ecx & CPUID_FEAT_ECX_AVX)
+        {
+            xcr0 |= XCR0_AVX;
+        }
+        xsetbv(0, xcr0);
+
+        // ebx reports the area size for the features currently enabled in xcr0
+        uint32_t size;
+        cpu_cpuid(0xD, 0, NULL, &size, NULL, NULL);
+        state_size = size;
+
+        uint32_t eax;
+        cpu_cpuid(0xD, 1, &eax, NULL, NULL, NULL);
+        use_xsaveopt = eax & CPUID_XSAVE_EAX_XSAVEOPT;
+        use_xsave = true;
+    }
+
+    if (state_size > PAGE_SIZE)
+    {
+        LOG_ERROR("fpu state of %ld bytes does not fit into a page", state_size);
+        return -RES_OVERFLOW;
+    }
+
+    initial_state = pmm_alloc();
+    if (!initial_state)
+    {
+        return -RES_NOMEM;
+    }
+    memset(initial_state, 0, PAGE_SIZE);
+
+    uint32_t mxcsr = MXCSR_DEFAULT;
+    clts();
+    __asm__ volatile("fninit; ldmxcsr %0" : : "m"(mxcsr));
+    fpu_save(initial_state);
+
+    LOG_INFO("fpu: %s, xcr0 0x%lx, %ld byte state", use_xsaveopt ? "xsaveopt" : (use_xsave ? "xsave" : "fxsave"), xcr0, state_size);
+
+    return RES_SUCCESS;
+}
+
+size_t fpu_state_size(void)
+{
+    return state_size;
+}
+
+bool fpu_xsave_enabled(void)
+{
+    return use_xsave;
+}
+
+void fpu_switch(task_t *next)
+{
+    if (next == fpu_owner)
+    {
+        clts();
+    }
+    else
+    {
+        set_ts();
+    }
+}
+
+int fpu_handle_trap(task_t *task)
+{
+    clts();
+
+    if (fpu_owner == task)
+    {
+        return RES_SUCCESS;
+    }
+
+    if (!task->fpu_state)
+    {
+        task->fpu_state = fpu_alloc_state();
+        if (!task->fpu_state)
+        {
+            set_ts();
+            return -RES_NOMEM;
+        }
+    }
+
+    if (fpu_owner)
+    {
+        fpu_save(fpu_owner->fpu_state);
+    }
+
+    fpu_restore(task->fpu_state);
+    fpu_owner = task;
+
+    return RES_SUCCESS;
+}
+
+int fpu_clone(task_t *dst, task_t *src)
+{
+    dst->fpu_state = NULL;
+    if (!src->fpu_state)
+    {
+        return RES_SUCCESS;
+    }
+
+    if (fpu_owner == src)
+    {
+        // the live registers are newer than the saved area
+        uint64_t cr0 = read_cr0();
+        clts();
+        fpu_save(src->fpu_state);
+        if (cr0 & CR0_TS)
+        {
+            set_ts();
+        }
+    }
+
+    dst->fpu_state = pmm_alloc();
+    if (!dst->fpu_state)
+    {
+        return -RES_NOMEM;
+    }
+    memcpy(dst->fpu_state, src->fpu_state, state_size);
+
+    return RES_SUCCESS;
+}
+
+void fpu_release(task_t *task)
+{
+    if (fpu_owner == task)
+    {
+        fpu_owner = NULL;
+    }
+
+    if (task->fpu_state)
+    {
+        pmm_free(task->fpu_state);
+        task->fpu_state = NULL;
+    }
+}
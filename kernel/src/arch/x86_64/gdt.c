@@ -113,3 +113,8 @@ int segmentation_init(void)
 
     return 0;
 }
+
+void tss_set_rsp0(uint64_t rsp0)
+{
+    tss.rsp0 = rsp0;
+}
@@ -4,6 +4,9 @@
 #include <kernel/port.h>
 #include <kernel/proc/task.h>
 #include <kernel/dbg.h>
+#include <kernel/lapic.h>
+#include <kernel/fpu.h>
+#include <kernel/proc/scheduler.h>
 
 #define INTERRUPT_GATE 0x8E
 #define INTERRUPT_TRAP 0x8F
@@ -111,29 +114,39 @@ extern page_table_t *kernel_pml4;
 
 void irq_handler(interrupt_frame_t *frame)
 {
+    // syscalls run with interrupts enabled, so this might not be a user pml4
+    page_table_t *pml4 = pml4_get_current();
     if (pml4_switch(kernel_pml4) < 0)
     {
         PANIC("failed to switch pml4");
     }
 
-    if (frame->int_no >= 40)
+    if (frame->int_no < 48)
     {
-        port_byte_out(0xA0, 0x20);
+        if (frame->int_no >= 40)
+        {
+            port_byte_out(0xA0, 0x20);
+        }
+        port_byte_out(0x20, 0x20);
+    }
+    else if (frame->int_no != LAPIC_SPURIOUS_VECTOR)
+    {
+        lapic_eoi(); // msi and local apic vectors
     }
-    port_byte_out(0x20, 0x20);
-    
+
     if (interrupt_handlers[frame->int_no] != NULL)
     {
         interrupt_handlers[frame->int_no](frame);
     }
 
-    process_t *proc = get_current_process();
-    if (!proc)
+    // woken kernel threads run before we go back to user mode
+    if ((frame->cs & 3) == 3 && need_resched())
     {
-        return;
+        schedule();
     }
 
-    if (pml4_switch(proc->pml4) < 0)
+    // the handler may have scheduled, but the frame still belongs to the interrupted context
+    if (pml4_switch(pml4) < 0)
     {
         PANIC("failed to switch pml4");
     }
@@ -171,11 +184,25 @@ char *exception_names[] = {
 
 void exception_handler(interrupt_frame_t *frame)
 {
+    page_table_t *pml4 = pml4_get_current();
     if (pml4_switch(kernel_pml4) < 0)
     {
         PANIC("failed to switch pml4");
     }
 
+    if (frame->int_no == 7) // device not available, the current task wants its fpu state back
+    {
+        task_t *task = get_current_task();
+        if (task && !IS_ERROR(fpu_handle_trap(task)))
+        {
+            if (pml4_switch(pml4) < 0)
+            {
+                PANIC("failed to switch pml4");
+            }
+            return;
+        }
+    }
+
     LOG_ERROR("CPU exception triggered\n\n[Exception Info]\nType: %s\n", exception_names[frame->int_no]);
     switch (frame->int_no)
     {
@@ -203,7 +230,7 @@ void exception_handler(interrupt_frame_t *frame)
         }
         if (frame->err_code & 0b100)
         {
-            LOG_ERROR("- Memory access came from user ('%s') at 0x%x.\n", get_current_process()->path, get_current_process()->task.state.rip);
+            LOG_ERROR("- Memory access came from user ('%s') at 0x%x.\n", get_current_process()->path, frame->rip);
         }
         else
         {
@@ -0,0 +1,165 @@
+#include <kernel/lapic.h>
+#include <kernel/cpu.h>
+#include <kernel/log.h>
+
+#define LAPIC_REG_ID 0x20
+#define LAPIC_REG_EOI 0xB0
+#define LAPIC_REG_SVR 0xF0
+#define LAPIC_REG_LVT_TIMER 0x320
+#define LAPIC_REG_LVT_LINT0 0x350
+#define LAPIC_REG_LVT_LINT1 0x360
+#define LAPIC_REG_TIMER_INITIAL 0x380
+#define LAPIC_REG_TIMER_CURRENT 0x390
+#define LAPIC_REG_TIMER_DIVIDE 0x3E0
+
+#define LAPIC_SVR_ENABLE 0x100
+#define LAPIC_DELIVERY_EXTINT 0x700
+#define LAPIC_DELIVERY_NMI 0x400
+#define LAPIC_LVT_MASKED 0x10000
+#define LAPIC_TIMER_MODE_ONESHOT 0x0
+#define LAPIC_TIMER_MODE_TSC_DEADLINE 0x40000
+#define LAPIC_TIMER_DIVIDE_16 0x3
+
+#define CPUID_FEAT_ECX_TSC_DEADLINE (1 << 24)
+
+#define APIC_BASE_ENABLE (1 << 11)
+
+static uintptr_t lapic_base = 0;
+
+static uint64_t timer_tsc_frequency = 0;
+static uint64_t timer_frequency = 0; // lapic timer ticks per second after the divider
+static bool timer_tsc_deadline = false;
+
+static inline uint32_t lapic_read(uint32_t reg)
+{
+    return *(volatile uint32_t *)(lapic_base + reg);
+}
+
+static inline void lapic_write(uint32_t reg, uint32_t value)
+{
+    *(volatile uint32_t *)(lapic_base + reg) = value;
+}
+
+int lapic_init(page_table_t *pml4)
+{
+    uint64_t msr = cpu_read_msr(MSR_APIC_BASE);
+    uintptr_t phys = msr & 0xFFFFFF000;
+
+    if (pml4_map(pml4, (void *)phys, (void *)phys, PAGE_PRESENT | PAGE_WRITABLE | PAGE_NOT_CACHE) < 0)
+    {
+        return -RES_NOMEM;
+    }
+
+    cpu_write_msr(MSR_APIC_BASE, msr | APIC_BASE_ENABLE);
+    lapic_base = phys;
+
+    // keep the 8259 routed through LINT0 (virtual wire mode) so legacy irqs keep working
+    lapic_write(LAPIC_REG_LVT_LINT0, LAPIC_DELIVERY_EXTINT);
+    lapic_write(LAPIC_REG_LVT_LINT1, LAPIC_DELIVERY_NMI);
+    lapic_write(LAPIC_REG_SVR, LAPIC_SVR_ENABLE | LAPIC_SPURIOUS_VECTOR);
+
+    LOG_INFO("local apic %d at 0x%x", lapic_get_id(), lapic_base);
+
+    return RES_SUCCESS;
+}
+
+void lapic_eoi(void)
+{
+    if (lapic_base)
+    {
+        lapic_write(LAPIC_REG_EOI, 0);
+    }
+}
+
+uint8_t lapic_get_id(void)
+{
+    return lapic_read(LAPIC_REG_ID) >> 24;
+}
+
+uint64_t lapic_get_base(void)
+{
+    return lapic_base;
+}
+
+int lapic_timer_init(uint64_t tsc_frequency)
+{
+    if (!lapic_base || tsc_frequency == 0)
+    {
+        return -RES_UNAVAILABLE;
+    }
+
+    timer_tsc_frequency = tsc_frequency;
+
+    uint32_t ecx;
+    cpu_cpuid(1, 0, NULL, NULL, &ecx, NULL);
+    timer_tsc_deadline = (ecx & CPUID_FEAT_ECX_TSC_DEADLINE) != 0;
+
+    if (timer_tsc_deadline)
+    {
+        lapic_write(LAPIC_REG_LVT_TIMER, LAPIC_TIMER_VECTOR | LAPIC_TIMER_MODE_TSC_DEADLINE);
+        LOG_INFO("lapic timer in tsc-deadline mode");
+        return RES_SUCCESS;
+    }
+
+    // measure the timer against the already calibrated tsc for ~10ms
+    lapic_write(LAPIC_REG_TIMER_DIVIDE, LAPIC_TIMER_DIVIDE_16);
+    lapic_write(LAPIC_REG_LVT_TIMER, LAPIC_TIMER_VECTOR | LAPIC_LVT_MASKED);
+    lapic_write(LAPIC_REG_TIMER_INITIAL, 0xFFFFFFFF);
+
+    uint64_t start = cpu_read_tsc();
+    uint64_t wait = tsc_frequency / 100;
+    while (cpu_read_tsc() - start < wait);
+
+    uint32_t elapsed = 0xFFFFFFFF - lapic_read(LAPIC_REG_TIMER_CURRENT);
+    lapic_write(LAPIC_REG_TIMER_INITIAL, 0);
+
+    if (elapsed == 0)
+    {
+        return -RES_UNAVAILABLE;
+    }
+
+    timer_frequency = (uint64_t)elapsed * 100;
+    lapic_write(LAPIC_REG_LVT_TIMER, LAPIC_TIMER_VECTOR | LAPIC_TIMER_MODE_ONESHOT);
+
+    LOG_INFO("lapic timer running at %ld Hz", timer_frequency);
+
+    return RES_SUCCESS;
+}
+
+void lapic_timer_oneshot(uint64_t delta_ns)
+{
+    if (timer_tsc_deadline)
+    {
+        uint64_t ticks = (uint64_t)(((unsigned __int128)delta_ns * timer_tsc_frequency) / 1000000000);
+        cpu_write_msr(MSR_TSC_DEADLINE, cpu_read_tsc() + (ticks ? ticks : 1));
+        return;
+    }
+
+    uint64_t ticks = (uint64_t)(((unsigned __int128)delta_ns * timer_frequency) / 1000000000);
+    if (ticks == 0)
+    {
+        ticks = 1;
+    }
+    else if (ticks > 0xFFFFFFFF)
+    {
+        ticks = 0xFFFFFFFF; // the handler reprograms for the remaining time
+    }
+
+    lapic_write(LAPIC_REG_TIMER_INITIAL, (uint32_t)ticks);
+}
+
+void lapic_timer_stop(void)
+{
+    if (timer_tsc_deadline)
+    {
+        cpu_write_msr(MSR_TSC_DEADLINE, 0);
+        return;
+    }
+
+    lapic_write(LAPIC_REG_TIMER_INITIAL, 0);
+}
+
+bool lapic_timer_tsc_deadline(void)
+{
+    return timer_tsc_deadline;
+}
@@ -35,3 +35,8 @@ void port_dword_out(uint16_t port, uint32_t data)
 {
     __asm__("out %%eax, %%dx" : : "a"(data), "d"(port));
 }
+
+void port_bytes_out(uint16_t port, const uint8_t *data, size_t size)
+{
+    __asm__ volatile("rep outsb" : "+S"(data), "+c"(size) : "d"(port) : "memory");
+}
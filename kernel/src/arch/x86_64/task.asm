@@ -1,16 +1,15 @@
 global task_execute
 global syscall_init
+global switch_context
 extern syscall_handler
-extern rsp0_stack
-
-%define STACK_SIZE 4096*4
+extern kernel_stack_top
 
 section .code
 
 syscall_wrapper:
-    cli
+    ; fmask cleared IF, so nothing can interrupt us until we are on the kernel stack
     mov [rsp_temp], rsp
-    mov rsp, rsp0_stack + STACK_SIZE
+    mov rsp, [kernel_stack_top]
 
     push qword [rsp_temp] ; rsp
     push qword rcx ; rip
@@ -41,7 +40,9 @@ syscall_wrapper:
     mov r9, r8
     mov r8, r10
 
+    sti
     call syscall_handler
+    cli
 
     pop qword r9
     add rsp, 8
@@ -90,6 +91,28 @@ syscall_init:
     
     ret
 
+; void switch_context(uint64_t *save_rsp, uint64_t load_rsp)
+; only the callee saved registers survive, everything else is already on the stack of the caller
+switch_context:
+    push rbx
+    push rbp
+    push r12
+    push r13
+    push r14
+    push r15
+
+    mov [rdi], rsp
+    mov rsp, rsi
+
+    pop r15
+    pop r14
+    pop r13
+    pop r12
+    pop rbp
+    pop rbx
+
+    ret
+
 task_execute:
     push qword 0x1b
     push qword rsi
@@ -91,7 +91,7 @@ int pml4_map_range(page_table_t *pml4, void *virt, void *phys, size_t num, uint6
     return 0;
 }
 
-uint64_t pml4_get_phys(page_table_t *pml4, void *virt, bool user)
+uint64_t pml4_get_entry(page_table_t *pml4, void *virt)
 {
     uint64_t virt_addr = (uint64_t)virt;
 
@@ -126,12 +126,23 @@ uint64_t pml4_get_phys(page_table_t *pml4, void *virt, bool user)
     {
         return 0;
     }
+
+    return entry;
+}
+
+uint64_t pml4_get_phys(page_table_t *pml4, void *virt, bool user)
+{
+    uint64_t entry = pml4_get_entry(pml4, virt);
+    if (!entry)
+    {
+        return 0;
+    }
     if ((entry & PAGE_USER) != PAGE_USER && user)
     {
         return 0;
     }
 
-    uint64_t phys_addr = (entry & ~0xFFF) | (virt_addr & 0xFFF);
+    uint64_t phys_addr = (entry & ~0xFFF & ~PAGE_NO_EXECUTE) | ((uint64_t)virt & 0xFFF);
 
     return phys_addr;
 }
@@ -144,6 +155,11 @@ int pml4_switch(page_table_t *pml4)
     return 0;
 }
 
+page_table_t *pml4_get_current(void)
+{
+    return current_page_table;
+}
+
 void *page_align_address_lower(void *addr)
 {
     uintptr_t _addr = (uintptr_t)addr;
@@ -2,6 +2,7 @@
 #include <kernel/dev/pci.h>
 #include <kernel/kmm.h>
 #include <kernel/vec.h>
+#include <kernel/cpu.h>
 
 const char qwertz_normal[128] = {
     /* 0x00 */ 0, 0, '1', '2', '3', '4', '5', '6',
@@ -127,6 +128,7 @@ KRES driver_instatiate(const driver_t *d, pci_device_t *pci_dev)
         device_t *dev = d->init_device(k, pci_dev);
         if (dev)
         {
+            wait_queue_init(&dev->wait);
             cvector_push(devices, dev);
             LOG_INFO("Initialized Device '%s' from '%s' (module %s) by %s (id 0x%x:0x%x)",
                      d->device_name,
@@ -234,6 +236,25 @@ int device_write(char c, chardev_color_t fg, chardev_color_t bg, device_t *dev)
     return dev->ops->write(c, fg, bg, dev);
 }
 
+int device_write_buffer(const char *data, size_t size, chardev_color_t fg, chardev_color_t bg, device_t *dev)
+{
+    if (dev->ops->write_buffer)
+    {
+        return dev->ops->write_buffer(data, size, fg, bg, dev);
+    }
+
+    for (size_t i = 0; i < size; i++)
+    {
+        int res = dev->ops->write(data[i], fg, bg, dev);
+        if (res < 0)
+        {
+            return res;
+        }
+    }
+
+    return 0;
+}
+
 int device_read_block(uint64_t lba, uint8_t *data, device_t *dev)
 {
     return dev->ops->read_block(lba, data, dev);
@@ -268,3 +289,20 @@ int device_update_display(video_rect_t *rect, void *framebuffer, device_t *dev)
 {
     return dev->ops->update_display(rect, framebuffer, dev);
 }
+
+bool device_has_data(device_t *dev)
+{
+    if (!dev->ops->has_data)
+    {
+        return false;
+    }
+
+    return dev->ops->has_data(dev);
+}
+
+void device_notify(device_t *dev)
+{
+    uint64_t flags = cpu_irq_save();
+    wait_queue_wake_all(&dev->wait);
+    cpu_irq_restore(flags);
+}
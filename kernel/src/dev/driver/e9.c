@@ -20,6 +20,21 @@ int e9_write(char c, chardev_color_t fg, chardev_color_t bg, device_t *dev)
     return 0;
 }
 
+int e9_write_buffer(const char *data, size_t size, chardev_color_t fg, chardev_color_t bg, device_t *dev)
+{
+    if (!dev)
+    {
+        return -RES_INVARG;
+    }
+
+    (void)fg;
+    (void)bg;
+
+    port_bytes_out(0xE9, (const uint8_t *)data, size);
+
+    return 0;
+}
+
 int e9_free(device_t *dev)
 {
     if (!dev)
@@ -54,6 +69,7 @@ driver_t e9_driver = {
 device_ops_t e9_ops = {
     .free = &e9_free,
     .write = &e9_write,
+    .write_buffer = &e9_write_buffer,
 };
 
 device_t *e9_create(size_t index, struct _pci_device *pci_dev)
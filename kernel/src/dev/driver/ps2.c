@@ -2,6 +2,8 @@
 #include <kernel/port.h>
 #include <kernel/kmm.h>
 #include <kernel/isr.h>
+#include <kernel/cpu.h>
+#include <kernel/proc/workqueue.h>
 #include <stdbool.h>
 
 static bool ps2_initialized = false;
@@ -53,12 +55,19 @@ void set_keyboard_leds(bool scroll_lock, bool num_lock, bool caps_lock)
     while (port_byte_in(KEYBOARD_DATA_PORT) != 0xFA);
 }
 
-static void keyboard_irq(interrupt_frame_t *frame)
+// raw scancodes handed from the interrupt handler to keyboard_work
+#define SCANCODE_BUFFER_SIZE 64
+static uint8_t scancode_buffer[SCANCODE_BUFFER_SIZE];
+static volatile uint8_t scancode_read = 0;
+static volatile uint8_t scancode_write = 0;
+
+static work_t keyboard_work_item;
+static device_t *keyboard_device = NULL;
+
+static void keyboard_handle_scancode(uint8_t scancode)
 {
-    (void)frame;
     key_buffer_size++;
 
-    uint8_t scancode = port_byte_in(KEYBOARD_DATA_PORT);
     bool key_released = scancode & 0x80;
     uint8_t key_code = scancode & 0x7F;
 
@@ -144,6 +153,49 @@ static void keyboard_irq(interrupt_frame_t *frame)
     // TODO: handle overflow
 }
 
+static void keyboard_work(work_t *)
+{
+    uint8_t before = key_buffer_size;
+    while (1)
+    {
+        uint64_t flags = cpu_irq_save();
+        if (scancode_read == scancode_write)
+        {
+            cpu_irq_restore(flags);
+            break;
+        }
+
+        uint8_t scancode = scancode_buffer[scancode_read];
+        scancode_read = (scancode_read + 1) % SCANCODE_BUFFER_SIZE;
+        cpu_irq_restore(flags);
+
+        keyboard_handle_scancode(scancode);
+    }
+
+    // modifier keys alone do not produce a packet
+    if (key_buffer_size > before && keyboard_device)
+    {
+        device_notify(keyboard_device);
+    }
+}
+
+static void keyboard_irq(interrupt_frame_t *frame)
+{
+    (void)frame;
+
+    // reading the data port acknowledges the byte, decoding happens in keyboard_work
+    uint8_t scancode = port_byte_in(KEYBOARD_DATA_PORT);
+
+    uint8_t next = (scancode_write + 1) % SCANCODE_BUFFER_SIZE;
+    if (next != scancode_read)
+    {
+        scancode_buffer[scancode_write] = scancode;
+        scancode_write = next;
+    }
+
+    work_queue(&keyboard_work_item);
+}
+
 int ps2_poll(inputpacket_t *packet, device_t *dev)
 {
     if (!dev)
@@ -165,6 +217,11 @@ int ps2_poll(inputpacket_t *packet, device_t *dev)
     return 0;
 }
 
+bool ps2_has_data(device_t *)
+{
+    return key_buffer_size > 0;
+}
+
 int ps2_free(device_t *dev)
 {
     if (!dev)
@@ -199,6 +256,7 @@ driver_t ps2_driver = {
 device_ops_t ps2_ops = {
     .free = &ps2_free,
     .poll = &ps2_poll,
+    .has_data = &ps2_has_data,
 };
 
 device_t *ps2_create(size_t index, struct _pci_device *pci_dev)
@@ -223,6 +281,8 @@ device_t *ps2_create(size_t index, struct _pci_device *pci_dev)
     dev->ops = &ps2_ops;
     dev->pci_dev = pci_dev;
 
+    keyboard_device = dev;
+    work_init(&keyboard_work_item, &keyboard_work, NULL);
     register_interrupt_handler(33, &keyboard_irq);
 
     return dev;
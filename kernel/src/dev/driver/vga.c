@@ -48,36 +48,25 @@ static void vga_backspace(void)
     col--;
 }
 
-int vga_write(char c, chardev_color_t fg, chardev_color_t bg, device_t *dev)
+static void vga_put(char c, uint8_t color)
 {
-    if (!dev)
-    {
-        return -RES_INVARG;
-    }
-
-    uint8_t color = (fg & 0x0F) | (bg << 4);
-
     if (c == '\n')
     {
         vga_newline(color);
-        return 0;
+        return;
     }
     if (c == '\b')
     {
         vga_backspace();
-        return 0;
+        return;
     }
     else if (c == '\t')
     {
         for (uint8_t i = 0; i < 4; i++)
         {
-            int res = 0;
-            if ((res = vga_write(' ', fg, bg, dev)) != 0)
-            {
-                return res;
-            }
+            vga_put(' ', color);
         }
-        return 0;
+        return;
     }
 
     if (col > NUM_COLS)
@@ -87,6 +76,32 @@ int vga_write(char c, chardev_color_t fg, chardev_color_t bg, device_t *dev)
 
     vga_char_mem[col + row * NUM_COLS] = ((uint16_t)(color << 8)) | c;
     col++;
+}
+
+int vga_write(char c, chardev_color_t fg, chardev_color_t bg, device_t *dev)
+{
+    if (!dev)
+    {
+        return -RES_INVARG;
+    }
+
+    vga_put(c, (fg & 0x0F) | (bg << 4));
+
+    return 0;
+}
+
+int vga_write_buffer(const char *data, size_t size, chardev_color_t fg, chardev_color_t bg, device_t *dev)
+{
+    if (!dev)
+    {
+        return -RES_INVARG;
+    }
+
+    uint8_t color = (fg & 0x0F) | (bg << 4);
+    for (size_t i = 0; i < size; i++)
+    {
+        vga_put(data[i], color);
+    }
 
     return 0;
 }
@@ -128,6 +143,7 @@ driver_t vga_driver = {
 device_ops_t vga_ops = {
     .free = &vga_free,
     .write = &vga_write,
+    .write_buffer = &vga_write_buffer,
 };
 
 device_t *vga_create(size_t index, struct _pci_device *pci_dev)
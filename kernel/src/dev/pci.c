@@ -1,10 +1,29 @@
 #include <kernel/dev/pci.h>
 #include <kernel/port.h>
 #include <kernel/kmm.h>
+#include <kernel/vmm.h>
+#include <kernel/lapic.h>
 
 #define PCI_DATA_PORT 0xCFC
 #define PCI_COMMAND_PORT 0xCF8
 
+#define PCI_COMMAND_INTX_DISABLE (1 << 10)
+#define PCI_STATUS_CAP_LIST (1 << 4)
+
+#define PCI_MSI_CTRL_ENABLE 0x1
+#define PCI_MSI_CTRL_MME_MASK 0x70
+#define PCI_MSI_CTRL_64BIT 0x80
+
+#define PCI_MSIX_CTRL_TABLE_SIZE 0x7FF
+#define PCI_MSIX_CTRL_FUNCTION_MASK (1 << 14)
+#define PCI_MSIX_CTRL_ENABLE (1 << 15)
+#define PCI_MSIX_ENTRY_SIZE 16
+#define PCI_MSIX_ENTRY_MASKED 0x1
+
+#define MSI_ADDRESS_BASE 0xFEE00000
+
+extern page_table_t *kernel_pml4;
+
 static pci_device_t *pci_devices = NULL;
 static size_t pci_device_count = 0;
 static size_t pci_device_capacity = 0;
@@ -16,7 +35,7 @@ uint32_t pci_read(uint8_t bus, uint8_t device, uint8_t function, uint8_t offset)
     return port_dword_in(PCI_DATA_PORT);
 }
 
-static void pci_write(uint8_t bus, uint8_t device, uint8_t function, uint8_t offset, uint32_t value)
+void pci_write(uint8_t bus, uint8_t device, uint8_t function, uint8_t offset, uint32_t value)
 {
     uint32_t id = (1 << 31) | (bus << 16) | (device << 11) | (function << 8) | (offset & 0xFC);
     port_dword_out(PCI_COMMAND_PORT, id);
@@ -39,6 +58,21 @@ void pci_write_word(uint8_t bus, uint8_t device, uint8_t function, uint8_t offse
     pci_write(bus, device, function, offset & 0xFC, new_val);
 }
 
+uint8_t pci_read_byte(uint8_t bus, uint8_t device, uint8_t function, uint8_t offset)
+{
+    uint32_t data = pci_read(bus, device, function, offset & ~3);
+    return (data >> ((offset & 3) * 8)) & 0xFF;
+}
+
+void pci_read_bytes(uint8_t bus, uint8_t device, uint8_t function, uint8_t offset, void *buffer, uint8_t size)
+{
+    uint8_t *dst = (uint8_t *)buffer;
+    for (uint8_t i = 0; i < size; ++i)
+    {
+        dst[i] = pci_read_byte(bus, device, function, offset + i);
+    }
+}
+
 static bool pci_device_exists(uint8_t bus, uint8_t device, uint8_t function)
 {
     uint32_t data = pci_read(bus, device, function, 0x00);
@@ -102,12 +136,22 @@ static int add_pci_device(uint8_t bus, uint8_t device, uint8_t function)
     dev->subclass_code = (class_info >> 16) & 0xFF;
     dev->prog_if = (class_info >> 8) & 0xFF;
     dev->header_type = (pci_read(bus, device, function, 0x0C) >> 16) & 0xFF;
+    dev->interrupt_line = pci_read_byte(bus, device, function, 0x3C);
 
     for (uint8_t bar_num = 0; bar_num < MAX_BARS; bar_num++)
     {
         populate_base_address_register(&dev->bars[bar_num], bus, device, function, bar_num);
     }
 
+    dev->msi_cap = pci_find_capability(dev, PCI_CAP_ID_MSI, 0);
+    dev->msix_cap = pci_find_capability(dev, PCI_CAP_ID_MSIX, 0);
+    dev->msix_table_size = 0;
+    dev->msix_table = NULL;
+    if (dev->msix_cap)
+    {
+        dev->msix_table_size = (pci_read_word(bus, device, function, dev->msix_cap + 2) & PCI_MSIX_CTRL_TABLE_SIZE) + 1;
+    }
+
     LOG_INFO("Discovered PCI Device (vendor: 0x%x, device: 0x%x)", dev->vendor_id, dev->device_id);
 
     return 0;
@@ -201,3 +245,193 @@ void pci_enable_device(pci_device_t *dev)
     cmd |= (1 << 1) | (1 << 2); // Enable Memory Space and Bus Master
     pci_write_word(dev->bus, dev->device, dev->function, 0x04, cmd);
 }
+
+uint8_t pci_find_capability(pci_device_t *dev, uint8_t cap_id, uint8_t start)
+{
+    uint8_t cap_ptr;
+    if (start == 0)
+    {
+        if (!(pci_read_word(dev->bus, dev->device, dev->function, 0x06) & PCI_STATUS_CAP_LIST))
+        {
+            return 0;
+        }
+        cap_ptr = pci_read_byte(dev->bus, dev->device, dev->function, PCI_CAP_PTR_OFFSET);
+    }
+    else
+    {
+        cap_ptr = pci_read_byte(dev->bus, dev->device, dev->function, start + 1);
+    }
+
+    // the list lives in the 192 bytes after the header, bound the walk in case it loops
+    for (int i = 0; i < 48 && cap_ptr >= 0x40; i++)
+    {
+        cap_ptr &= 0xFC;
+        if (pci_read_byte(dev->bus, dev->device, dev->function, cap_ptr) == cap_id)
+        {
+            return cap_ptr;
+        }
+        cap_ptr = pci_read_byte(dev->bus, dev->device, dev->function, cap_ptr + 1);
+    }
+
+    return 0;
+}
+
+static bool pci_vectors_used[256] = {0};
+
+int pci_alloc_vector(void (*handler)(interrupt_frame_t *))
+{
+    for (int vector = PCI_VECTOR_BASE; vector < PCI_VECTOR_END; vector++)
+    {
+        if (!pci_vectors_used[vector])
+        {
+            pci_vectors_used[vector] = true;
+            register_interrupt_handler(vector, handler);
+            return vector;
+        }
+    }
+
+    return -RES_UNAVAILABLE;
+}
+
+void pci_free_vector(int vector)
+{
+    if (vector < PCI_VECTOR_BASE || vector >= PCI_VECTOR_END)
+    {
+        return;
+    }
+
+    register_interrupt_handler(vector, NULL);
+    pci_vectors_used[vector] = false;
+}
+
+static void pci_disable_intx(pci_device_t *dev)
+{
+    uint16_t cmd = pci_read_word(dev->bus, dev->device, dev->function, 0x04);
+    pci_write_word(dev->bus, dev->device, dev->function, 0x04, cmd | PCI_COMMAND_INTX_DISABLE);
+}
+
+static inline uint32_t pci_msi_address(void)
+{
+    return MSI_ADDRESS_BASE | ((uint32_t)lapic_get_id() << 12);
+}
+
+KRES pci_enable_msi(pci_device_t *dev, uint8_t vector)
+{
+    if (!dev || !dev->msi_cap)
+    {
+        return -RES_UNAVAILABLE;
+    }
+
+    uint8_t cap = dev->msi_cap;
+    uint16_t ctrl = pci_read_word(dev->bus, dev->device, dev->function, cap + 2);
+
+    pci_write(dev->bus, dev->device, dev->function, cap + 4, pci_msi_address());
+    if (ctrl & PCI_MSI_CTRL_64BIT)
+    {
+        pci_write(dev->bus, dev->device, dev->function, cap + 8, 0);
+        pci_write_word(dev->bus, dev->device, dev->function, cap + 12, vector);
+    }
+    else
+    {
+        pci_write_word(dev->bus, dev->device, dev->function, cap + 8, vector);
+    }
+
+    ctrl &= ~PCI_MSI_CTRL_MME_MASK; // single message
+    ctrl |= PCI_MSI_CTRL_ENABLE;
+    pci_write_word(dev->bus, dev->device, dev->function, cap + 2, ctrl);
+
+    pci_disable_intx(dev);
+
+    return RES_SUCCESS;
+}
+
+KRES pci_enable_msix(pci_device_t *dev)
+{
+    if (!dev || !dev->msix_cap)
+    {
+        return -RES_UNAVAILABLE;
+    }
+
+    if (dev->msix_table)
+    {
+        return RES_SUCCESS;
+    }
+
+    uint8_t cap = dev->msix_cap;
+    uint32_t table = pci_read(dev->bus, dev->device, dev->function, cap + 4);
+    uint8_t bir = table & 0x7;
+    if (bir >= MAX_BARS || dev->bars[bir].type != BAR_TYPE_MEMORY_MAPPING)
+    {
+        return -RES_CORRUPT;
+    }
+
+    uintptr_t phys = dev->bars[bir].address + (table & ~0x7);
+    uintptr_t start = phys & ~(PAGE_SIZE - 1);
+    uintptr_t end = phys + dev->msix_table_size * PCI_MSIX_ENTRY_SIZE;
+    for (uintptr_t page = start; page < end; page += PAGE_SIZE)
+    {
+        if (pml4_map(kernel_pml4, (void *)page, (void *)page, PAGE_PRESENT | PAGE_WRITABLE | PAGE_NOT_CACHE) < 0)
+        {
+            return -RES_NOMEM;
+        }
+    }
+
+    dev->msix_table = (volatile uint32_t *)phys;
+
+    // keep the function masked while the table is brought into a known state
+    uint16_t ctrl = pci_read_word(dev->bus, dev->device, dev->function, cap + 2);
+    pci_write_word(dev->bus, dev->device, dev->function, cap + 2, ctrl | PCI_MSIX_CTRL_ENABLE | PCI_MSIX_CTRL_FUNCTION_MASK);
+
+    for (uint16_t i = 0; i < dev->msix_table_size; i++)
+    {
+        dev->msix_table[i * 4 + 3] |= PCI_MSIX_ENTRY_MASKED;
+    }
+
+    pci_disable_intx(dev);
+
+    ctrl = pci_read_word(dev->bus, dev->device, dev->function, cap + 2);
+    pci_write_word(dev->bus, dev->device, dev->function, cap + 2, ctrl & ~PCI_MSIX_CTRL_FUNCTION_MASK);
+
+    return RES_SUCCESS;
+}
+
+KRES pci_set_msix_vector(pci_device_t *dev, uint16_t entry, uint8_t vector)
+{
+    if (!dev || !dev->msix_table || entry >= dev->msix_table_size)
+    {
+        return -RES_INVARG;
+    }
+
+    volatile uint32_t *e = &dev->msix_table[entry * 4];
+    e[3] |= PCI_MSIX_ENTRY_MASKED;
+    e[0] = pci_msi_address();
+    e[1] = 0;
+    e[2] = vector;
+    e[3] &= ~PCI_MSIX_ENTRY_MASKED;
+
+    return RES_SUCCESS;
+}
+
+void pci_disable_msi(pci_device_t *dev)
+{
+    if (!dev)
+    {
+        return;
+    }
+
+    if (dev->msi_cap)
+    {
+        uint16_t ctrl = pci_read_word(dev->bus, dev->device, dev->function, dev->msi_cap + 2);
+        pci_write_word(dev->bus, dev->device, dev->function, dev->msi_cap + 2, ctrl & ~PCI_MSI_CTRL_ENABLE);
+    }
+
+    if (dev->msix_cap)
+    {
+        uint16_t ctrl = pci_read_word(dev->bus, dev->device, dev->function, dev->msix_cap + 2);
+        pci_write_word(dev->bus, dev->device, dev->function, dev->msix_cap + 2, ctrl & ~PCI_MSIX_CTRL_ENABLE);
+        dev->msix_table = NULL;
+    }
+
+    uint16_t cmd = pci_read_word(dev->bus, dev->device, dev->function, 0x04);
+    pci_write_word(dev->bus, dev->device, dev->function, 0x04, cmd & ~PCI_COMMAND_INTX_DISABLE);
+}
@@ -4,6 +4,7 @@
 #include <kernel/kmm.h>
 #include <kernel/vmm.h>
 #include <kernel/kernel.h>
+#include <kernel/cpu.h>
 #include <kernel/dev/virtio.h>
 
 extern page_table_t *kernel_pml4;
@@ -23,71 +24,143 @@ static void *virtio_map_bar(pci_device_t *dev, uint8_t bar, uint32_t offset)
     return (void *)phys_addr;
 }
 
-static uint8_t pci_read_byte(uint8_t bus, uint8_t device, uint8_t function, uint8_t offset)
+static void virtio_populate_device(virtio_device_t *device, pci_device_t *pci_dev)
 {
-    uint32_t data = pci_read(bus, device, function, offset & ~3);
-    return (data >> ((offset & 3) * 8)) & 0xFF;
+    for (uint8_t cap_ptr = pci_find_capability(pci_dev, PCI_CAP_ID_VNDR, 0); cap_ptr != 0; cap_ptr = pci_find_capability(pci_dev, PCI_CAP_ID_VNDR, cap_ptr))
+    {
+        virtio_pci_cap_t cap;
+        pci_read_bytes(pci_dev->bus, pci_dev->device, pci_dev->function, cap_ptr, &cap, sizeof(virtio_pci_cap_t));
+
+        switch (cap.cfg_type)
+        {
+        case VIRTIO_PCI_CAP_COMMON_CFG:
+            device->common = virtio_map_bar(pci_dev, cap.bar, cap.offset);
+            LOG_INFO("Found common config");
+            break;
+
+        case VIRTIO_PCI_CAP_NOTIFY_CFG:
+        {
+            virtio_pci_notify_cap_t notify_cap;
+            pci_read_bytes(pci_dev->bus, pci_dev->device, pci_dev->function, cap_ptr, &notify_cap, sizeof(virtio_pci_notify_cap_t));
+
+            device->notify = virtio_map_bar(pci_dev, notify_cap.cap.bar, notify_cap.cap.offset);
+            device->notify_off_multiplier = notify_cap.notify_off_multiplier;
+            LOG_INFO("Found notify config, multiplier=%u", device->notify_off_multiplier);
+            break;
+        }
+
+        case VIRTIO_PCI_CAP_ISR_CFG:
+            device->isr = virtio_map_bar(pci_dev, cap.bar, cap.offset);
+            LOG_INFO("Found ISR config");
+            break;
+
+        case VIRTIO_PCI_CAP_DEVICE_CFG:
+            device->device_cfg = virtio_map_bar(pci_dev, cap.bar, cap.offset);
+            LOG_INFO("Found device config");
+            break;
+
+        default:
+            LOG_INFO("Unknown virtio PCI capability type %u", cap.cfg_type);
+            break;
+        }
+    }
 }
 
-static void pci_read_bytes(uint8_t bus, uint8_t device, uint8_t function, uint8_t offset, void *buffer, uint8_t size)
+static virtio_device_t *legacy_devices[VIRTIO_MAX_LEGACY_DEVICES];
+static size_t num_legacy_devices = 0;
+
+// one handler for the legacy line, it runs every queue handler of each device that raised it
+static void virtio_legacy_irq(interrupt_frame_t *frame)
 {
-    uint8_t *dst = (uint8_t *)buffer;
-    for (uint8_t i = 0; i < size; ++i)
+    for (size_t i = 0; i < num_legacy_devices; i++)
     {
-        dst[i] = pci_read_byte(bus, device, function, offset + i);
+        virtio_device_t *device = legacy_devices[i];
+        if ((uint64_t)(0x20 + device->pci_dev->interrupt_line) != frame->int_no)
+        {
+            continue;
+        }
+
+        // reading the isr deasserts the line, so the queue handlers acknowledging again is harmless
+        uint8_t status = *(volatile uint8_t *)device->isr;
+        if (!(status & VIRTIO_ISR_QUEUE))
+        {
+            continue;
+        }
+
+        for (size_t j = 0; j < device->num_legacy_handlers; j++)
+        {
+            device->legacy_handlers[j](frame);
+        }
     }
 }
 
-static void virtio_populate_device(virtio_device_t *device, pci_device_t *pci_dev)
+static int virtio_add_legacy_handler(virtio_device_t *device, void (*handler)(interrupt_frame_t *))
 {
-    uint8_t cap_ptr = pci_read_byte(pci_dev->bus, pci_dev->device, pci_dev->function, PCI_CAP_PTR_OFFSET);
+    if (!device->isr || device->num_legacy_handlers >= VIRTIO_MAX_LEGACY_QUEUES)
+    {
+        return -RES_OVERFLOW;
+    }
 
-    while (cap_ptr != 0)
+    if (device->num_legacy_handlers == 0 && num_legacy_devices >= VIRTIO_MAX_LEGACY_DEVICES)
     {
-        virtio_pci_cap_t cap;
-        pci_read_bytes(pci_dev->bus, pci_dev->device, pci_dev->function, cap_ptr, &cap, sizeof(virtio_pci_cap_t));
+        return -RES_OVERFLOW;
+    }
+
+    uint64_t flags = cpu_irq_save();
+    if (device->num_legacy_handlers == 0)
+    {
+        legacy_devices[num_legacy_devices++] = device;
+    }
+    device->legacy_handlers[device->num_legacy_handlers++] = handler;
+    cpu_irq_restore(flags);
+
+    int vector = 0x20 + device->pci_dev->interrupt_line;
+    register_interrupt_handler(vector, &virtio_legacy_irq);
+    return vector;
+}
 
-        if (cap.cap_vndr == PCI_CAP_ID_VNDR) // vendor-specific
+static int virtio_setup_queue_vector(virtio_device_t *device, int queue_index, void (*handler)(interrupt_frame_t *))
+{
+    if (!handler)
+    {
+        device->common->queue_msix_vector = VIRTIO_MSI_NO_VECTOR;
+        return -1;
+    }
+
+    if (!device->msix)
+    {
+        int vector = virtio_add_legacy_handler(device, handler);
+        if (vector < 0)
         {
-            switch (cap.cfg_type)
-            {
-            case VIRTIO_PCI_CAP_COMMON_CFG:
-                device->common = virtio_map_bar(pci_dev, cap.bar, cap.offset);
-                LOG_INFO("Found common config");
-                break;
-
-            case VIRTIO_PCI_CAP_NOTIFY_CFG:
-            {
-                virtio_pci_notify_cap_t notify_cap;
-                pci_read_bytes(pci_dev->bus, pci_dev->device, pci_dev->function, cap_ptr, &notify_cap, sizeof(virtio_pci_notify_cap_t));
-
-                device->notify = virtio_map_bar(pci_dev, notify_cap.cap.bar, notify_cap.cap.offset);
-                device->notify_off_multiplier = notify_cap.notify_off_multiplier;
-                LOG_INFO("Found notify config, multiplier=%u", device->notify_off_multiplier);
-                break;
-            }
-
-            case VIRTIO_PCI_CAP_ISR_CFG:
-                device->isr = virtio_map_bar(pci_dev, cap.bar, cap.offset);
-                LOG_INFO("Found ISR config");
-                break;
-
-            case VIRTIO_PCI_CAP_DEVICE_CFG:
-                device->device_cfg = virtio_map_bar(pci_dev, cap.bar, cap.offset);
-                LOG_INFO("Found device config");
-                break;
-
-            default:
-                LOG_INFO("Unknown virtio PCI capability type %u", cap.cfg_type);
-                break;
-            }
+            LOG_WARNING("No room for another legacy handler for queue %d", queue_index);
+            return -1;
         }
+        return vector;
+    }
 
-        cap_ptr = cap.cap_next;
+    // msi-x entry 0 is reserved for config changes
+    uint16_t entry = queue_index + 1;
+    int vector = pci_alloc_vector(handler);
+    if (vector < 0 || pci_set_msix_vector(device->pci_dev, entry, vector) < 0)
+    {
+        LOG_WARNING("Failed to assign msi-x vector to queue %d", queue_index);
+        pci_free_vector(vector);
+        device->common->queue_msix_vector = VIRTIO_MSI_NO_VECTOR;
+        return -1;
     }
+
+    device->common->queue_msix_vector = entry;
+    if (device->common->queue_msix_vector != entry)
+    {
+        LOG_WARNING("Device rejected msi-x entry %u for queue %d", entry, queue_index);
+        pci_free_vector(vector);
+        return -1;
+    }
+
+    return vector;
 }
 
-virtqueue_t *virtio_setup_queue(virtio_device_t *device, int queue_index)
+virtqueue_t *virtio_setup_queue(virtio_device_t *device, int queue_index, void (*handler)(interrupt_frame_t *))
 {
     device->common->queue_select = queue_index;
 
@@ -139,6 +212,7 @@ virtqueue_t *virtio_setup_queue(virtio_device_t *device, int queue_index)
     vq->queue_index = queue_index;
     vq->queue_size = queue_size;
     vq->common = device->common;
+    vq->vector = virtio_setup_queue_vector(device, queue_index, handler);
 
     device->common->queue_enable = 1;
 
@@ -158,12 +232,19 @@ virtio_device_t *virtio_init(pci_device_t *pci_dev, uint32_t (*feature_negotiate
 
     // obtain registers and map them inside virtio_populate_device
     virtio_populate_device(device, pci_dev);
+    device->pci_dev = pci_dev;
 
     if (!device->common || !device->notify)
     {
         PANIC("Couldn't initialize virtio device: missing common or notify config");
     }
 
+    device->msix = pci_enable_msix(pci_dev) == RES_SUCCESS;
+    if (!device->msix)
+    {
+        LOG_WARNING("virtio device has no msi-x, falling back to legacy interrupts");
+    }
+
     // reset device
     device->common->device_status = 0;
 
@@ -185,6 +266,8 @@ virtio_device_t *virtio_init(pci_device_t *pci_dev, uint32_t (*feature_negotiate
     device->common->driver_feature_select = 0;
     device->common->driver_feature = features;
 
+    device->common->config_msix_vector = VIRTIO_MSI_NO_VECTOR;
+
     device->common->device_status |= VIRTIO_STATUS_FEATURES_OK;
     if (!(device->common->device_status & VIRTIO_STATUS_FEATURES_OK))
     {
@@ -194,6 +277,15 @@ virtio_device_t *virtio_init(pci_device_t *pci_dev, uint32_t (*feature_negotiate
     return device;
 }
 
+void virtio_ack_interrupt(virtio_device_t *dev)
+{
+    // reading the isr status deasserts the shared line, msi-x vectors need no acknowledgement
+    if (dev && !dev->msix && dev->isr)
+    {
+        (void)*(volatile uint8_t *)dev->isr;
+    }
+}
+
 KRES virtio_start(virtio_device_t *dev)
 {
     dev->common->device_status |= VIRTIO_STATUS_DRIVER_OK;
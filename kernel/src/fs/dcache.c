@@ -0,0 +1,247 @@
+#include <kernel/fs/dcache.h>
+#include <kernel/kmm.h>
+#include <kernel/cpu.h>
+#include <kernel/string.h>
+
+static dentry_t *buckets[DCACHE_BUCKETS];
+static dentry_t *lru_head = NULL; // most recently used
+static dentry_t *lru_tail = NULL;
+static size_t num_entries = 0;
+
+static uint32_t dcache_hash(const void *fs, uint64_t parent, const char *name)
+{
+    // fnv-1a over the name, seeded with the directory
+    uint32_t h = 2166136261u ^ (uint32_t)((uintptr_t)fs >> 4) ^ (uint32_t)parent ^ (uint32_t)(parent >> 32);
+    while (*name)
+    {
+        h ^= (uint8_t)*name++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void lru_unlink(dentry_t *dentry)
+{
+    if (dentry->lru_prev)
+    {
+        dentry->lru_prev->lru_next = dentry->lru_next;
+    }
+    else
+    {
+        lru_head = dentry->lru_next;
+    }
+
+    if (dentry->lru_next)
+    {
+        dentry->lru_next->lru_prev = dentry->lru_prev;
+    }
+    else
+    {
+        lru_tail = dentry->lru_prev;
+    }
+
+    dentry->lru_prev = NULL;
+    dentry->lru_next = NULL;
+}
+
+static void lru_push(dentry_t *dentry)
+{
+    dentry->lru_prev = NULL;
+    dentry->lru_next = lru_head;
+    if (lru_head)
+    {
+        lru_head->lru_prev = dentry;
+    }
+    lru_head = dentry;
+
+    if (!lru_tail)
+    {
+        lru_tail = dentry;
+    }
+}
+
+static void hash_unlink(dentry_t *dentry)
+{
+    dentry_t **link = &buckets[dentry->hash % DCACHE_BUCKETS];
+    while (*link && *link != dentry)
+    {
+        link = &(*link)->hash_next;
+    }
+
+    if (*link)
+    {
+        *link = dentry->hash_next;
+    }
+    dentry->hash_next = NULL;
+}
+
+static dentry_t *find(const void *fs, uint64_t parent, const char *name, uint32_t hash)
+{
+    for (dentry_t *dentry = buckets[hash % DCACHE_BUCKETS]; dentry; dentry = dentry->hash_next)
+    {
+        if (dentry->hash == hash && dentry->fs == fs && dentry->parent == parent && strcmp(dentry->name, name) == 0)
+        {
+            return dentry;
+        }
+    }
+
+    return NULL;
+}
+
+int dcache_lookup(const void *fs, uint64_t parent, const char *name, void *data, size_t size)
+{
+    if (strlen(name) >= DCACHE_NAME_MAX || size > DCACHE_DATA_SIZE)
+    {
+        return DCACHE_MISS;
+    }
+
+    uint32_t hash = dcache_hash(fs, parent, name);
+
+    uint64_t flags = cpu_irq_save();
+
+    dentry_t *dentry = find(fs, parent, name, hash);
+    if (!dentry)
+    {
+        cpu_irq_restore(flags);
+        return DCACHE_MISS;
+    }
+
+    lru_unlink(dentry);
+    lru_push(dentry);
+
+    if (dentry->negative)
+    {
+        cpu_irq_restore(flags);
+        return DCACHE_NEGATIVE;
+    }
+
+    if (data)
+    {
+        memcpy(data, dentry->data, size);
+    }
+
+    cpu_irq_restore(flags);
+    return DCACHE_HIT;
+}
+
+void dcache_insert(const void *fs, uint64_t parent, const char *name, const void *data, size_t size)
+{
+    if (strlen(name) >= DCACHE_NAME_MAX || size > DCACHE_DATA_SIZE)
+    {
+        return;
+    }
+
+    uint32_t hash = dcache_hash(fs, parent, name);
+
+    // allocated up front so kmalloc does not run with interrupts off
+    dentry_t *fresh = NULL;
+    if (num_entries < DCACHE_MAX_ENTRIES)
+    {
+        fresh = kmalloc(sizeof(dentry_t));
+    }
+
+    uint64_t flags = cpu_irq_save();
+
+    dentry_t *dentry = find(fs, parent, name, hash);
+    bool linked = dentry != NULL;
+    if (dentry)
+    {
+        lru_unlink(dentry);
+    }
+    else if (fresh && num_entries < DCACHE_MAX_ENTRIES)
+    {
+        dentry = fresh;
+        fresh = NULL;
+        num_entries++;
+    }
+    else if (lru_tail)
+    {
+        dentry = lru_tail;
+        lru_unlink(dentry);
+        hash_unlink(dentry);
+    }
+    else
+    {
+        cpu_irq_restore(flags);
+        kfree(fresh);
+        return;
+    }
+
+    if (!linked)
+    {
+        dentry->fs = fs;
+        dentry->parent = parent;
+        dentry->hash = hash;
+        strcpy(dentry->name, name);
+
+        dentry->hash_next = buckets[hash % DCACHE_BUCKETS];
+        buckets[hash % DCACHE_BUCKETS] = dentry;
+    }
+
+    dentry->negative = data == NULL;
+    memset(dentry->data, 0, DCACHE_DATA_SIZE);
+    if (data)
+    {
+        memcpy(dentry->data, data, size);
+    }
+
+    lru_push(dentry);
+
+    cpu_irq_restore(flags);
+
+    kfree(fresh);
+}
+
+static void dcache_drop(dentry_t *dentry)
+{
+    lru_unlink(dentry);
+    hash_unlink(dentry);
+    num_entries--;
+}
+
+void dcache_remove(const void *fs, uint64_t parent, const char *name)
+{
+    if (strlen(name) >= DCACHE_NAME_MAX)
+    {
+        return;
+    }
+
+    uint32_t hash = dcache_hash(fs, parent, name);
+
+    uint64_t flags = cpu_irq_save();
+    dentry_t *dentry = find(fs, parent, name, hash);
+    if (dentry)
+    {
+        dcache_drop(dentry);
+    }
+    cpu_irq_restore(flags);
+
+    kfree(dentry);
+}
+
+void dcache_invalidate(const void *fs)
+{
+    dentry_t *dropped = NULL;
+
+    uint64_t flags = cpu_irq_save();
+    dentry_t *dentry = lru_head;
+    while (dentry)
+    {
+        dentry_t *next = dentry->lru_next;
+        if (dentry->fs == fs)
+        {
+            dcache_drop(dentry);
+            dentry->hash_next = dropped; // reused to collect them for freeing
+            dropped = dentry;
+        }
+        dentry = next;
+    }
+    cpu_irq_restore(flags);
+
+    while (dropped)
+    {
+        dentry_t *next = dropped->hash_next;
+        kfree(dropped);
+        dropped = next;
+    }
+}
@@ -0,0 +1,310 @@
+#include <kernel/fs/pcache.h>
+#include <kernel/pmm.h>
+#include <kernel/kmm.h>
+#include <kernel/cpu.h>
+#include <kernel/string.h>
+
+static cached_page_t *buckets[PCACHE_BUCKETS];
+static cached_page_t *lru_head = NULL; // most recently used
+static cached_page_t *lru_tail = NULL;
+static cached_page_t *spare = NULL; // headers without data, kept so reclaiming never calls into the heap
+static pcache_stats_t stats;
+static uint64_t generation = 0; // bumped by every invalidation
+
+static size_t pcache_hash(const void *mount, uint64_t ino, uint64_t index)
+{
+    uint64_t h = ((uintptr_t)mount >> 4) * 0x9E3779B97F4A7C15ull;
+    h ^= ino * 0xC2B2AE3D27D4EB4Full;
+    h ^= index * 0x165667B19E3779F9ull;
+    return (size_t)((h ^ (h >> 29)) % PCACHE_BUCKETS);
+}
+
+static void lru_unlink(cached_page_t *page)
+{
+    if (page->lru_prev)
+    {
+        page->lru_prev->lru_next = page->lru_next;
+    }
+    else
+    {
+        lru_head = page->lru_next;
+    }
+
+    if (page->lru_next)
+    {
+        page->lru_next->lru_prev = page->lru_prev;
+    }
+    else
+    {
+        lru_tail = page->lru_prev;
+    }
+
+    page->lru_prev = NULL;
+    page->lru_next = NULL;
+}
+
+static void lru_push(cached_page_t *page)
+{
+    page->lru_prev = NULL;
+    page->lru_next = lru_head;
+    if (lru_head)
+    {
+        lru_head->lru_prev = page;
+    }
+    lru_head = page;
+
+    if (!lru_tail)
+    {
+        lru_tail = page;
+    }
+}
+
+static cached_page_t *find(const void *mount, uint64_t ino, uint64_t index)
+{
+    for (cached_page_t *page = buckets[pcache_hash(mount, ino, index)]; page; page = page->hash_next)
+    {
+        if (page->mount == mount && page->ino == ino && page->index == index)
+        {
+            return page;
+        }
+    }
+
+    return NULL;
+}
+
+// takes the page out of the cache, the caller frees it once interrupts are back on
+static void unlink_page(cached_page_t *page)
+{
+    cached_page_t **link = &buckets[pcache_hash(page->mount, page->ino, page->index)];
+    while (*link && *link != page)
+    {
+        link = &(*link)->hash_next;
+    }
+    if (*link)
+    {
+        *link = page->hash_next;
+    }
+    page->hash_next = NULL;
+
+    lru_unlink(page);
+    stats.pages--;
+}
+
+// gives the data back to the pmm, reclaiming runs from inside pmm_alloc which may be growing the heap
+static void free_pages(cached_page_t *pages)
+{
+    while (pages)
+    {
+        cached_page_t *next = pages->hash_next;
+        pmm_free((uint64_t *)pages->data);
+        pages->data = NULL;
+
+        uint64_t flags = cpu_irq_save();
+        pages->hash_next = spare;
+        spare = pages;
+        cpu_irq_restore(flags);
+
+        pages = next;
+    }
+}
+
+void pcache_init(void)
+{
+    memset(buckets, 0, sizeof(buckets));
+    memset(&stats, 0, sizeof(stats));
+    pmm_set_reclaim(&pcache_reclaim);
+}
+
+bool pcache_read(const void *mount, uint64_t ino, uint64_t index, size_t offset, void *buf, size_t size)
+{
+    uint64_t flags = cpu_irq_save();
+
+    cached_page_t *page = find(mount, ino, index);
+    if (!page || offset + size > page->size)
+    {
+        stats.misses++;
+        cpu_irq_restore(flags);
+        return false;
+    }
+
+    lru_unlink(page);
+    lru_push(page);
+    memcpy(buf, page->data + offset, size);
+    stats.hits++;
+    if (page->readahead)
+    {
+        page->readahead = false; // counted once, on the first read
+        stats.readahead_hits++;
+    }
+
+    cpu_irq_restore(flags);
+    return true;
+}
+
+bool pcache_contains(const void *mount, uint64_t ino, uint64_t index)
+{
+    uint64_t flags = cpu_irq_save();
+    bool found = find(mount, ino, index) != NULL;
+    cpu_irq_restore(flags);
+
+    return found;
+}
+
+uint64_t pcache_generation(void)
+{
+    uint64_t flags = cpu_irq_save();
+    uint64_t result = generation;
+    cpu_irq_restore(flags);
+
+    return result;
+}
+
+static void insert(const void *mount, uint64_t ino, uint64_t index, const void *data, size_t size, bool readahead, uint64_t since)
+{
+    if (size > PAGE_SIZE)
+    {
+        return;
+    }
+
+    // a full cache recycles its oldest page instead of growing
+    cached_page_t *page = NULL;
+    uint64_t flags = cpu_irq_save();
+    if (stats.pages >= PCACHE_MAX_PAGES && lru_tail)
+    {
+        page = lru_tail;
+        unlink_page(page);
+        stats.evictions++;
+    }
+    else if (spare)
+    {
+        page = spare;
+        spare = page->hash_next;
+    }
+    cpu_irq_restore(flags);
+
+    if (!page)
+    {
+        page = kmalloc(sizeof(cached_page_t));
+        if (!page)
+        {
+            return;
+        }
+        page->data = NULL;
+    }
+
+    if (!page->data)
+    {
+        page->data = pmm_alloc();
+        if (!page->data)
+        {
+            flags = cpu_irq_save();
+            page->hash_next = spare;
+            spare = page;
+            cpu_irq_restore(flags);
+            return;
+        }
+    }
+
+    page->mount = mount;
+    page->ino = ino;
+    page->index = index;
+    page->size = size;
+    page->readahead = readahead;
+    memcpy(page->data, data, size);
+
+    flags = cpu_irq_save();
+
+    // the data was read before something invalidated it
+    if (readahead && generation != since)
+    {
+        cpu_irq_restore(flags);
+        page->hash_next = NULL;
+        free_pages(page);
+        return;
+    }
+
+    cached_page_t *old = find(mount, ino, index);
+    if (old)
+    {
+        unlink_page(old);
+    }
+
+    size_t bucket = pcache_hash(mount, ino, index);
+    page->hash_next = buckets[bucket];
+    buckets[bucket] = page;
+    lru_push(page);
+    stats.pages++;
+    if (readahead)
+    {
+        stats.readahead++;
+    }
+
+    cpu_irq_restore(flags);
+
+    if (old)
+    {
+        old->hash_next = NULL;
+        free_pages(old);
+    }
+}
+
+void pcache_insert(const void *mount, uint64_t ino, uint64_t index, const void *data, size_t size)
+{
+    insert(mount, ino, index, data, size, false, 0);
+}
+
+void pcache_insert_readahead(const void *mount, uint64_t ino, uint64_t index, const void *data, size_t size, uint64_t since)
+{
+    insert(mount, ino, index, data, size, true, since);
+}
+
+void pcache_invalidate(const void *mount, uint64_t ino, uint64_t first_index)
+{
+    cached_page_t *dropped = NULL;
+
+    uint64_t flags = cpu_irq_save();
+    generation++;
+    cached_page_t *page = lru_head;
+    while (page)
+    {
+        cached_page_t *next = page->lru_next;
+        if (page->mount == mount && page->ino == ino && page->index >= first_index)
+        {
+            unlink_page(page);
+            page->hash_next = dropped; // reused to collect them for freeing
+            dropped = page;
+        }
+        page = next;
+    }
+    cpu_irq_restore(flags);
+
+    free_pages(dropped);
+}
+
+size_t pcache_reclaim(size_t num_pages)
+{
+    cached_page_t *dropped = NULL;
+    size_t count = 0;
+
+    uint64_t flags = cpu_irq_save();
+    while (count < num_pages && lru_tail)
+    {
+        cached_page_t *page = lru_tail;
+        unlink_page(page);
+        page->hash_next = dropped;
+        dropped = page;
+        stats.evictions++;
+        count++;
+    }
+    cpu_irq_restore(flags);
+
+    free_pages(dropped);
+    return count;
+}
+
+void pcache_get_stats(pcache_stats_t *out)
+{
+    uint64_t flags = cpu_irq_save();
+    memcpy(out, &stats, sizeof(pcache_stats_t));
+    cpu_irq_restore(flags);
+}
@@ -1,6 +1,10 @@
 #include <kernel/fs/vfs.h>
 #include <kernel/kmm.h>
 #include <kernel/string.h>
+#include <kernel/cpu.h>
+#include <kernel/pmm.h>
+#include <kernel/fs/pcache.h>
+#include <kernel/proc/scheduler.h>
 
 static bool is_path_root(const char *path)
 {
@@ -344,6 +348,63 @@ typedef struct
     char local_path[MAX_PATH]; // path within that mount
 } vfs_mount_resolve_t;
 
+// collapses repeated slashes and resolves . and .. without touching any filesystem, /.. stays /
+static bool vfs_normalize_path(const char *path, char *out)
+{
+    size_t out_len = 0;
+
+    const char *p = path;
+    while (*p)
+    {
+        while (*p == '/')
+        {
+            p++;
+        }
+
+        const char *start = p;
+        while (*p && *p != '/')
+        {
+            p++;
+        }
+        size_t len = (size_t)(p - start);
+
+        if (len == 0 || (len == 1 && start[0] == '.'))
+        {
+            continue;
+        }
+
+        if (len == 2 && start[0] == '.' && start[1] == '.')
+        {
+            while (out_len > 0 && out[out_len - 1] != '/')
+            {
+                out_len--;
+            }
+            if (out_len > 0)
+            {
+                out_len--; // the slash in front of the dropped component
+            }
+            continue;
+        }
+
+        if (out_len + 1 + len >= MAX_PATH)
+        {
+            return false;
+        }
+
+        out[out_len++] = '/';
+        memcpy(out + out_len, start, len);
+        out_len += len;
+    }
+
+    if (out_len == 0)
+    {
+        out[out_len++] = '/';
+    }
+    out[out_len] = '\0';
+
+    return true;
+}
+
 vfs_mount_resolve_t vfs_resolve_real_mount_and_local_path(const char *path)
 {
     vfs_mount_resolve_t result = {.mount = NULL};
@@ -352,78 +413,52 @@ vfs_mount_resolve_t vfs_resolve_real_mount_and_local_path(const char *path)
         return result;
     }
 
-    mount_node_t *current = root;
-    mount_node_t *last_real = root;
-
-    size_t consumed_length = 0;
-    size_t real_consumed_length = 0;
-
-    char *path_copy = strdup(path);
-    if (!path_copy)
+    char normalized[MAX_PATH];
+    if (!vfs_normalize_path(path, normalized))
     {
         return result;
     }
 
-    char *tok = strtok(path_copy, "/");
-    while (tok)
+    mount_node_t *current = root;
+    mount_node_t *last_real = root;
+    size_t real_consumed_length = 0;
+
+    // every component of the normalized path is a slash followed by the name
+    const char *p = normalized;
+    while (*p == '/' && p[1] != '\0')
     {
-        if (strcmp(tok, ".") == 0)
-        {
-            tok = strtok(NULL, "/");
-            consumed_length += 3;
-            continue;
-        }
-        else if (strcmp(tok, "..") == 0)
-        {
-            tok = strtok(NULL, "/");
-            consumed_length += 4;
-            current = current->parent;
-            if (!current)
-            {
-                result.mount = NULL;
-                return result;
-            }
-            continue;
-        }
+        const char *name = p + 1;
+        const char *end = strchr(name, '/');
+        size_t len = end ? (size_t)(end - name) : strlen(name);
 
-        bool found = false;
+        mount_node_t *child = NULL;
         for (size_t i = 0; i < cvector_size(current->children); i++)
         {
-            if (strcmp(current->children[i]->path, tok) == 0)
+            if (strlen(current->children[i]->path) == len && strncmp(current->children[i]->path, name, len) == 0)
             {
-                // TODO: this is a bug as a path can cosume multiple slashes
-                consumed_length += strlen(tok) + 1; // +1 for '/'
-                current = current->children[i];
-                if (current->vbdev || current->fs)
-                {
-                    last_real = current;
-                    real_consumed_length = consumed_length;
-                }
-                found = true;
+                child = current->children[i];
                 break;
             }
         }
 
-        if (!found)
+        if (!child)
         {
             break;
         }
 
-        tok = strtok(NULL, "/");
+        current = child;
+        p = name + len;
+        if (current->vbdev || current->fs)
+        {
+            last_real = current;
+            real_consumed_length = (size_t)(p - normalized);
+        }
     }
 
-    kfree(path_copy);
-
     result.mount = last_real;
 
-    if (strlen(path) > real_consumed_length)
-    {
-        strncpy(result.local_path, path + real_consumed_length, MAX_PATH - 1);
-    }
-    else
-    {
-        strcpy(result.local_path, "");
-    }
+    // "" when the path names the mount itself
+    strcpy(result.local_path, normalized + real_consumed_length);
 
     return result;
 }
@@ -475,6 +510,8 @@ char *vfs_get_mount_path(mount_node_t *mount)
     return full_path;
 }
 
+static void vfs_readahead_work(work_t *work);
+
 stream_t *vfs_open(const char *path, uint8_t action)
 {
     if (!path)
@@ -494,9 +531,32 @@ stream_t *vfs_open(const char *path, uint8_t action)
         return NULL;
     }
 
+    if (stream->type == STREAM_TYPE_FILE)
+    {
+        stream->node->refcount = 1;
+
+        stream->node->ra_next = 0;
+        stream->node->ra_window = 0;
+        stream->node->ra_index = 0;
+        stream->node->ra_end = 0;
+        work_init(&stream->node->ra_work, &vfs_readahead_work, stream->node);
+
+        if (stream->node->ino && (action == OPEN_ACTION_CLEAR || action == OPEN_ACTION_CREATE))
+        {
+            pcache_invalidate(stream->mount, stream->node->ino, 0);
+        }
+    }
+
     return stream;
 }
 
+void vfs_hold(file_node_t *node)
+{
+    uint64_t flags = cpu_irq_save();
+    node->refcount++;
+    cpu_irq_restore(flags);
+}
+
 int vfs_close(stream_t *stream)
 {
     if (!stream || !stream->mount)
@@ -504,27 +564,259 @@ int vfs_close(stream_t *stream)
         return -RES_INVARG;
     }
 
+    if (stream->type == STREAM_TYPE_FILE)
+    {
+        uint64_t flags = cpu_irq_save();
+        size_t refcount = --stream->node->refcount;
+        cpu_irq_restore(flags);
+
+        if (refcount > 0)
+        {
+            return RES_SUCCESS;
+        }
+    }
+
     return stream->mount->fs->fs_close(stream);
 }
 
+// reads a whole page through the filesystem into the page cache and copies the requested part out of it
+static int vfs_fill_page(stream_t *stream, uint64_t index, size_t offset, uint8_t *buf, size_t size)
+{
+    file_node_t *node = stream->node;
+
+    size_t page_start = index * PAGE_SIZE;
+    size_t page_size = node->filesize - page_start;
+    if (page_size > PAGE_SIZE)
+    {
+        page_size = PAGE_SIZE;
+    }
+
+    uint8_t *page = kmalloc(PAGE_SIZE);
+    if (!page)
+    {
+        return -RES_NOMEM;
+    }
+
+    int res = stream->mount->fs->fs_read(stream, page_start, page_size, page);
+
+    if (res < 0)
+    {
+        kfree(page);
+        return res;
+    }
+
+    pcache_insert(stream->mount, node->ino, index, page, page_size);
+    memcpy(buf, page + offset, size);
+
+    kfree(page);
+    return RES_SUCCESS;
+}
+
+// runs on the workqueue and reads the pages from ra_index up to ra_end that are not cached yet
+static void vfs_readahead_work(work_t *work)
+{
+    file_node_t *node = work->data;
+
+    stream_t ra_stream;
+    memset(&ra_stream, 0, sizeof(stream_t));
+    ra_stream.type = STREAM_TYPE_FILE;
+    ra_stream.node = node;
+    ra_stream.mount = node->mount;
+
+    uint8_t *page = kmalloc(PAGE_SIZE);
+    while (page)
+    {
+        // the reader moves ra_end, or pulls it back to stop us, between pages
+        uint64_t flags = cpu_irq_save();
+        uint64_t index = node->ra_index;
+        if (index >= node->ra_end)
+        {
+            cpu_irq_restore(flags);
+            break;
+        }
+        node->ra_index++;
+        size_t filesize = node->filesize;
+        cpu_irq_restore(flags);
+
+        size_t page_start = index * PAGE_SIZE;
+        if (page_start >= filesize)
+        {
+            break;
+        }
+
+        if (pcache_contains(node->mount, node->ino, index))
+        {
+            continue;
+        }
+
+        size_t page_size = filesize - page_start;
+        if (page_size > PAGE_SIZE)
+        {
+            page_size = PAGE_SIZE;
+        }
+
+        uint64_t since = pcache_generation();
+        if (node->mount->fs->fs_read(&ra_stream, page_start, page_size, page) < 0)
+        {
+            break;
+        }
+
+        pcache_insert_readahead(node->mount, node->ino, index, page, page_size, since);
+
+        // lets the reader run on with what is cached so far
+        cond_resched();
+    }
+    kfree(page);
+
+    // the reference taken when the work was queued, the last one closes the file
+    vfs_close(&ra_stream);
+}
+
+// called after every cached read, grows the window while reads follow on from each other and starts the work
+static void vfs_readahead(file_node_t *node, size_t offset, size_t size)
+{
+    uint64_t flags = cpu_irq_save();
+
+    if (offset != node->ra_next)
+    {
+        // random access, whatever is still queued stops at the next page and a new run starts from here
+        node->ra_next = offset + size;
+        node->ra_window = 0;
+        node->ra_index = (offset + size + PAGE_SIZE - 1) / PAGE_SIZE;
+        node->ra_end = node->ra_index;
+        cpu_irq_restore(flags);
+        return;
+    }
+
+    node->ra_next = offset + size;
+    node->ra_window = node->ra_window ? node->ra_window * 2 : READAHEAD_MIN_PAGES;
+    if (node->ra_window > READAHEAD_MAX_PAGES)
+    {
+        node->ra_window = READAHEAD_MAX_PAGES;
+    }
+
+    // the page the read ended in was cached by the read itself
+    uint64_t next = (offset + size + PAGE_SIZE - 1) / PAGE_SIZE;
+    uint64_t end = next + node->ra_window;
+    uint64_t last = (node->filesize + PAGE_SIZE - 1) / PAGE_SIZE;
+    if (end > last)
+    {
+        end = last;
+    }
+
+    if (node->ra_index < next)
+    {
+        node->ra_index = next;
+    }
+    if (node->ra_end < end)
+    {
+        node->ra_end = end;
+    }
+
+    if (node->ra_index < node->ra_end && !node->ra_work.pending)
+    {
+        vfs_hold(node);
+        work_queue(&node->ra_work);
+    }
+
+    cpu_irq_restore(flags);
+}
+
+int vfs_pread(stream_t *stream, size_t offset, size_t size, uint8_t *buf)
+{
+    if (!stream || !stream->mount || stream->type != STREAM_TYPE_FILE)
+    {
+        return -RES_INVARG;
+    }
+
+    // only data within the file is cached, whatever the filesystem makes of reads past the end stays its business
+    file_node_t *node = stream->node;
+    if (!node->ino || offset + size > node->filesize)
+    {
+        return stream->mount->fs->fs_read(stream, offset, size, buf);
+    }
+
+    for (size_t done = 0; done < size;)
+    {
+        uint64_t index = (offset + done) / PAGE_SIZE;
+        size_t page_offset = (offset + done) % PAGE_SIZE;
+        size_t chunk = PAGE_SIZE - page_offset;
+        if (chunk > size - done)
+        {
+            chunk = size - done;
+        }
+
+        if (!pcache_read(stream->mount, node->ino, index, page_offset, buf + done, chunk))
+        {
+            int res = vfs_fill_page(stream, index, page_offset, buf + done, chunk);
+            if (res < 0)
+            {
+                return res;
+            }
+        }
+
+        done += chunk;
+    }
+
+    vfs_readahead(node, offset, size);
+    return RES_SUCCESS;
+}
+
 int vfs_read(stream_t *stream, size_t size, uint8_t *buf)
 {
-    if (!stream || !stream->mount)
+    if (!stream || stream->type != STREAM_TYPE_FILE)
     {
         return -RES_INVARG;
     }
 
-    return stream->mount->fs->fs_read(stream, size, buf);
+    size_t offset = stream->node->offset;
+    int res = vfs_pread(stream, offset, size, buf);
+    if (res < 0)
+    {
+        return res;
+    }
+
+    stream->node->offset = offset + size;
+    return RES_SUCCESS;
+}
+
+int vfs_pwrite(stream_t *stream, size_t offset, size_t size, const uint8_t *buf)
+{
+    if (!stream || !stream->mount || stream->type != STREAM_TYPE_FILE)
+    {
+        return -RES_INVARG;
+    }
+
+    file_node_t *node = stream->node;
+
+    // cached pages from wherever the write may land on are stale afterwards
+    size_t first = offset < node->filesize ? offset : node->filesize;
+
+    int res = stream->mount->fs->fs_write(stream, offset, size, buf);
+    if (node->ino)
+    {
+        pcache_invalidate(stream->mount, node->ino, first / PAGE_SIZE);
+    }
+
+    return res;
 }
 
 int vfs_write(stream_t *stream, size_t size, const uint8_t *buf)
 {
-    if (!stream || !stream->mount)
+    if (!stream || stream->type != STREAM_TYPE_FILE)
     {
         return -RES_INVARG;
     }
 
-    return stream->mount->fs->fs_write(stream, size, buf);
+    size_t offset = stream->node->offset;
+    int res = vfs_pwrite(stream, offset, size, buf);
+    if (res < 0)
+    {
+        return res;
+    }
+
+    stream->node->offset = offset + size;
+    return RES_SUCCESS;
 }
 
 int vfs_readdir(stream_t *stream, int index, dirent_t *dirent)
@@ -558,6 +850,11 @@ int vfs_delete(stream_t *stream)
         return -RES_INVARG;
     }
 
+    if (stream->type == STREAM_TYPE_FILE && stream->node->ino)
+    {
+        pcache_invalidate(stream->mount, stream->node->ino, 0);
+    }
+
     return stream->mount->fs->fs_delete(stream);
 }
 
@@ -5,24 +5,51 @@
 static device_t *kprintf_cdev;
 static struct ansi_state ansi_state;
 
-void _putchar(char c)
+#define KPRINTF_BATCH_SIZE 128
+
+// characters of the same style are collected and handed to the device in one call
+typedef struct
 {
-    struct color_char ch = ansi_process(&ansi_state, c);
-    if (!ch.ascii)
+    char data[KPRINTF_BATCH_SIZE];
+    size_t size;
+    uint8_t style;
+} kprintf_batch_t;
+
+static void kprintf_flush(kprintf_batch_t *batch)
+{
+    if (batch->size == 0)
     {
         return;
     }
 
-    uint8_t fore_color = ch.style & 0x07;
-    uint8_t fore_bright = (ch.style & 0x08) >> 3;
+    uint8_t fore_color = batch->style & 0x07;
+    uint8_t fore_bright = (batch->style & 0x08) >> 3;
 
-    uint8_t back_color = (ch.style & 0x70) >> 4;
-    uint8_t back_bright = (ch.style & 0x80) >> 7;
+    uint8_t back_color = (batch->style & 0x70) >> 4;
+    uint8_t back_bright = (batch->style & 0x80) >> 7;
 
     uint8_t fg = fore_color | (fore_bright << 3);
     uint8_t bg = back_color | (back_bright << 3);
 
-    device_write(ch.ascii, (chardev_color_t)fg, (chardev_color_t)bg, kprintf_cdev);
+    device_write_buffer(batch->data, batch->size, (chardev_color_t)fg, (chardev_color_t)bg, kprintf_cdev);
+    batch->size = 0;
+}
+
+static void kprintf_put(kprintf_batch_t *batch, char c)
+{
+    struct color_char ch = ansi_process(&ansi_state, c);
+    if (!ch.ascii)
+    {
+        return;
+    }
+
+    if (batch->size == KPRINTF_BATCH_SIZE || (batch->size > 0 && ch.style != batch->style))
+    {
+        kprintf_flush(batch);
+    }
+
+    batch->style = ch.style;
+    batch->data[batch->size++] = (char)ch.ascii;
 }
 
 // from https://github.com/mpaland/printf
@@ -54,12 +81,12 @@ void _putchar(char c)
 #endif
 
 // support for the floating point type (%f)
-// default: activated
-#define PRINTF_SUPPORT_FLOAT
+// default: deactivated, the kernel is built without sse registers
+// #define PRINTF_SUPPORT_FLOAT
 
 // support for exponential floating point notation (%e/%g)
-// default: activated
-#define PRINTF_SUPPORT_EXPONENTIAL
+// default: deactivated
+// #define PRINTF_SUPPORT_EXPONENTIAL
 
 // define the default floating point precision
 // default: 6 digits
@@ -126,15 +153,14 @@ static inline void _out_null(char character, void *buffer, size_t idx, size_t ma
     (void)maxlen;
 }
 
-// internal _putchar wrapper
+// internal output to the kprintf device, buffer is a kprintf_batch_t
 static inline void _out_char(char character, void *buffer, size_t idx, size_t maxlen)
 {
-    (void)buffer;
     (void)idx;
     (void)maxlen;
     if (character)
     {
-        _putchar(character);
+        kprintf_put((kprintf_batch_t *)buffer, character);
     }
 }
 
@@ -1004,8 +1030,9 @@ int kprintf(const char *format, ...)
 {
     va_list va;
     va_start(va, format);
-    char buffer[1];
-    const int ret = _vsnprintf(_out_char, buffer, (size_t)-1, format, va);
+    kprintf_batch_t batch = {.size = 0};
+    const int ret = _vsnprintf(_out_char, (char *)&batch, (size_t)-1, format, va);
+    kprintf_flush(&batch);
     va_end(va);
     return ret;
 }
@@ -1030,8 +1057,10 @@ int snprintf(char *buffer, size_t count, const char *format, ...)
 
 int vkprintf(const char *format, va_list va)
 {
-    char buffer[1];
-    return _vsnprintf(_out_char, buffer, (size_t)-1, format, va);
+    kprintf_batch_t batch = {.size = 0};
+    const int ret = _vsnprintf(_out_char, (char *)&batch, (size_t)-1, format, va);
+    kprintf_flush(&batch);
+    return ret;
 }
 
 int vsnprintf(char *buffer, size_t count, const char *format, va_list va)
@@ -2,50 +2,43 @@
 #include <kernel/port.h>
 #include <kernel/kprintf.h>
 #include <kernel/dbg.h>
-#include <kernel/port.h>
+#include <kernel/string.h>
 
 #include <stddef.h>
 #include <stdarg.h>
 
 #define KLOG_MAX_LENGTH 512
 
-static KRES (*log_write_func)(char c, log_level_t level);
+static KRES (*log_write_func)(const char *str, size_t size, log_level_t level);
 
 static KRES klog_write_string(const char *str, log_level_t level)
 {
-    KRES res = RES_SUCCESS;
-
-    for (uint64_t i = 0; str[i] != 0; i++)
-    {
-        CHECK(log_write_func(str[i], level));
-    }
-
-exit:
-    return res;
+    return log_write_func(str, strlen(str), level);
 }
 
-KRES klog_write_e9_and_vga(char c, log_level_t level)
+KRES klog_write_e9_and_vga(const char *str, size_t size, log_level_t level)
 {
     KRES res = RES_SUCCESS;
 
-    CHECK(klog_write_e9(c, level));
-    CHECK(klog_write_vga(c, level));
+    CHECK(klog_write_e9(str, size, level));
+    CHECK(klog_write_vga(str, size, level));
 
 exit:
     return res;
 }
 
-KRES klog_write_e9(char c, log_level_t level)
+KRES klog_write_e9(const char *str, size_t size, log_level_t level)
 {
     (void)level;
-    port_byte_out(0xe9, c);
+    port_bytes_out(0xe9, (const uint8_t *)str, size);
     return RES_SUCCESS;
 }
 
-KRES klog_write_null(char c, log_level_t level)
+KRES klog_write_null(const char *str, size_t size, log_level_t level)
 {
     (void)level;
-    (void)c;
+    (void)str;
+    (void)size;
     return RES_SUCCESS;
 }
 
@@ -91,37 +84,25 @@ static void vga_backspace(void)
     col--;
 }
 
-KRES klog_write_vga(char c, log_level_t level)
+static void vga_put(char c, uint8_t color)
 {
-    KRES res = RES_SUCCESS;
-    uint8_t color = 0x00;
-
-    switch (level)
-    {
-        case LOG_LEVEL_DEBUG:   color = 0x07; break;
-        case LOG_LEVEL_INFO:    color = 0x0A; break;
-        case LOG_LEVEL_WARNING: color = 0x0E; break;
-        case LOG_LEVEL_ERROR:   color = 0x0C; break;
-        default:                res = -RES_INVARG; goto exit;
-    }
-
     if (c == '\n')
     {
         vga_newline(color);
-        return 0;
+        return;
     }
     if (c == '\b')
     {
         vga_backspace();
-        return 0;
+        return;
     }
     else if (c == '\t')
     {
         for (uint8_t i = 0; i < 4; i++)
         {
-            CHECK(klog_write_vga(' ', level));
+            vga_put(' ', color);
         }
-        return 0;
+        return;
     }
 
     if (col > NUM_COLS)
@@ -131,12 +112,30 @@ KRES klog_write_vga(char c, log_level_t level)
 
     vga_char_mem[col + row * NUM_COLS] = ((uint16_t)(color << 8)) | c;
     col++;
+}
 
-exit:
-    return res;
+KRES klog_write_vga(const char *str, size_t size, log_level_t level)
+{
+    uint8_t color = 0x00;
+
+    switch (level)
+    {
+        case LOG_LEVEL_DEBUG:   color = 0x07; break;
+        case LOG_LEVEL_INFO:    color = 0x0A; break;
+        case LOG_LEVEL_WARNING: color = 0x0E; break;
+        case LOG_LEVEL_ERROR:   color = 0x0C; break;
+        default:                return -RES_INVARG;
+    }
+
+    for (size_t i = 0; i < size; i++)
+    {
+        vga_put(str[i], color);
+    }
+
+    return RES_SUCCESS;
 }
 
-KRES klog_init(KRES (*write_func)(char c, log_level_t level))
+KRES klog_init(KRES (*write_func)(const char *str, size_t size, log_level_t level))
 {
     if (!write_func)
     {
@@ -171,27 +170,37 @@ KRES klog(log_level_t level, const char *fmt, ...)
     va_list args;
     va_start(args, fmt);
     
-    char str[KLOG_MAX_LENGTH];
-    vsnprintf(str, KLOG_MAX_LENGTH, fmt, args);
-
+    const char *prefix = "";
     switch (level)
     {
     case LOG_LEVEL_DEBUG:
-        CHECK(klog_write_string("DEBUG: ", level));
+        prefix = "DEBUG: ";
         break;
     case LOG_LEVEL_INFO:
-        CHECK(klog_write_string("INFO:  ", level));
+        prefix = "INFO:  ";
         break;
     case LOG_LEVEL_WARNING:
-        CHECK(klog_write_string("WARN:  ", level));
+        prefix = "WARN:  ";
         break;
     case LOG_LEVEL_ERROR:
-        CHECK(klog_write_string("ERROR: ", level));
+        prefix = "ERROR: ";
         break;
     }
 
-    CHECK(klog_write_string(str, level));
-    CHECK(klog_write_string("\n", level));
+    // prefix, message and newline are assembled first so the writer runs once per line
+    char str[KLOG_MAX_LENGTH];
+    size_t prefix_len = strlen(prefix);
+    memcpy(str, prefix, prefix_len);
+
+    int len = vsnprintf(str + prefix_len, KLOG_MAX_LENGTH - prefix_len - 1, fmt, args);
+    size_t size = prefix_len + (len < 0 ? 0 : (size_t)len);
+    if (size > KLOG_MAX_LENGTH - 2)
+    {
+        size = KLOG_MAX_LENGTH - 2; // truncated by vsnprintf
+    }
+    str[size++] = '\n';
+
+    CHECK(log_write_func(str, size, level));
 
 exit:
     va_end(args);
@@ -0,0 +1,397 @@
+#include <kernel/proc/dynamic.h>
+#include <kernel/cpu.h>
+#include <kernel/string.h>
+#include <kernel/log.h>
+
+#define DYNAMIC_MAX_NAME 64
+
+typedef struct
+{
+    uintptr_t strtab;
+    uintptr_t symtab;
+    uintptr_t hash;
+    uintptr_t rela;
+    size_t relasz;
+    uintptr_t jmprel;
+    size_t pltrelsz;
+} dynamic_info_t;
+
+typedef struct
+{
+    exec_image_t *obj;
+    dynamic_info_t info;
+} dynamic_scope_t;
+
+static uintptr_t next_library_base = DYNAMIC_LIBRARY_VADDR_BASE;
+
+uintptr_t dynamic_reserve(size_t size)
+{
+    size = (size + DYNAMIC_LIBRARY_ALIGN - 1) & ~(uintptr_t)(DYNAMIC_LIBRARY_ALIGN - 1);
+
+    uint64_t flags = cpu_irq_save();
+    uintptr_t base = next_library_base;
+    next_library_base += size;
+    cpu_irq_restore(flags);
+
+    return base;
+}
+
+size_t dynamic_collect(exec_image_t *root, exec_image_t **objs, size_t max)
+{
+    if (max == 0)
+    {
+        return 0;
+    }
+
+    size_t count = 0;
+    objs[count++] = root;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        for (size_t j = 0; j < objs[i]->num_deps; j++)
+        {
+            exec_image_t *dep = objs[i]->deps[j];
+
+            bool seen = false;
+            for (size_t k = 0; k < count; k++)
+            {
+                if (objs[k] == dep)
+                {
+                    seen = true;
+                    break;
+                }
+            }
+
+            if (!seen && count < max)
+            {
+                objs[count++] = dep;
+            }
+        }
+    }
+
+    return count;
+}
+
+static KRES read_string(exec_image_t *image, uintptr_t vaddr, char *buf, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        KRES res = image_read(image, vaddr + i, &buf[i], 1);
+        if (IS_ERROR(res))
+        {
+            return res;
+        }
+
+        if (buf[i] == '\0')
+        {
+            return RES_SUCCESS;
+        }
+    }
+
+    return -RES_OVERFLOW;
+}
+
+static KRES read_dynamic(exec_image_t *image, dynamic_info_t *info)
+{
+    memset(info, 0, sizeof(dynamic_info_t));
+
+    for (uintptr_t vaddr = image->dynamic;; vaddr += sizeof(Elf64_Dyn))
+    {
+        Elf64_Dyn dyn;
+        KRES res = image_read(image, vaddr, &dyn, sizeof(dyn));
+        if (IS_ERROR(res))
+        {
+            return res;
+        }
+
+        switch (dyn.d_tag)
+        {
+        case DT_NULL:
+            return RES_SUCCESS;
+        case DT_STRTAB:
+            info->strtab = dyn.d_un.d_ptr;
+            break;
+        case DT_SYMTAB:
+            info->symtab = dyn.d_un.d_ptr;
+            break;
+        case DT_HASH:
+            info->hash = dyn.d_un.d_ptr;
+            break;
+        case DT_RELA:
+            info->rela = dyn.d_un.d_ptr;
+            break;
+        case DT_RELASZ:
+            info->relasz = dyn.d_un.d_val;
+            break;
+        case DT_JMPREL:
+            info->jmprel = dyn.d_un.d_ptr;
+            break;
+        case DT_PLTRELSZ:
+            info->pltrelsz = dyn.d_un.d_val;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static KRES load_dependencies(exec_image_t *image, dynamic_info_t *info, unsigned int depth)
+{
+    for (uintptr_t vaddr = image->dynamic;; vaddr += sizeof(Elf64_Dyn))
+    {
+        Elf64_Dyn dyn;
+        KRES res = image_read(image, vaddr, &dyn, sizeof(dyn));
+        if (IS_ERROR(res))
+        {
+            return res;
+        }
+
+        if (dyn.d_tag == DT_NULL)
+        {
+            return RES_SUCCESS;
+        }
+
+        if (dyn.d_tag != DT_NEEDED)
+        {
+            continue;
+        }
+
+        char path[MAX_PATH] = DYNAMIC_LIBRARY_PATH;
+        size_t prefix = strlen(path);
+        res = read_string(image, info->strtab + dyn.d_un.d_val, path + prefix, MAX_PATH - prefix);
+        if (IS_ERROR(res))
+        {
+            return res;
+        }
+
+        if (image->num_deps == IMAGE_MAX_DEPS)
+        {
+            LOG_ERROR("dynamic: %s needs more than %d shared objects", image->path, IMAGE_MAX_DEPS);
+            return -RES_OVERFLOW;
+        }
+
+        exec_image_t *dep = image_get_depth(path, depth + 1);
+        if (!dep)
+        {
+            LOG_ERROR("dynamic: %s needs %s which failed to load", image->path, path);
+            return -RES_UNAVAILABLE;
+        }
+
+        image->deps[image->num_deps++] = dep;
+    }
+}
+
+static uint32_t elf_hash(const char *name)
+{
+    uint32_t h = 0;
+    while (*name)
+    {
+        h = (h << 4) + (uint8_t)*name++;
+        uint32_t g = h & 0xF0000000;
+        if (g)
+        {
+            h ^= g >> 24;
+        }
+        h &= ~g;
+    }
+    return h;
+}
+
+// looks up a defined global symbol through the DT_HASH table of the object
+static bool lookup_in(dynamic_scope_t *scope, const char *name, uint32_t hash, uintptr_t *value)
+{
+    exec_image_t *obj = scope->obj;
+    dynamic_info_t info = scope->info;
+    if (!info.hash || !info.symtab || !info.strtab)
+    {
+        return false;
+    }
+
+    uint32_t nbucket;
+    if (IS_ERROR(image_read(obj, info.hash, &nbucket, sizeof(nbucket))) || nbucket == 0)
+    {
+        return false;
+    }
+
+    uint32_t index;
+    if (IS_ERROR(image_read(obj, info.hash + 8 + (hash % nbucket) * 4, &index, sizeof(index))))
+    {
+        return false;
+    }
+
+    uintptr_t chains = info.hash + 8 + nbucket * 4;
+    while (index != 0)
+    {
+        Elf64_Sym sym;
+        if (IS_ERROR(image_read(obj, info.symtab + index * sizeof(Elf64_Sym), &sym, sizeof(sym))))
+        {
+            return false;
+        }
+
+        uint8_t bind = ELF64_ST_BIND(sym.st_info);
+        if (sym.st_shndx != SHN_UNDEF && (bind == STB_GLOBAL || bind == STB_WEAK))
+        {
+            char sym_name[DYNAMIC_MAX_NAME];
+            if (!IS_ERROR(read_string(obj, info.strtab + sym.st_name, sym_name, sizeof(sym_name))) && strcmp(sym_name, name) == 0)
+            {
+                *value = obj->base + sym.st_value;
+                return true;
+            }
+        }
+
+        if (IS_ERROR(image_read(obj, chains + index * 4, &index, sizeof(index))))
+        {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+static KRES resolve_symbol(dynamic_scope_t *scope, size_t scope_size, exec_image_t *image, dynamic_info_t *info, uint32_t sym_index, uintptr_t *value)
+{
+    Elf64_Sym sym;
+    KRES res = image_read(image, info->symtab + sym_index * sizeof(Elf64_Sym), &sym, sizeof(sym));
+    if (IS_ERROR(res))
+    {
+        return res;
+    }
+
+    char name[DYNAMIC_MAX_NAME];
+    res = read_string(image, info->strtab + sym.st_name, name, sizeof(name));
+    if (IS_ERROR(res))
+    {
+        return res;
+    }
+
+    uint32_t hash = elf_hash(name);
+    for (size_t i = 0; i < scope_size; i++)
+    {
+        if (lookup_in(&scope[i], name, hash, value))
+        {
+            return RES_SUCCESS;
+        }
+    }
+
+    if (ELF64_ST_BIND(sym.st_info) == STB_WEAK)
+    {
+        *value = 0;
+        return RES_SUCCESS;
+    }
+
+    LOG_ERROR("dynamic: undefined symbol %s in %s", name, image->path);
+    return -RES_UNAVAILABLE;
+}
+
+static KRES apply_relocations(dynamic_scope_t *scope, size_t scope_size, exec_image_t *image, dynamic_info_t *info, uintptr_t table, size_t size)
+{
+    for (uintptr_t entry = table; entry < table + size; entry += sizeof(Elf64_Rela))
+    {
+        Elf64_Rela rela;
+        KRES res = image_read(image, entry, &rela, sizeof(rela));
+        if (IS_ERROR(res))
+        {
+            return res;
+        }
+
+        uint64_t value;
+        switch (ELF64_R_TYPE(rela.r_info))
+        {
+        case R_X86_64_NONE:
+            continue;
+        case R_X86_64_RELATIVE:
+            value = image->base + rela.r_addend;
+            break;
+        case R_X86_64_64:
+        case R_X86_64_GLOB_DAT:
+        case R_X86_64_JUMP_SLOT:
+        {
+            uintptr_t sym_value;
+            res = resolve_symbol(scope, scope_size, image, info, ELF64_R_SYM(rela.r_info), &sym_value);
+            if (IS_ERROR(res))
+            {
+                return res;
+            }
+
+            value = sym_value;
+            if (ELF64_R_TYPE(rela.r_info) == R_X86_64_64)
+            {
+                value += rela.r_addend;
+            }
+            break;
+        }
+        default:
+            // copy relocations would need the library to see the copy in the executable, code has to be built with -fpic
+            LOG_ERROR("dynamic: unsupported relocation type %ld in %s", ELF64_R_TYPE(rela.r_info), image->path);
+            return -RES_INVARG;
+        }
+
+        res = image_write(image, rela.r_offset, &value, sizeof(value));
+        if (IS_ERROR(res))
+        {
+            return res;
+        }
+    }
+
+    return RES_SUCCESS;
+}
+
+KRES dynamic_link(exec_image_t *image, unsigned int depth)
+{
+    if (!image->dynamic)
+    {
+        return RES_SUCCESS;
+    }
+
+    if (depth > DYNAMIC_MAX_DEPTH)
+    {
+        LOG_ERROR("dynamic: shared objects of %s nest too deep", image->path);
+        return -RES_OVERFLOW;
+    }
+
+    dynamic_info_t info;
+    KRES res = read_dynamic(image, &info);
+    if (IS_ERROR(res))
+    {
+        return res;
+    }
+
+    if (!info.strtab || !info.symtab)
+    {
+        return -RES_CORRUPT;
+    }
+
+    res = load_dependencies(image, &info, depth);
+    if (IS_ERROR(res))
+    {
+        return res;
+    }
+
+    exec_image_t *objs[DYNAMIC_MAX_OBJECTS];
+    size_t scope_size = dynamic_collect(image, objs, DYNAMIC_MAX_OBJECTS);
+
+    // symbols are searched in the image first, then breadth first through its dependencies
+    dynamic_scope_t scope[DYNAMIC_MAX_OBJECTS];
+    for (size_t i = 0; i < scope_size; i++)
+    {
+        scope[i].obj = objs[i];
+        memset(&scope[i].info, 0, sizeof(dynamic_info_t));
+        if (objs[i]->dynamic)
+        {
+            res = read_dynamic(objs[i], &scope[i].info);
+            if (IS_ERROR(res))
+            {
+                return res;
+            }
+        }
+    }
+
+    // the plt is bound right away, the result is cached with the image so there is nothing left to do lazily
+    res = apply_relocations(scope, scope_size, image, &info, info.rela, info.relasz);
+    if (IS_ERROR(res))
+    {
+        return res;
+    }
+
+    return apply_relocations(scope, scope_size, image, &info, info.jmprel, info.pltrelsz);
+}
@@ -0,0 +1,300 @@
+#include <kernel/proc/epoll.h>
+#include <kernel/kmm.h>
+#include <kernel/cpu.h>
+#include <kernel/string.h>
+#include <kernel/time.h>
+#include <kernel/hrtimer.h>
+
+epoll_t *epoll_create(void)
+{
+    epoll_t *epoll = kmalloc(sizeof(epoll_t));
+    if (!epoll)
+    {
+        return NULL;
+    }
+
+    memset(epoll, 0, sizeof(epoll_t));
+    wait_queue_init(&epoll->wait);
+    epoll->refcount = 1;
+
+    return epoll;
+}
+
+static void epoll_mark_ready(epoll_item_t *item)
+{
+    if (item->ready)
+    {
+        return;
+    }
+
+    item->ready = true;
+    item->ready_next = item->epoll->ready;
+    item->epoll->ready = item;
+
+    wait_queue_wake_all(&item->epoll->wait);
+}
+
+// runs from the wakeup of the stream, interrupts are disabled
+static void epoll_item_wake(wait_entry_t *entry)
+{
+    epoll_mark_ready((epoll_item_t *)entry->data);
+}
+
+static void epoll_item_remove(epoll_item_t *item)
+{
+    for (size_t i = 0; i < item->num_entries; i++)
+    {
+        wait_queue_remove(&item->entries[i]);
+    }
+
+    for (epoll_item_t **link = &item->epoll->items; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == item)
+        {
+            *link = item->next;
+            break;
+        }
+    }
+
+    for (epoll_item_t **link = &item->epoll->ready; item->ready && *link != NULL; link = &(*link)->ready_next)
+    {
+        if (*link == item)
+        {
+            *link = item->ready_next;
+            break;
+        }
+    }
+
+    for (epoll_item_t **link = &item->stream->watchers; *link != NULL; link = &(*link)->stream_next)
+    {
+        if (*link == item)
+        {
+            *link = item->stream_next;
+            break;
+        }
+    }
+
+    kfree(item);
+}
+
+void epoll_hold(epoll_t *epoll)
+{
+    uint64_t flags = cpu_irq_save();
+    epoll->refcount++;
+    cpu_irq_restore(flags);
+}
+
+void epoll_put(epoll_t *epoll)
+{
+    uint64_t flags = cpu_irq_save();
+
+    if (--epoll->refcount > 0)
+    {
+        cpu_irq_restore(flags);
+        return;
+    }
+
+    while (epoll->items != NULL)
+    {
+        epoll_item_remove(epoll->items);
+    }
+
+    cpu_irq_restore(flags);
+    kfree(epoll);
+}
+
+static epoll_item_t *epoll_find(epoll_t *epoll, int32_t fd)
+{
+    for (epoll_item_t *item = epoll->items; item != NULL; item = item->next)
+    {
+        if (item->fd == fd)
+        {
+            return item;
+        }
+    }
+
+    return NULL;
+}
+
+static KRES epoll_add(epoll_t *epoll, int32_t fd, stream_t *stream, const epoll_event_t *event)
+{
+    if (stream->type == STREAM_TYPE_EPOLL)
+    {
+        return -RES_INVARG; // a wakeup could come back around to the same instance
+    }
+
+    if (epoll_find(epoll, fd))
+    {
+        return -RES_INVARG;
+    }
+
+    epoll_item_t *item = kmalloc(sizeof(epoll_item_t));
+    if (!item)
+    {
+        return -RES_NOMEM;
+    }
+
+    memset(item, 0, sizeof(epoll_item_t));
+    item->epoll = epoll;
+    item->stream = stream;
+    item->fd = fd;
+    item->event = *event;
+
+    item->next = epoll->items;
+    epoll->items = item;
+    item->stream_next = stream->watchers;
+    stream->watchers = item;
+
+    // the entries stay on the queues of the stream until the item is removed
+    poll_table_t table = {
+        .task = NULL,
+        .func = &epoll_item_wake,
+        .data = item,
+        .entries = item->entries,
+        .count = 0,
+        .max = EPOLL_ITEM_QUEUES,
+    };
+
+    if (stream_poll(stream, &table) & (event->events | POLLERR | POLLHUP))
+    {
+        epoll_mark_ready(item);
+    }
+    item->num_entries = table.count;
+
+    return RES_SUCCESS;
+}
+
+KRES epoll_ctl(epoll_t *epoll, int op, int32_t fd, stream_t *stream, const epoll_event_t *event)
+{
+    if (!epoll || !stream)
+    {
+        return -RES_INVARG;
+    }
+
+    uint64_t flags = cpu_irq_save();
+
+    KRES res = RES_SUCCESS;
+    epoll_item_t *item;
+    switch (op)
+    {
+    case EPOLL_CTL_ADD:
+        res = epoll_add(epoll, fd, stream, event);
+        break;
+    case EPOLL_CTL_DEL:
+        item = epoll_find(epoll, fd);
+        if (!item)
+        {
+            res = -RES_INVARG;
+            break;
+        }
+
+        epoll_item_remove(item);
+        break;
+    case EPOLL_CTL_MOD:
+        item = epoll_find(epoll, fd);
+        if (!item)
+        {
+            res = -RES_INVARG;
+            break;
+        }
+
+        item->event = *event;
+        if (stream_poll(item->stream, NULL) & (event->events | POLLERR | POLLHUP))
+        {
+            epoll_mark_ready(item);
+        }
+        break;
+    default:
+        res = -RES_INVARG;
+        break;
+    }
+
+    cpu_irq_restore(flags);
+    return res;
+}
+
+int64_t epoll_wait(epoll_t *epoll, task_t *task, epoll_event_t *events, size_t max, int64_t timeout_ns)
+{
+    uint64_t deadline = time_get_ns() + (timeout_ns > 0 ? (uint64_t)timeout_ns : 0);
+
+    uint64_t flags = cpu_irq_save();
+
+    if (timeout_ns > 0 && !poll_timeout_start(task, timeout_ns))
+    {
+        cpu_irq_restore(flags);
+        return -RES_NOMEM;
+    }
+
+    size_t count;
+    for (;;)
+    {
+        count = 0;
+
+        epoll_item_t **link = &epoll->ready;
+        while (*link != NULL && count < max)
+        {
+            epoll_item_t *item = *link;
+            uint32_t ready = stream_poll(item->stream, NULL) & (item->event.events | POLLERR | POLLHUP);
+            if (!ready)
+            {
+                *link = item->ready_next;
+                item->ready = false;
+                continue;
+            }
+
+            events[count].events = ready;
+            events[count].data = item->event.data;
+            count++;
+
+            link = &item->ready_next;
+        }
+
+        // reported items go to the back, so a small max does not starve the rest of the list
+        if (count > 0 && *link != NULL)
+        {
+            epoll_item_t *reported = epoll->ready;
+            epoll->ready = *link;
+            *link = NULL;
+
+            epoll_item_t **tail = &epoll->ready;
+            while (*tail != NULL)
+            {
+                tail = &(*tail)->ready_next;
+            }
+            *tail = reported;
+        }
+
+        if (count > 0 || timeout_ns == 0 || (timeout_ns > 0 && time_get_ns() >= deadline))
+        {
+            break;
+        }
+
+        wait_queue_sleep(&epoll->wait, task);
+    }
+
+    if (timeout_ns > 0)
+    {
+        hrtimer_cancel(&task->timeout);
+    }
+
+    cpu_irq_restore(flags);
+    return (int64_t)count;
+}
+
+uint32_t epoll_poll(epoll_t *epoll, poll_table_t *table)
+{
+    poll_wait(table, &epoll->wait);
+    return epoll->ready ? POLLIN : 0;
+}
+
+void epoll_forget(stream_t *stream)
+{
+    uint64_t flags = cpu_irq_save();
+
+    while (stream->watchers != NULL)
+    {
+        epoll_item_remove(stream->watchers);
+    }
+
+    cpu_irq_restore(flags);
+}
@@ -0,0 +1,138 @@
+#include <kernel/proc/futex.h>
+#include <kernel/cpu.h>
+#include <kernel/time.h>
+#include <kernel/hrtimer.h>
+
+typedef struct _futex_waiter
+{
+    task_t *task;
+    page_table_t *pml4;
+    uintptr_t vaddr;
+    bool woken;
+
+    struct _futex_waiter *next;
+} futex_waiter_t;
+
+// waiters live on the kernel stack of the waiting task, which is mapped in every address space
+static futex_waiter_t *buckets[FUTEX_HASH_SIZE];
+
+static inline size_t futex_hash(page_table_t *pml4, uintptr_t vaddr)
+{
+    uint64_t key = ((uint64_t)pml4 >> 12) ^ (vaddr >> 2);
+    key *= 0x9E3779B97F4A7C15ULL;
+    return (size_t)(key >> 32) % FUTEX_HASH_SIZE;
+}
+
+static void futex_unqueue(futex_waiter_t *waiter)
+{
+    for (futex_waiter_t **link = &buckets[futex_hash(waiter->pml4, waiter->vaddr)]; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == waiter)
+        {
+            *link = waiter->next;
+            return;
+        }
+    }
+}
+
+static void futex_timeout(hrtimer_t *timer)
+{
+    task_wakeup((task_t *)timer->data);
+}
+
+KRES futex_wait(task_t *task, uint32_t *uaddr, uintptr_t vaddr, uint32_t val, uint64_t timeout_ns)
+{
+    // the value check and the queueing must not race with a wake from an interrupt or another thread
+    uint64_t flags = cpu_irq_save();
+
+    if (*(volatile uint32_t *)uaddr != val)
+    {
+        cpu_irq_restore(flags);
+        return -RES_UNAVAILABLE;
+    }
+
+    futex_waiter_t waiter = {
+        .task = task,
+        .pml4 = task->proc->pml4,
+        .vaddr = vaddr,
+        .woken = false,
+    };
+
+    size_t bucket = futex_hash(waiter.pml4, vaddr);
+    waiter.next = buckets[bucket];
+    buckets[bucket] = &waiter;
+
+    if (timeout_ns)
+    {
+        hrtimer_init(&task->timeout, &futex_timeout, task);
+        if (hrtimer_start(&task->timeout, time_get_ns() + timeout_ns) < 0)
+        {
+            futex_unqueue(&waiter);
+            cpu_irq_restore(flags);
+            return -RES_NOMEM;
+        }
+    }
+
+    task->status = TASK_STATUS_BLOCKED;
+    schedule();
+
+    if (timeout_ns)
+    {
+        hrtimer_cancel(&task->timeout);
+    }
+
+    KRES res = RES_SUCCESS;
+    if (!waiter.woken)
+    {
+        futex_unqueue(&waiter);
+        res = -RES_TIMEOUT;
+    }
+
+    cpu_irq_restore(flags);
+    return res;
+}
+
+size_t futex_wake(page_table_t *pml4, uintptr_t vaddr, size_t count)
+{
+    uint64_t flags = cpu_irq_save();
+
+    size_t woken = 0;
+    futex_waiter_t **link = &buckets[futex_hash(pml4, vaddr)];
+    while (*link != NULL && woken < count)
+    {
+        futex_waiter_t *waiter = *link;
+        if (waiter->pml4 != pml4 || waiter->vaddr != vaddr)
+        {
+            link = &waiter->next;
+            continue;
+        }
+
+        *link = waiter->next;
+        waiter->woken = true;
+        task_wakeup(waiter->task);
+        woken++;
+    }
+
+    cpu_irq_restore(flags);
+    return woken;
+}
+
+void futex_cancel(task_t *task)
+{
+    uint64_t flags = cpu_irq_save();
+
+    for (size_t i = 0; i < FUTEX_HASH_SIZE; i++)
+    {
+        for (futex_waiter_t **link = &buckets[i]; *link != NULL; link = &(*link)->next)
+        {
+            if ((*link)->task == task)
+            {
+                *link = (*link)->next;
+                cpu_irq_restore(flags);
+                return;
+            }
+        }
+    }
+
+    cpu_irq_restore(flags);
+}
@@ -0,0 +1,549 @@
+#include <kernel/proc/image.h>
+#include <kernel/proc/task.h>
+#include <kernel/proc/dynamic.h>
+#include <kernel/kmm.h>
+#include <kernel/pmm.h>
+#include <kernel/cpu.h>
+#include <kernel/string.h>
+#include <kernel/kprintf.h>
+#include <kernel/log.h>
+#include <kernel/time.h>
+
+static exec_image_t *image_head = NULL;
+static size_t num_images = 0;
+
+static void image_free(exec_image_t *image)
+{
+    for (size_t i = 0; i < image->num_deps; i++)
+    {
+        image_put(image->deps[i]);
+    }
+
+    if (image->segments)
+    {
+        for (size_t i = 0; i < image->num_segments; i++)
+        {
+            exec_image_segment_t *seg = &image->segments[i];
+            if (!seg->pages)
+            {
+                continue;
+            }
+
+            for (size_t j = 0; j < seg->num_pages; j++)
+            {
+                if (seg->pages[j])
+                {
+                    pmm_free(seg->pages[j]);
+                }
+            }
+            kfree(seg->pages);
+        }
+        kfree(image->segments);
+    }
+
+    kfree(image);
+}
+
+// reads the whole file range of the segment with one sequential read
+static int load_segment(elf_file_t *elf_file, exec_image_segment_t *seg)
+{
+    Elf64_Phdr *ph = &seg->phdr;
+    if (ph->p_filesz > ph->p_memsz)
+    {
+        return -RES_CORRUPT;
+    }
+
+    uint64_t aligned_vaddr = ph->p_vaddr & ~(PAGE_SIZE - 1);
+    uint64_t offset_in_page = ph->p_vaddr - aligned_vaddr;
+    uint64_t mem_end = ph->p_vaddr + ph->p_memsz;
+
+    seg->num_pages = (uint64_t)page_align_address_higer((void *)(mem_end - aligned_vaddr)) / PAGE_SIZE;
+    seg->pages = kmalloc(seg->num_pages * sizeof(void *));
+    if (!seg->pages)
+    {
+        return -RES_NOMEM;
+    }
+    memset(seg->pages, 0, seg->num_pages * sizeof(void *));
+
+    // frames are freed one by one later, so a contiguous run is only needed while loading
+    uint8_t *frames = pmm_alloc_contiguous(seg->num_pages);
+    uint8_t *bounce = NULL;
+    if (frames)
+    {
+        for (size_t i = 0; i < seg->num_pages; i++)
+        {
+            seg->pages[i] = frames + i * PAGE_SIZE;
+        }
+        memset(frames, 0, seg->num_pages * PAGE_SIZE);
+    }
+    else
+    {
+        for (size_t i = 0; i < seg->num_pages; i++)
+        {
+            seg->pages[i] = pmm_alloc();
+            if (!seg->pages[i])
+            {
+                return -RES_NOMEM;
+            }
+            memset(seg->pages[i], 0, PAGE_SIZE);
+        }
+    }
+
+    if (ph->p_filesz == 0)
+    {
+        return RES_SUCCESS;
+    }
+
+    uint8_t *dest = frames ? frames + offset_in_page : NULL;
+    if (!dest)
+    {
+        bounce = kmalloc(ph->p_filesz);
+        if (!bounce)
+        {
+            return -RES_NOMEM;
+        }
+        dest = bounce;
+    }
+
+    int status = vfs_seek(elf_file->file, ph->p_offset, SEEK_TYPE_SET);
+    if (status >= 0)
+    {
+        status = vfs_read(elf_file->file, ph->p_filesz, dest);
+    }
+
+    if (bounce)
+    {
+        // scatter into the frames
+        for (size_t copied = 0; status >= 0 && copied < ph->p_filesz;)
+        {
+            size_t pos = offset_in_page + copied;
+            size_t len = PAGE_SIZE - pos % PAGE_SIZE;
+            if (len > ph->p_filesz - copied)
+            {
+                len = ph->p_filesz - copied;
+            }
+
+            memcpy((uint8_t *)seg->pages[pos / PAGE_SIZE] + pos % PAGE_SIZE, bounce + copied, len);
+            copied += len;
+        }
+        kfree(bounce);
+    }
+
+    return status < 0 ? status : RES_SUCCESS;
+}
+
+static exec_image_t *image_load(const char *path, file_node_t *node, unsigned int depth)
+{
+    uint64_t start = time_get_ns();
+
+    elf_file_t *elf_file = elf_load(path);
+    if (!elf_file)
+    {
+        return NULL;
+    }
+
+    exec_image_t *image = kmalloc(sizeof(exec_image_t));
+    if (!image)
+    {
+        elf_free(elf_file);
+        return NULL;
+    }
+    memset(image, 0, sizeof(exec_image_t));
+
+    strncpy(image->path, path, MAX_PATH);
+    image->filesize = node->filesize;
+    image->write_time = node->write_time;
+    image->write_date = node->write_date;
+    memcpy(&image->header, elf_file->header, sizeof(Elf64_Ehdr));
+
+    uintptr_t end = 0;
+    for (Elf64_Half i = 0; i < elf_file->header->e_phnum; i++)
+    {
+        Elf64_Phdr *ph = &elf_file->pheader[i];
+        if (ph->p_type == PT_LOAD)
+        {
+            image->num_segments++;
+            if (ph->p_vaddr + ph->p_memsz > end)
+            {
+                end = ph->p_vaddr + ph->p_memsz;
+            }
+        }
+        else if (ph->p_type == PT_DYNAMIC)
+        {
+            image->dynamic = ph->p_vaddr;
+        }
+    }
+
+    if (elf_file->header->e_type == ET_DYN)
+    {
+        image->base = dynamic_reserve(end);
+    }
+
+    image->segments = kmalloc(image->num_segments * sizeof(exec_image_segment_t));
+    if (!image->segments)
+    {
+        elf_free(elf_file);
+        image_free(image);
+        return NULL;
+    }
+    memset(image->segments, 0, image->num_segments * sizeof(exec_image_segment_t));
+
+    size_t index = 0;
+    for (Elf64_Half i = 0; i < elf_file->header->e_phnum; i++)
+    {
+        if (elf_file->pheader[i].p_type != PT_LOAD)
+        {
+            continue;
+        }
+
+        exec_image_segment_t *seg = &image->segments[index++];
+        memcpy(&seg->phdr, &elf_file->pheader[i], sizeof(Elf64_Phdr));
+        if (load_segment(elf_file, seg) < 0)
+        {
+            elf_free(elf_file);
+            image_free(image);
+            return NULL;
+        }
+    }
+
+    elf_free(elf_file);
+
+    if (IS_ERROR(dynamic_link(image, depth)))
+    {
+        image_free(image);
+        return NULL;
+    }
+
+    size_t num_pages = 0;
+    for (size_t i = 0; i < image->num_segments; i++)
+    {
+        num_pages += image->segments[i].num_pages;
+    }
+    LOG_INFO("image: loaded %s, %ld pages in %ld us", path, num_pages, (time_get_ns() - start) / 1000);
+
+    return image;
+}
+
+static bool image_matches(exec_image_t *image, const char *path, file_node_t *node)
+{
+    return image->filesize == node->filesize && image->write_time == node->write_time && image->write_date == node->write_date && strcmp(image->path, path) == 0;
+}
+
+// must be called with interrupts disabled
+static void image_unlink(exec_image_t *image)
+{
+    for (exec_image_t **link = &image_head; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == image)
+        {
+            *link = image->next;
+            image->cached = false;
+            num_images--;
+            return;
+        }
+    }
+}
+
+// drops the least recently used images nobody maps anymore, must be called with interrupts disabled
+static exec_image_t *image_evict(void)
+{
+    exec_image_t *evicted = NULL;
+
+    while (num_images > IMAGE_CACHE_MAX)
+    {
+        exec_image_t *victim = NULL;
+        for (exec_image_t *image = image_head; image != NULL; image = image->next)
+        {
+            if (image->refcount == 0)
+            {
+                victim = image;
+            }
+        }
+
+        if (!victim)
+        {
+            break;
+        }
+
+        image_unlink(victim);
+        victim->next = evicted;
+        evicted = victim;
+    }
+
+    return evicted;
+}
+
+exec_image_t *image_get(const char *path)
+{
+    return image_get_depth(path, 0);
+}
+
+exec_image_t *image_get_depth(const char *path, unsigned int depth)
+{
+    // only the directory entry is needed to validate a cached image
+    stream_t *file = vfs_open(path, OPEN_ACTION_READ);
+    if (!file)
+    {
+        return NULL;
+    }
+
+    if (file->type != STREAM_TYPE_FILE)
+    {
+        stream_free(file);
+        return NULL;
+    }
+
+    file_node_t *node = file->node;
+    exec_image_t *stale = NULL;
+
+    uint64_t flags = cpu_irq_save();
+
+    for (exec_image_t *image = image_head; image != NULL; image = image->next)
+    {
+        if (strcmp(image->path, path) != 0)
+        {
+            continue;
+        }
+
+        if (image_matches(image, path, node))
+        {
+            image->refcount++;
+
+            // move to the front so eviction picks the images that were not used for the longest time
+            image_unlink(image);
+            image->next = image_head;
+            image_head = image;
+            image->cached = true;
+            num_images++;
+
+            cpu_irq_restore(flags);
+            stream_free(file);
+            return image;
+        }
+
+        // the file changed, processes still running the old version keep it alive
+        image_unlink(image);
+        if (image->refcount == 0)
+        {
+            stale = image;
+        }
+        break;
+    }
+
+    cpu_irq_restore(flags);
+
+    if (stale)
+    {
+        image_free(stale);
+    }
+
+    exec_image_t *image = image_load(path, node, depth);
+    stream_free(file);
+    if (!image)
+    {
+        return NULL;
+    }
+
+    flags = cpu_irq_save();
+
+    // someone else might have loaded the same file in the meantime
+    for (exec_image_t *other = image_head; other != NULL; other = other->next)
+    {
+        if (other->filesize == image->filesize && other->write_time == image->write_time && other->write_date == image->write_date && strcmp(other->path, path) == 0)
+        {
+            other->refcount++;
+            cpu_irq_restore(flags);
+            image_free(image);
+            return other;
+        }
+    }
+
+    image->refcount = 1;
+    image->cached = true;
+    image->next = image_head;
+    image_head = image;
+    num_images++;
+
+    exec_image_t *evicted = image_evict();
+
+    cpu_irq_restore(flags);
+
+    while (evicted)
+    {
+        exec_image_t *next = evicted->next;
+        image_free(evicted);
+        evicted = next;
+    }
+
+    return image;
+}
+
+void image_hold(exec_image_t *image)
+{
+    uint64_t flags = cpu_irq_save();
+    image->refcount++;
+    cpu_irq_restore(flags);
+}
+
+void image_put(exec_image_t *image)
+{
+    if (!image)
+    {
+        return;
+    }
+
+    uint64_t flags = cpu_irq_save();
+    bool unused = --image->refcount == 0 && !image->cached;
+    cpu_irq_restore(flags);
+
+    if (unused)
+    {
+        image_free(image);
+    }
+}
+
+uint64_t image_entry(exec_image_t *image)
+{
+    return image->header.e_entry;
+}
+
+// finds the cached page backing a link time address
+static uint8_t *image_translate(exec_image_t *image, uintptr_t vaddr, size_t *avail)
+{
+    for (size_t i = 0; i < image->num_segments; i++)
+    {
+        exec_image_segment_t *seg = &image->segments[i];
+        uintptr_t aligned_vaddr = seg->phdr.p_vaddr & ~(PAGE_SIZE - 1);
+        if (vaddr < aligned_vaddr || vaddr >= aligned_vaddr + seg->num_pages * PAGE_SIZE)
+        {
+            continue;
+        }
+
+        size_t offset = vaddr - aligned_vaddr;
+        *avail = PAGE_SIZE - offset % PAGE_SIZE;
+        return (uint8_t *)seg->pages[offset / PAGE_SIZE] + offset % PAGE_SIZE;
+    }
+
+    return NULL;
+}
+
+KRES image_read(exec_image_t *image, uintptr_t vaddr, void *buf, size_t size)
+{
+    while (size > 0)
+    {
+        size_t avail;
+        uint8_t *src = image_translate(image, vaddr, &avail);
+        if (!src)
+        {
+            return -RES_INVARG;
+        }
+
+        size_t len = size < avail ? size : avail;
+        memcpy(buf, src, len);
+        buf = (uint8_t *)buf + len;
+        vaddr += len;
+        size -= len;
+    }
+
+    return RES_SUCCESS;
+}
+
+KRES image_write(exec_image_t *image, uintptr_t vaddr, const void *buf, size_t size)
+{
+    while (size > 0)
+    {
+        size_t avail;
+        uint8_t *dest = image_translate(image, vaddr, &avail);
+        if (!dest)
+        {
+            return -RES_INVARG;
+        }
+
+        size_t len = size < avail ? size : avail;
+        memcpy(dest, buf, len);
+        buf = (const uint8_t *)buf + len;
+        vaddr += len;
+        size -= len;
+    }
+
+    return RES_SUCCESS;
+}
+
+static int image_map_object(process_t *proc, exec_image_t *image, process_t *original)
+{
+    for (size_t i = 0; i < image->num_segments; i++)
+    {
+        exec_image_segment_t *seg = &image->segments[i];
+        uint64_t aligned_vaddr = image->base + (seg->phdr.p_vaddr & ~(PAGE_SIZE - 1));
+        bool writable = seg->phdr.p_flags & PF_W;
+
+        int flags = PAGE_PRESENT | PAGE_USER;
+        if (writable)
+            flags |= PAGE_WRITABLE;
+        if (!(seg->phdr.p_flags & PF_X))
+            flags |= PAGE_NO_EXECUTE;
+
+        for (size_t j = 0; j < seg->num_pages; j++)
+        {
+            void *page = seg->pages[j];
+            if (writable)
+            {
+                void *copy = pmm_alloc();
+                if (!copy)
+                {
+                    return -RES_NOMEM;
+                }
+
+                // a forked child continues with the data of its parent
+                memcpy(copy, original ? original->data_pages[proc->num_data_pages] : page, PAGE_SIZE);
+                proc->data_pages[proc->num_data_pages++] = copy;
+                page = copy;
+            }
+
+            int status = pml4_map(proc->pml4, (void *)(aligned_vaddr + j * PAGE_SIZE), page, flags);
+            if (status < 0)
+            {
+                return status;
+            }
+        }
+    }
+
+    return RES_SUCCESS;
+}
+
+int image_map(process_t *proc, exec_image_t *image, process_t *original)
+{
+    // the order is the same for every process running the image, so fork can match up the private pages
+    exec_image_t *objs[DYNAMIC_MAX_OBJECTS];
+    size_t num_objs = dynamic_collect(image, objs, DYNAMIC_MAX_OBJECTS);
+
+    size_t num_private = 0;
+    for (size_t i = 0; i < num_objs; i++)
+    {
+        for (size_t j = 0; j < objs[i]->num_segments; j++)
+        {
+            if (objs[i]->segments[j].phdr.p_flags & PF_W)
+            {
+                num_private += objs[i]->segments[j].num_pages;
+            }
+        }
+    }
+
+    proc->num_data_pages = 0;
+    proc->data_pages = kmalloc((num_private ? num_private : 1) * sizeof(void *));
+    if (!proc->data_pages)
+    {
+        return -RES_NOMEM;
+    }
+
+    for (size_t i = 0; i < num_objs; i++)
+    {
+        int status = image_map_object(proc, objs[i], original);
+        if (status < 0)
+        {
+            return status;
+        }
+    }
+
+    return RES_SUCCESS;
+}
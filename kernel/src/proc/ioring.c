@@ -0,0 +1,267 @@
+#include <kernel/proc/ioring.h>
+#include <kernel/proc/futex.h>
+#include <kernel/proc/scheduler.h>
+#include <kernel/pmm.h>
+#include <kernel/kmm.h>
+#include <kernel/cpu.h>
+#include <kernel/string.h>
+
+#define CQ_TAIL_VADDR (PROCESS_IO_RING_VADDR + offsetof(io_ring_header_t, cq_tail))
+
+static bool is_power_of_two(uint32_t n)
+{
+    return n && !(n & (n - 1));
+}
+
+static void ring_publish(io_ring_t *ring)
+{
+    __atomic_store_n(&ring->header->sq_head, ring->sq_head, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->header->cq_tail, ring->cq_tail, __ATOMIC_RELEASE);
+}
+
+// the caller owns the ring through the busy flag
+static uint32_t ring_drain(io_ring_t *ring, uint32_t max)
+{
+    io_ring_header_t *header = ring->header;
+    uint32_t sq_mask = ring->sq_entries - 1;
+    uint32_t cq_mask = ring->cq_entries - 1;
+
+    uint32_t done = 0;
+    while (done < max && !ring->dead)
+    {
+        uint32_t tail = __atomic_load_n(&header->sq_tail, __ATOMIC_ACQUIRE);
+        if (tail == ring->sq_head || tail - ring->sq_head > ring->sq_entries)
+        {
+            break;
+        }
+
+        // submissions wait while there is no room for their completion
+        uint32_t cq_head = __atomic_load_n(&header->cq_head, __ATOMIC_ACQUIRE);
+        if (ring->cq_tail - cq_head >= ring->cq_entries)
+        {
+            break;
+        }
+
+        // copied first, the process may rewrite the slot as soon as sq_head moves
+        io_ring_sqe_t sqe = ring->sqes[ring->sq_head & sq_mask];
+        ring->sq_head++;
+
+        io_ring_cqe_t *cqe = &ring->cqes[ring->cq_tail & cq_mask];
+        cqe->user_data = sqe.user_data;
+        cqe->result = syscall_ring_execute(ring->proc, &sqe);
+        ring->cq_tail++;
+
+        ring_publish(ring);
+        done++;
+
+        cond_resched();
+    }
+
+    return done;
+}
+
+static bool ring_acquire(io_ring_t *ring)
+{
+    uint64_t flags = cpu_irq_save();
+
+    if (ring->busy || ring->dead)
+    {
+        cpu_irq_restore(flags);
+        return false;
+    }
+    ring->busy = true;
+
+    cpu_irq_restore(flags);
+    return true;
+}
+
+static void ring_release(io_ring_t *ring)
+{
+    ring->busy = false;
+    futex_wake(ring->proc->pml4, CQ_TAIL_VADDR, SIZE_MAX); // waiters recheck whether anything is still in flight
+}
+
+static void ring_work(work_t *work)
+{
+    io_ring_t *ring = work->data;
+    if (ring_acquire(ring))
+    {
+        ring_drain(ring, UINT32_MAX);
+        ring_release(ring);
+    }
+
+    // the last touch of the ring, io_ring_shutdown cannot get in between with interrupts off
+    uint64_t flags = cpu_irq_save();
+    ring->work_refs--;
+    futex_wake(ring->proc->pml4, CQ_TAIL_VADDR, SIZE_MAX); // waiters see that nothing is in flight anymore
+    cpu_irq_restore(flags);
+}
+
+int64_t io_ring_setup(process_t *proc, uint32_t entries)
+{
+    if (proc->io_ring)
+    {
+        return -RES_UNAVAILABLE;
+    }
+
+    if (!is_power_of_two(entries) || entries > IO_RING_MAX_ENTRIES)
+    {
+        return -RES_INVARG;
+    }
+
+    uint32_t cq_entries = entries * 2;
+    size_t sq_offset = sizeof(io_ring_header_t);
+    size_t cq_offset = sq_offset + entries * sizeof(io_ring_sqe_t);
+    size_t size = cq_offset + cq_entries * sizeof(io_ring_cqe_t);
+
+    io_ring_t *ring = kmalloc(sizeof(io_ring_t));
+    if (!ring)
+    {
+        return -RES_NOMEM;
+    }
+    memset(ring, 0, sizeof(io_ring_t));
+
+    // contiguous so the kernel can index the entries directly through the identity map
+    ring->num_pages = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+    ring->pages = pmm_alloc_contiguous(ring->num_pages);
+    if (!ring->pages)
+    {
+        kfree(ring);
+        return -RES_NOMEM;
+    }
+    memset(ring->pages, 0, ring->num_pages * PAGE_SIZE);
+
+    for (size_t i = 0; i < ring->num_pages; i++)
+    {
+        if (pml4_map(proc->pml4, (void *)(PROCESS_IO_RING_VADDR + i * PAGE_SIZE), ring->pages + i * PAGE_SIZE, PAGE_PRESENT | PAGE_WRITABLE | PAGE_USER) < 0)
+        {
+            for (size_t j = 0; j < i; j++)
+            {
+                pml4_map(proc->pml4, (void *)(PROCESS_IO_RING_VADDR + j * PAGE_SIZE), NULL, 0);
+            }
+            for (size_t j = 0; j < ring->num_pages; j++)
+            {
+                pmm_free((uint64_t *)(ring->pages + j * PAGE_SIZE));
+            }
+            kfree(ring);
+            return -RES_NOMEM;
+        }
+    }
+
+    ring->proc = proc;
+    ring->header = (io_ring_header_t *)ring->pages;
+    ring->sqes = (io_ring_sqe_t *)(ring->pages + sq_offset);
+    ring->cqes = (io_ring_cqe_t *)(ring->pages + cq_offset);
+
+    ring->sq_entries = entries;
+    ring->cq_entries = cq_entries;
+    ring->header->sq_entries = entries;
+    ring->header->cq_entries = cq_entries;
+    ring->header->sq_offset = sq_offset;
+    ring->header->cq_offset = cq_offset;
+
+    work_init(&ring->work, &ring_work, ring);
+    proc->io_ring = ring;
+
+    return PROCESS_IO_RING_VADDR;
+}
+
+int64_t io_ring_enter(process_t *proc, uint32_t to_submit, uint32_t min_complete, uint32_t flags)
+{
+    io_ring_t *ring = proc->io_ring;
+    if (!ring)
+    {
+        return -RES_INVARG;
+    }
+
+    int64_t submitted = 0;
+    if (to_submit)
+    {
+        if (flags & IO_RING_ENTER_ASYNC)
+        {
+            uint64_t irq = cpu_irq_save();
+            if (!ring->dead && work_queue(&ring->work))
+            {
+                ring->work_refs++;
+            }
+            cpu_irq_restore(irq);
+        }
+        else if (ring_acquire(ring))
+        {
+            submitted = ring_drain(ring, to_submit);
+            ring_release(ring);
+        }
+        // otherwise the worker or another thread is already draining and picks up the new entries
+    }
+
+    if (min_complete > ring->cq_entries)
+    {
+        min_complete = ring->cq_entries;
+    }
+
+    task_t *task = get_current_task();
+    while (true)
+    {
+        // nothing can complete between the checks and queueing on the futex
+        uint64_t irq = cpu_irq_save();
+
+        uint32_t tail = ring->cq_tail;
+        uint32_t head = __atomic_load_n(&ring->header->cq_head, __ATOMIC_ACQUIRE);
+        bool in_flight = ring->busy || ring->work_refs;
+        if (tail - head >= min_complete || !in_flight)
+        {
+            cpu_irq_restore(irq);
+            break;
+        }
+
+        KRES res = futex_wait(task, (uint32_t *)&ring->header->cq_tail, CQ_TAIL_VADDR, tail, 0);
+        cpu_irq_restore(irq);
+        if (IS_ERROR(res) && res != -RES_UNAVAILABLE)
+        {
+            return res;
+        }
+    }
+
+    return submitted;
+}
+
+void io_ring_shutdown(process_t *proc)
+{
+    io_ring_t *ring = proc->io_ring;
+    if (!ring)
+    {
+        return;
+    }
+
+    // queued submissions are dropped, a drain in progress stops after the operation it is on
+    uint64_t flags = cpu_irq_save();
+    ring->dead = true;
+    if (work_cancel(&ring->work))
+    {
+        ring->work_refs--;
+    }
+    while (ring->busy || ring->work_refs)
+    {
+        // ring operations never wait, so this is only ever one of them
+        cpu_irq_restore(flags);
+        schedule();
+        flags = cpu_irq_save();
+    }
+    cpu_irq_restore(flags);
+}
+
+void io_ring_free(process_t *proc)
+{
+    io_ring_t *ring = proc->io_ring;
+    if (!ring)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < ring->num_pages; i++)
+    {
+        pmm_free((uint64_t *)(ring->pages + i * PAGE_SIZE));
+    }
+    kfree(ring);
+    proc->io_ring = NULL;
+}
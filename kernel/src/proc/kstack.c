@@ -0,0 +1,106 @@
+#include <kernel/proc/kstack.h>
+#include <kernel/pmm.h>
+#include <kernel/cpu.h>
+#include <kernel/string.h>
+
+#define KERNEL_STACK_SLOT_SIZE ((KERNEL_STACK_PAGES + 1) * PAGE_SIZE) // including the guard page
+
+static page_table_t *pml4 = NULL;
+static uint64_t slots[KERNEL_STACK_MAX / 64];
+
+int kstack_init(page_table_t *kernel_pml4)
+{
+    page_table_t *pdpt = pmm_alloc();
+    if (!pdpt)
+    {
+        return -RES_NOMEM;
+    }
+    memset(pdpt, 0, PAGE_SIZE);
+
+    // created up front so that copying the pml4 entry shares every later mapping
+    kernel_pml4->entries[KERNEL_STACK_PML4_INDEX] = (uint64_t)pdpt | PAGE_PRESENT | PAGE_WRITABLE;
+    pml4 = kernel_pml4;
+
+    memset(slots, 0, sizeof(slots));
+
+    return RES_SUCCESS;
+}
+
+void kstack_share(page_table_t *proc_pml4)
+{
+    proc_pml4->entries[KERNEL_STACK_PML4_INDEX] = pml4->entries[KERNEL_STACK_PML4_INDEX];
+}
+
+static void unmap_slot(uintptr_t base, size_t num_pages)
+{
+    for (size_t i = 1; i <= num_pages; i++)
+    {
+        void *virt = (void *)(base + i * PAGE_SIZE);
+        uint64_t phys = pml4_get_phys(pml4, virt, false);
+        if (phys)
+        {
+            pmm_free((uint64_t *)phys);
+        }
+        pml4_map(pml4, virt, NULL, 0);
+    }
+}
+
+static void release_slot(size_t slot)
+{
+    uint64_t flags = cpu_irq_save();
+    slots[slot / 64] &= ~(1ULL << (slot % 64));
+    cpu_irq_restore(flags);
+}
+
+uintptr_t kstack_alloc(void)
+{
+    uint64_t flags = cpu_irq_save();
+
+    size_t slot = KERNEL_STACK_MAX;
+    for (size_t i = 0; i < KERNEL_STACK_MAX; i++)
+    {
+        if (!(slots[i / 64] & (1ULL << (i % 64))))
+        {
+            slots[i / 64] |= 1ULL << (i % 64);
+            slot = i;
+            break;
+        }
+    }
+
+    cpu_irq_restore(flags);
+
+    if (slot == KERNEL_STACK_MAX)
+    {
+        return 0;
+    }
+
+    uintptr_t base = KERNEL_STACK_REGION + slot * KERNEL_STACK_SLOT_SIZE;
+    for (size_t i = 1; i <= KERNEL_STACK_PAGES; i++)
+    {
+        void *page = pmm_alloc();
+        if (!page || pml4_map(pml4, (void *)(base + i * PAGE_SIZE), page, PAGE_PRESENT | PAGE_WRITABLE) < 0)
+        {
+            if (page)
+            {
+                pmm_free(page);
+            }
+            unmap_slot(base, i - 1);
+            release_slot(slot);
+            return 0;
+        }
+    }
+
+    return base + KERNEL_STACK_SLOT_SIZE;
+}
+
+void kstack_free(uintptr_t top)
+{
+    if (!top)
+    {
+        return;
+    }
+
+    uintptr_t base = top - KERNEL_STACK_SLOT_SIZE;
+    unmap_slot(base, KERNEL_STACK_PAGES);
+    release_slot((base - KERNEL_STACK_REGION) / KERNEL_STACK_SLOT_SIZE);
+}
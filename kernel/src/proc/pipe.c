@@ -0,0 +1,346 @@
+#include <kernel/proc/pipe.h>
+#include <kernel/kmm.h>
+#include <kernel/cpu.h>
+#include <kernel/string.h>
+#include <kernel/proc/task.h>
+
+pipe_t *pipe_create(size_t capacity)
+{
+    if (capacity == 0)
+    {
+        capacity = PIPE_DEFAULT_CAPACITY;
+    }
+
+    if (capacity > PIPE_MAX_CAPACITY)
+    {
+        return NULL;
+    }
+
+    pipe_t *pipe = kmalloc(sizeof(pipe_t));
+    if (!pipe)
+    {
+        return NULL;
+    }
+
+    memset(pipe, 0, sizeof(pipe_t));
+
+    pipe->capacity = (capacity + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+    pipe->buffer = pmm_alloc_contiguous(pipe->capacity / PAGE_SIZE);
+    if (!pipe->buffer)
+    {
+        kfree(pipe);
+        return NULL;
+    }
+
+    wait_queue_init(&pipe->read_wait);
+    wait_queue_init(&pipe->write_wait);
+
+    return pipe;
+}
+
+void pipe_free(pipe_t *pipe)
+{
+    for (size_t i = 0; i < pipe->capacity / PAGE_SIZE; i++)
+    {
+        pmm_free((uint64_t *)(pipe->buffer + i * PAGE_SIZE));
+    }
+
+    kfree(pipe);
+}
+
+void pipe_open(pipe_t *pipe, bool write)
+{
+    uint64_t flags = cpu_irq_save();
+
+    if (write)
+    {
+        pipe->writers++;
+    }
+    else
+    {
+        pipe->readers++;
+    }
+
+    cpu_irq_restore(flags);
+}
+
+void pipe_close(pipe_t *pipe, bool write)
+{
+    uint64_t flags = cpu_irq_save();
+
+    // the other side has to notice the end of the file or the broken pipe
+    if (write)
+    {
+        if (--pipe->writers == 0)
+        {
+            wait_queue_wake_all(&pipe->read_wait);
+        }
+    }
+    else
+    {
+        if (--pipe->readers == 0)
+        {
+            wait_queue_wake_all(&pipe->write_wait);
+        }
+    }
+
+    bool unused = pipe->readers == 0 && pipe->writers == 0;
+    cpu_irq_restore(flags);
+
+    if (unused)
+    {
+        pipe_free(pipe);
+    }
+}
+
+// at most two copies, one up to the end of the buffer and one from its start
+static size_t pipe_copy_out(pipe_t *pipe, uint8_t *data, size_t size)
+{
+    if (size > pipe->used)
+    {
+        size = pipe->used;
+    }
+
+    size_t first = pipe->capacity - pipe->read_offset;
+    if (first > size)
+    {
+        first = size;
+    }
+
+    memcpy(data, pipe->buffer + pipe->read_offset, first);
+    memcpy(data + first, pipe->buffer, size - first);
+
+    pipe->read_offset = (pipe->read_offset + size) % pipe->capacity;
+    pipe->used -= size;
+
+    return size;
+}
+
+static size_t pipe_copy_in(pipe_t *pipe, const uint8_t *data, size_t size)
+{
+    if (size > pipe->capacity - pipe->used)
+    {
+        size = pipe->capacity - pipe->used;
+    }
+
+    size_t write_offset = (pipe->read_offset + pipe->used) % pipe->capacity;
+    size_t first = pipe->capacity - write_offset;
+    if (first > size)
+    {
+        first = size;
+    }
+
+    memcpy(pipe->buffer + write_offset, data, first);
+    memcpy(pipe->buffer, data + first, size - first);
+
+    pipe->used += size;
+
+    return size;
+}
+
+KRES pipe_read(pipe_t *pipe, uint8_t *data, size_t size, bool nonblock, size_t *bytes_read)
+{
+    *bytes_read = 0;
+    if (size == 0)
+    {
+        return RES_SUCCESS;
+    }
+
+    uint64_t flags = cpu_irq_save();
+
+    while (pipe->read_busy || pipe->used == 0)
+    {
+        if (!pipe->read_busy && pipe->writers == 0)
+        {
+            cpu_irq_restore(flags);
+            return RES_SUCCESS;
+        }
+
+        if (nonblock)
+        {
+            cpu_irq_restore(flags);
+            return -RES_WOULDBLOCK;
+        }
+
+        wait_queue_sleep(&pipe->read_wait, get_current_task());
+    }
+
+    *bytes_read = pipe_copy_out(pipe, data, size);
+    wait_queue_wake_all(&pipe->write_wait);
+
+    cpu_irq_restore(flags);
+    return RES_SUCCESS;
+}
+
+KRES pipe_write(pipe_t *pipe, const uint8_t *data, size_t size, bool nonblock, size_t *bytes_written)
+{
+    *bytes_written = 0;
+
+    uint64_t flags = cpu_irq_save();
+
+    while (*bytes_written < size)
+    {
+        if (pipe->readers == 0)
+        {
+            cpu_irq_restore(flags);
+            return *bytes_written ? RES_SUCCESS : -RES_UNAVAILABLE;
+        }
+
+        if (pipe->write_busy || pipe->used == pipe->capacity)
+        {
+            if (nonblock)
+            {
+                cpu_irq_restore(flags);
+                return *bytes_written ? RES_SUCCESS : -RES_WOULDBLOCK;
+            }
+
+            wait_queue_sleep(&pipe->write_wait, get_current_task());
+            continue;
+        }
+
+        *bytes_written += pipe_copy_in(pipe, data + *bytes_written, size - *bytes_written);
+        wait_queue_wake_all(&pipe->read_wait);
+    }
+
+    cpu_irq_restore(flags);
+    return RES_SUCCESS;
+}
+
+KRES pipe_splice_from(pipe_t *pipe, stream_t *in, const size_t *pos, size_t size, bool nonblock, size_t *moved)
+{
+    *moved = 0;
+    if (size == 0)
+    {
+        return RES_SUCCESS;
+    }
+
+    uint64_t flags = cpu_irq_save();
+
+    while (pipe->readers > 0 && (pipe->write_busy || pipe->used == pipe->capacity))
+    {
+        if (nonblock)
+        {
+            cpu_irq_restore(flags);
+            return -RES_WOULDBLOCK;
+        }
+
+        wait_queue_sleep(&pipe->write_wait, get_current_task());
+    }
+
+    if (pipe->readers == 0)
+    {
+        cpu_irq_restore(flags);
+        return -RES_UNAVAILABLE;
+    }
+
+    size_t write_offset = (pipe->read_offset + pipe->used) % pipe->capacity;
+    size_t length = pipe->capacity - pipe->used;
+    if (length > pipe->capacity - write_offset)
+    {
+        length = pipe->capacity - write_offset;
+    }
+    if (length > size)
+    {
+        length = size;
+    }
+
+    // the source may block, on another pipe or on a disk
+    pipe->write_busy = true;
+    cpu_irq_restore(flags);
+
+    size_t bytes_read = 0;
+    KRES res;
+    if (pos)
+    {
+        res = stream_pread(in, pipe->buffer + write_offset, length, *pos, &bytes_read);
+    }
+    else
+    {
+        res = stream_read(in, pipe->buffer + write_offset, length, &bytes_read);
+    }
+
+    flags = cpu_irq_save();
+    pipe->write_busy = false;
+    if (res >= 0)
+    {
+        pipe->used += bytes_read;
+        *moved = bytes_read;
+        wait_queue_wake_all(&pipe->read_wait);
+    }
+    wait_queue_wake_all(&pipe->write_wait);
+    cpu_irq_restore(flags);
+
+    return res;
+}
+
+KRES pipe_splice_to(pipe_t *pipe, stream_t *out, size_t size, bool nonblock, size_t *moved)
+{
+    *moved = 0;
+    if (size == 0)
+    {
+        return RES_SUCCESS;
+    }
+
+    uint64_t flags = cpu_irq_save();
+
+    while (pipe->read_busy || pipe->used == 0)
+    {
+        if (!pipe->read_busy && pipe->writers == 0)
+        {
+            cpu_irq_restore(flags);
+            return RES_SUCCESS;
+        }
+
+        if (nonblock)
+        {
+            cpu_irq_restore(flags);
+            return -RES_WOULDBLOCK;
+        }
+
+        wait_queue_sleep(&pipe->read_wait, get_current_task());
+    }
+
+    KRES res = RES_SUCCESS;
+    pipe->read_busy = true;
+
+    // at most two ranges, up to the end of the buffer and from its start
+    while (*moved < size && pipe->used > 0)
+    {
+        size_t length = pipe->used;
+        if (length > pipe->capacity - pipe->read_offset)
+        {
+            length = pipe->capacity - pipe->read_offset;
+        }
+        if (length > size - *moved)
+        {
+            length = size - *moved;
+        }
+
+        cpu_irq_restore(flags);
+
+        size_t bytes_written = 0;
+        res = stream_write(out, pipe->buffer + pipe->read_offset, length, &bytes_written);
+
+        flags = cpu_irq_save();
+        if (res < 0)
+        {
+            break;
+        }
+
+        pipe->read_offset = (pipe->read_offset + bytes_written) % pipe->capacity;
+        pipe->used -= bytes_written;
+        *moved += bytes_written;
+        wait_queue_wake_all(&pipe->write_wait);
+
+        if (bytes_written < length)
+        {
+            break;
+        }
+    }
+
+    pipe->read_busy = false;
+    wait_queue_wake_all(&pipe->read_wait);
+    cpu_irq_restore(flags);
+
+    return *moved ? RES_SUCCESS : res;
+}
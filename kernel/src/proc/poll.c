@@ -0,0 +1,127 @@
+#include <kernel/proc/poll.h>
+#include <kernel/kmm.h>
+#include <kernel/cpu.h>
+#include <kernel/time.h>
+#include <kernel/hrtimer.h>
+
+void poll_wait(poll_table_t *table, wait_queue_t *queue)
+{
+    // sized for one queue per stream, nothing registers more
+    if (!table || table->count == table->max)
+    {
+        return;
+    }
+
+    wait_entry_t *entry = &table->entries[table->count++];
+    if (table->func)
+    {
+        wait_queue_add_callback(queue, entry, table->func, table->data);
+    }
+    else
+    {
+        wait_queue_add(queue, entry, table->task);
+    }
+}
+
+void poll_table_release(poll_table_t *table)
+{
+    for (size_t i = 0; i < table->count; i++)
+    {
+        wait_queue_remove(&table->entries[i]);
+    }
+    table->count = 0;
+}
+
+static void poll_timeout(hrtimer_t *timer)
+{
+    task_wakeup((task_t *)timer->data);
+}
+
+bool poll_timeout_start(task_t *task, int64_t timeout_ns)
+{
+    hrtimer_init(&task->timeout, &poll_timeout, task);
+    return hrtimer_start(&task->timeout, time_get_ns() + (uint64_t)timeout_ns) >= 0;
+}
+
+int64_t poll_streams(task_t *task, stream_t **streams, poll_fd_t *fds, size_t count, int64_t timeout_ns)
+{
+    poll_table_t table = {
+        .task = task,
+        .func = NULL,
+        .data = NULL,
+        .entries = NULL,
+        .count = 0,
+        .max = count,
+    };
+
+    if (count > 0)
+    {
+        table.entries = kmalloc(count * sizeof(wait_entry_t));
+        if (!table.entries)
+        {
+            return -RES_NOMEM;
+        }
+    }
+
+    uint64_t deadline = time_get_ns() + (timeout_ns > 0 ? (uint64_t)timeout_ns : 0);
+
+    // the check and the queueing must not race with a wakeup
+    uint64_t flags = cpu_irq_save();
+
+    if (timeout_ns > 0 && !poll_timeout_start(task, timeout_ns))
+    {
+        cpu_irq_restore(flags);
+        kfree(table.entries);
+        return -RES_NOMEM;
+    }
+
+    int64_t ready;
+    for (;;)
+    {
+        ready = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            fds[i].revents = 0;
+            if (fds[i].fd < 0)
+            {
+                continue;
+            }
+
+            if (!streams[i])
+            {
+                fds[i].revents = POLLNVAL;
+                ready++;
+                continue;
+            }
+
+            // once something is ready there is no need to wait on the rest
+            uint32_t events = stream_poll(streams[i], ready ? NULL : &table);
+            fds[i].revents = (int16_t)(events & ((uint16_t)fds[i].events | POLLERR | POLLHUP));
+            if (fds[i].revents)
+            {
+                ready++;
+            }
+        }
+
+        if (ready || timeout_ns == 0 || (timeout_ns > 0 && time_get_ns() >= deadline))
+        {
+            break;
+        }
+
+        task->status = TASK_STATUS_BLOCKED;
+        schedule();
+
+        poll_table_release(&table);
+    }
+
+    poll_table_release(&table);
+    if (timeout_ns > 0)
+    {
+        hrtimer_cancel(&task->timeout);
+    }
+
+    cpu_irq_restore(flags);
+
+    kfree(table.entries);
+    return ready;
+}
@@ -1,40 +1,106 @@
 #include <kernel/proc/scheduler.h>
 #include <kernel/proc/task.h>
-#include <kernel/pit.h>
+#include <kernel/time.h>
+#include <kernel/string.h>
+#include <kernel/cpu.h>
 #include <kernel/kprintf.h>
 
-static void scheduler_handler(interrupt_frame_t *frame, uint32_t)
+static volatile bool resched = false;
+static uint64_t resched_time = 0;
+
+static sched_stats_t stats;
+
+static void scheduler_handler(interrupt_frame_t *frame)
 {
-    process_t *proc = get_current_process();
-    if (!proc)
+    if (!get_current_task())
     {
         return;
     }
 
-    // save state
-    proc->task.state.r15 = frame->r15;
-    proc->task.state.r14 = frame->r14;
-    proc->task.state.r13 = frame->r13;
-    proc->task.state.r12 = frame->r12;
-    proc->task.state.r11 = frame->r11;
-    proc->task.state.r10 = frame->r10;
-    proc->task.state.r9 = frame->r9;
-    proc->task.state.r8 = frame->r8;
-    proc->task.state.rsi = frame->rsi;
-    proc->task.state.rdi = frame->rdi;
-    proc->task.state.rbp = frame->rbp;
-    proc->task.state.rdx = frame->rdx;
-    proc->task.state.rcx = frame->rcx;
-    proc->task.state.rbx = frame->rbx;
-    proc->task.state.rax = frame->rax;
-    proc->task.state.rip = frame->rip;
-    proc->task.state.rsp = frame->rsp;
-
-    execute_next_process();
-    PANIC("failed to execute process");
+    if ((frame->cs & 3) == 3)
+    {
+        // interrupted user code, there is no kernel state to protect
+        schedule();
+    }
+    else
+    {
+        set_need_resched();
+    }
 }
 
 void scheduler_init(void)
 {
-    return register_pit_handler(&scheduler_handler);
+    memset(&stats, 0, sizeof(sched_stats_t));
+    return register_tick_handler(&scheduler_handler);
+}
+
+void set_need_resched(void)
+{
+    if (!resched)
+    {
+        resched_time = time_get_ns();
+        resched = true;
+    }
+}
+
+bool need_resched(void)
+{
+    return resched;
+}
+
+void cond_resched(void)
+{
+    if (resched)
+    {
+        schedule();
+    }
+}
+
+static void account_latency(sched_latency_t *latency, uint64_t ns)
+{
+    latency->count++;
+    latency->total_ns += ns;
+    if (ns > latency->max_ns)
+    {
+        latency->max_ns = ns;
+    }
+
+    uint64_t us = ns / 1000;
+    size_t bucket = 0;
+    while (bucket < SCHED_LATENCY_BUCKETS - 1 && us >= (2ULL << bucket))
+    {
+        bucket++;
+    }
+    latency->histogram[bucket]++;
+}
+
+// called by schedule with interrupts disabled
+void scheduler_account_switch(task_t *prev, task_t *next)
+{
+    uint64_t now = time_get_ns();
+
+    // only a running task can be preempted, ticks while idling do not count
+    if (resched && prev && prev->status == TASK_STATUS_READY)
+    {
+        account_latency(&stats.preempt, now - resched_time);
+    }
+    resched = false;
+
+    if (next->wake_time)
+    {
+        account_latency(&stats.wakeup, now - next->wake_time);
+        next->wake_time = 0;
+    }
+
+    if (prev != next)
+    {
+        stats.switches++;
+    }
+}
+
+void scheduler_get_stats(sched_stats_t *out)
+{
+    uint64_t flags = cpu_irq_save();
+    memcpy(out, &stats, sizeof(sched_stats_t));
+    cpu_irq_restore(flags);
 }
@@ -1,10 +1,13 @@
 #include <kernel/proc/stream.h>
 #include <kernel/kmm.h>
+#include <kernel/cpu.h>
 #include <kernel/string.h>
 #include <kernel/kprintf.h>
 #include <kernel/fs/vfs.h>
+#include <kernel/proc/pipe.h>
+#include <kernel/proc/epoll.h>
 
-stream_t *stream_create_bidirectional(uint8_t flags)
+stream_t *stream_create_pipe(pipe_t *pipe, uint8_t flags)
 {
     stream_t *stream = kmalloc(sizeof(stream_t));
     if (!stream)
@@ -13,28 +16,15 @@ stream_t *stream_create_bidirectional(uint8_t flags)
     }
 
     memset(stream, 0, sizeof(stream_t));
+    stream->refcount = 1;
 
-    stream->type = STREAM_TYPE_BIDIRECTIONAL;
+    stream->type = STREAM_TYPE_PIPE;
     stream->flags = flags;
-
-    stream->buffer = kmalloc(sizeof(shared_ring_buffer_t));
-    if (!stream->buffer)
-    {
-        return NULL;
-    }
-
-    stream->buffer->buffer = pmm_alloc();
-    if (!stream->buffer)
-    {
-        return NULL;
-    }
-    
-    stream->buffer->max_size = PAGE_SIZE;
-    stream->buffer->read_offset = 0;
-    stream->buffer->write_offset = 0;
-    stream->buffer->refcount = 1;
+    stream->pipe = pipe;
     stream->mount = NULL;
 
+    pipe_open(pipe, flags & STREAM_FLAG_WRITE);
+
     return stream;
 }
 
@@ -47,6 +37,7 @@ stream_t *stream_create_file(struct _file_node *node, mount_node_t *mount)
     }
 
     memset(stream, 0, sizeof(stream_t));
+    stream->refcount = 1;
 
     stream->type = STREAM_TYPE_FILE;
     stream->node = node;
@@ -64,6 +55,7 @@ stream_t *stream_create_driver(uint8_t flags, device_t *device, mount_node_t *mo
     }
 
     memset(stream, 0, sizeof(stream_t));
+    stream->refcount = 1;
 
     stream->type = STREAM_TYPE_DRIVER;
     stream->flags = flags;
@@ -74,51 +66,94 @@ stream_t *stream_create_driver(uint8_t flags, device_t *device, mount_node_t *mo
     return stream;
 }
 
+stream_t *stream_create_epoll(epoll_t *epoll)
+{
+    stream_t *stream = kmalloc(sizeof(stream_t));
+    if (!stream)
+    {
+        return NULL;
+    }
+
+    memset(stream, 0, sizeof(stream_t));
+    stream->refcount = 1;
+
+    stream->type = STREAM_TYPE_EPOLL;
+    stream->epoll = epoll;
+
+    return stream;
+}
+
+void stream_hold(stream_t *stream)
+{
+    uint64_t flags = cpu_irq_save();
+    stream->refcount++;
+    cpu_irq_restore(flags);
+}
+
 void stream_free(stream_t *stream)
 {
+    uint64_t flags = cpu_irq_save();
+    size_t refcount = --stream->refcount;
+    cpu_irq_restore(flags);
+
+    if (refcount > 0)
+    {
+        return;
+    }
+
+    // before the pipe or device goes away, the items are on its queues
+    epoll_forget(stream);
+
     switch (stream->type)
     {
-    case STREAM_TYPE_BIDIRECTIONAL:
-        stream->buffer->refcount -= 1;
-        if (stream->buffer->refcount <= 0)
-        {
-            pmm_free((uint64_t *)stream->buffer->buffer);
-            kfree(stream->buffer);
-        }
+    case STREAM_TYPE_PIPE:
+        pipe_close(stream->pipe, stream->flags & STREAM_FLAG_WRITE);
         break;
     case STREAM_TYPE_FILE:
         vfs_close(stream);
         break;
     case STREAM_TYPE_DRIVER:
         break;
+    case STREAM_TYPE_EPOLL:
+        epoll_put(stream->epoll);
+        break;
     default:
         PANIC("invalid stream type");
         break;
     }
+
+    kfree(stream);
 }
 
-int stream_read(stream_t *stream, uint8_t *data, size_t size, size_t *bytes_read)
+static int stream_do_read(stream_t *stream, uint8_t *data, size_t size, bool nonblock, size_t *bytes_read)
 {
     if (!stream || !data || !bytes_read)
     {
         return -RES_INVARG;
     }
 
-    memset(data, 0, size);
-
     *bytes_read = 0;
     switch (stream->type)
     {
-    case STREAM_TYPE_BIDIRECTIONAL:
-        for (size_t i = 0; i < size && stream->buffer->read_offset != stream->buffer->write_offset; i++)
+    case STREAM_TYPE_PIPE:
+        if (!(stream->flags & STREAM_FLAG_READ))
         {
-            data[i] = stream->buffer->buffer[stream->buffer->read_offset];
-            stream->buffer->read_offset = (stream->buffer->read_offset + 1) % stream->buffer->max_size;
-            (*bytes_read)++;
+            return -RES_INVARG;
         }
-        break;
+
+        return pipe_read(stream->pipe, data, size, nonblock, bytes_read);
     case STREAM_TYPE_FILE:
-        // TODO: maybe check for filesize and offset
+        // reads stop at the end of the file
+        if (stream->node->offset >= stream->node->filesize)
+        {
+            break;
+        }
+
+        if (size > stream->node->filesize - stream->node->offset)
+        {
+            size = stream->node->filesize - stream->node->offset;
+        }
+
         *bytes_read = size;
         int res = vfs_read(stream, size, data);
         if (res < 0)
@@ -160,7 +195,17 @@ int stream_read(stream_t *stream, uint8_t *data, size_t size, size_t *bytes_read
     return 0;
 }
 
-int stream_write(stream_t *stream, const uint8_t *data, size_t size, size_t *bytes_written)
+int stream_read(stream_t *stream, uint8_t *data, size_t size, size_t *bytes_read)
+{
+    return stream_do_read(stream, data, size, stream && (stream->flags & STREAM_FLAG_NONBLOCK), bytes_read);
+}
+
+int stream_read_nowait(stream_t *stream, uint8_t *data, size_t size, size_t *bytes_read)
+{
+    return stream_do_read(stream, data, size, true, bytes_read);
+}
+
+static int stream_do_write(stream_t *stream, const uint8_t *data, size_t size, bool nonblock, size_t *bytes_written)
 {
     if (!stream || !data || !bytes_written)
     {
@@ -170,21 +215,13 @@ int stream_write(stream_t *stream, const uint8_t *data, size_t size, size_t *byt
     *bytes_written = 0;
     switch (stream->type)
     {
-    case STREAM_TYPE_BIDIRECTIONAL:
-        for (size_t i = 0; i < size; i++)
+    case STREAM_TYPE_PIPE:
+        if (!(stream->flags & STREAM_FLAG_WRITE))
         {
-            stream->buffer->buffer[stream->buffer->write_offset] = data[i];
-            stream->buffer->write_offset = (stream->buffer->write_offset + 1) % stream->buffer->max_size;
-            (*bytes_written)++;
-        }
-        
-        // TODO: this is a suboptimal way to do this as it will leave artifacts after an overflow
-        if (stream->buffer->write_offset == stream->buffer->read_offset && *bytes_written > 0)
-        {
-            stream->buffer->buffer[stream->buffer->write_offset] = 0;
-            stream->buffer->write_offset = (stream->buffer->write_offset + 1) % stream->buffer->max_size;
+            return -RES_INVARG;
         }
-        break;
+
+        return pipe_write(stream->pipe, data, size, nonblock, bytes_written);
     case STREAM_TYPE_FILE:
         *bytes_written = size;
         int res = vfs_write(stream, size, data);
@@ -198,18 +235,16 @@ int stream_write(stream_t *stream, const uint8_t *data, size_t size, size_t *byt
         switch (stream->device->type)
         {
         case DEVICE_CHAR:
-            for (size_t i = 0; i < size; i++)
+        {
+            int res = device_write_buffer((const char *)data, size, CHARDEV_COLOR_WHITE, CHARDEV_COLOR_BLACK, stream->device);
+            if (res < 0)
             {
-                int res = device_write((char)data[i], CHARDEV_COLOR_WHITE, CHARDEV_COLOR_BLACK, stream->device);
-                if (res < 0)
-                {
-                    return res;
-                }
-
-                (*bytes_written)++;
+                return res;
             }
 
+            *bytes_written = size;
             break;
+        }
         case DEVICE_BLOCK:
             // TODO: implement
             break;
@@ -227,13 +262,162 @@ int stream_write(stream_t *stream, const uint8_t *data, size_t size, size_t *byt
     return 0;
 }
 
-int stream_flush(stream_t *stream)
+int stream_write(stream_t *stream, const uint8_t *data, size_t size, size_t *bytes_written)
+{
+    return stream_do_write(stream, data, size, stream && (stream->flags & STREAM_FLAG_NONBLOCK), bytes_written);
+}
+
+int stream_write_nowait(stream_t *stream, const uint8_t *data, size_t size, size_t *bytes_written)
+{
+    return stream_do_write(stream, data, size, true, bytes_written);
+}
+
+// positional io only exists for files, the offset of the stream is neither used nor moved
+int stream_pread(stream_t *stream, uint8_t *data, size_t size, size_t offset, size_t *bytes_read)
+{
+    if (!stream || stream->type != STREAM_TYPE_FILE || !data || !bytes_read)
+    {
+        return -RES_INVARG;
+    }
+
+    // reads stop at the end of the file
+    *bytes_read = 0;
+    if (offset >= stream->node->filesize)
+    {
+        return 0;
+    }
+
+    if (size > stream->node->filesize - offset)
+    {
+        size = stream->node->filesize - offset;
+    }
+
+    if (vfs_pread(stream, offset, size, data) < 0)
+    {
+        return -RES_EUNKNOWN;
+    }
+
+    *bytes_read = size;
+    return 0;
+}
+
+int stream_pwrite(stream_t *stream, const uint8_t *data, size_t size, size_t offset, size_t *bytes_written)
+{
+    if (!stream || stream->type != STREAM_TYPE_FILE || !data || !bytes_written)
+    {
+        return -RES_INVARG;
+    }
+
+    *bytes_written = 0;
+    if (vfs_pwrite(stream, offset, size, data) < 0)
+    {
+        return -RES_EUNKNOWN;
+    }
+
+    *bytes_written = size;
+    return 0;
+}
+
+int stream_splice(stream_t *in, stream_t *out, const size_t *pos, size_t size, uint8_t *bounce, size_t *moved)
+{
+    if (!in || !out || !moved || (pos && in->type != STREAM_TYPE_FILE))
+    {
+        return -RES_INVARG;
+    }
+
+    *moved = 0;
+    if (in->type == STREAM_TYPE_PIPE)
+    {
+        if (!(in->flags & STREAM_FLAG_READ))
+        {
+            return -RES_INVARG;
+        }
+
+        return pipe_splice_to(in->pipe, out, size, in->flags & STREAM_FLAG_NONBLOCK, moved);
+    }
+
+    if (out->type == STREAM_TYPE_PIPE)
+    {
+        if (!(out->flags & STREAM_FLAG_WRITE))
+        {
+            return -RES_INVARG;
+        }
+
+        return pipe_splice_from(out->pipe, in, pos, size, out->flags & STREAM_FLAG_NONBLOCK, moved);
+    }
+
+    if (!bounce)
+    {
+        return -RES_INVARG;
+    }
+
+    size_t bytes_read = 0;
+    int res = pos ? stream_pread(in, bounce, size, *pos, &bytes_read) : stream_read(in, bounce, size, &bytes_read);
+    if (res < 0 || bytes_read == 0)
+    {
+        return res;
+    }
+
+    return stream_write(out, bounce, bytes_read, moved);
+}
+
+uint32_t stream_poll(stream_t *stream, poll_table_t *table)
 {
-    if (stream->type == STREAM_TYPE_BIDIRECTIONAL)
+    switch (stream->type)
+    {
+    case STREAM_TYPE_PIPE:
     {
-        stream->buffer->read_offset = stream->buffer->write_offset;
+        pipe_t *pipe = stream->pipe;
+        uint32_t events = 0;
+        if (stream->flags & STREAM_FLAG_READ)
+        {
+            poll_wait(table, &pipe->read_wait);
+            if (pipe->used > 0)
+            {
+                events |= POLLIN;
+            }
+            if (pipe->writers == 0)
+            {
+                events |= POLLHUP;
+            }
+        }
+        else
+        {
+            poll_wait(table, &pipe->write_wait);
+            if (pipe->used < pipe->capacity)
+            {
+                events |= POLLOUT;
+            }
+            if (pipe->readers == 0)
+            {
+                events |= POLLERR;
+            }
+        }
+        return events;
     }
+    case STREAM_TYPE_FILE:
+        return POLLIN | POLLOUT; // files never block
+    case STREAM_TYPE_DRIVER:
+        switch (stream->device->type)
+        {
+        case DEVICE_INPUT:
+            poll_wait(table, &stream->device->wait);
+            return device_has_data(stream->device) ? POLLIN : 0;
+        case DEVICE_NET:
+            poll_wait(table, &stream->device->wait);
+            return POLLOUT | (device_has_data(stream->device) ? POLLIN : 0);
+        default:
+            return POLLIN | POLLOUT;
+        }
+    case STREAM_TYPE_EPOLL:
+        return epoll_poll(stream->epoll, table);
+    default:
+        return POLLNVAL;
+    }
+}
 
+int stream_flush(stream_t *)
+{
     return 0;
 }
 
@@ -246,30 +430,29 @@ stream_t *stream_clone(stream_t *src)
 
     switch(src->type)
     {
-    case STREAM_TYPE_BIDIRECTIONAL:
+    case STREAM_TYPE_PIPE:
+        return stream_create_pipe(src->pipe, src->flags);
+    case STREAM_TYPE_FILE:
     {
-        stream_t *dest = kmalloc(sizeof(stream_t));
-        if (!dest)
+        stream_t *dest = stream_create_file(src->node, src->mount);
+        if (dest)
         {
-            return NULL;
+            vfs_hold(src->node);
         }
-
-        memset(dest, 0, sizeof(stream_t));
-
-        dest->type = src->type;
-        dest->flags = src->flags;
-        dest->buffer = src->buffer;
-        dest->buffer->refcount += 1;
-        dest->buffer->max_size = src->buffer->max_size;
-        dest->buffer->read_offset = src->buffer->read_offset;
-        dest->buffer->write_offset = src->buffer->write_offset;
-
         return dest;
     }
-    case STREAM_TYPE_FILE:
-        return stream_create_file(src->node, src->mount);
     case STREAM_TYPE_DRIVER:
         return stream_create_driver(src->flags, src->device, src->mount);
+    case STREAM_TYPE_EPOLL:
+    {
+        // the copy shares the instance, like the pipe ends share their pipe
+        stream_t *dest = stream_create_epoll(src->epoll);
+        if (dest)
+        {
+            epoll_hold(src->epoll);
+        }
+        return dest;
+    }
     default:
         return NULL;
     }
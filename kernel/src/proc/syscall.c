@@ -8,6 +8,19 @@
 #include <kernel/dev/devm.h>
 #include <kernel/isr.h>
 #include <kernel/kmm.h>
+#include <kernel/time.h>
+#include <kernel/hrtimer.h>
+#include <kernel/cpu.h>
+#include <kernel/proc/scheduler.h>
+#include <kernel/proc/futex.h>
+#include <kernel/proc/uaccess.h>
+#include <kernel/proc/ioring.h>
+#include <kernel/proc/pipe.h>
+#include <kernel/proc/poll.h>
+#include <kernel/proc/epoll.h>
+#include <kernel/proc/systrace.h>
+#include <kernel/fs/pcache.h>
+#include <kernel/proc/syscall_table.h>
 
 static void *process_get_pointer(process_t *proc, uintptr_t vaddr)
 {
@@ -24,318 +37,1227 @@ static void *process_get_pointer(process_t *proc, uintptr_t vaddr)
 #define DRIVER_TYPE_CHARDEV 0
 #define DRIVER_TYPE_INPUTDEV 1
 
+// io goes through a kernel buffer of this size, so long disk transfers also reach a safe point every chunk
+#define SYSCALL_IO_CHUNK_SIZE (64 * 1024)
+#define SYSCALL_IO_SMALL_SIZE 256 // handled on the stack
+
+#define SYSCALL_IOV_MAX 1024 // entries per readv or writev
+
+#define SYSCALL_MAX_STRING 4096 // arguments and environment variables
+
+static size_t bounce_size(size_t size)
+{
+    if (size <= SYSCALL_IO_SMALL_SIZE)
+    {
+        return SYSCALL_IO_SMALL_SIZE;
+    }
+
+    return size < SYSCALL_IO_CHUNK_SIZE ? size : SYSCALL_IO_CHUNK_SIZE;
+}
+
+// small requests use the buffer on the caller's stack, everything else gets at most one chunk
+static uint8_t *bounce_alloc(uint8_t *small, size_t size)
+{
+    if (size <= SYSCALL_IO_SMALL_SIZE)
+    {
+        return small;
+    }
+
+    return kmalloc(bounce_size(size));
+}
+
+static void bounce_free(uint8_t *bounce, uint8_t *small)
+{
+    if (bounce != small)
+    {
+        kfree(bounce);
+    }
+}
+
+// offset is NULL for the stream position, otherwise it is advanced by the bytes moved
+static int64_t read_to_user(process_t *proc, stream_t *s, uintptr_t data, size_t size, size_t *offset, bool nowait, uint8_t *bounce, size_t chunk_size, bool *partial)
+{
+    int res = RES_SUCCESS;
+    size_t total = 0;
+    *partial = false;
+    while (total < size)
+    {
+        size_t chunk = size - total < chunk_size ? size - total : chunk_size;
+        size_t bytes_read = 0;
+        if (offset)
+        {
+            res = stream_pread(s, bounce, chunk, *offset, &bytes_read);
+        }
+        else
+        {
+            res = nowait ? stream_read_nowait(s, bounce, chunk, &bytes_read) : stream_read(s, bounce, chunk, &bytes_read);
+        }
+        if (res < 0)
+        {
+            break;
+        }
+
+        res = copy_to_user(proc, data + total, bounce, bytes_read);
+        if (res < 0)
+        {
+            break;
+        }
+
+        total += bytes_read;
+        if (offset)
+        {
+            *offset += bytes_read;
+        }
+
+        // only files are read until the request is filled, everything else returns what is there
+        if (bytes_read < chunk || s->type != STREAM_TYPE_FILE)
+        {
+            *partial = total < size;
+            break;
+        }
+
+        cond_resched();
+    }
+
+    if (res < 0)
+    {
+        *partial = true;
+    }
+
+    return (total || res >= 0) ? (int64_t)total : res;
+}
+
+static int64_t write_from_user(process_t *proc, stream_t *s, uintptr_t data, size_t size, size_t *offset, bool nowait, uint8_t *bounce, size_t chunk_size, bool *partial)
+{
+    int res = RES_SUCCESS;
+    size_t total = 0;
+    *partial = false;
+    while (total < size)
+    {
+        size_t chunk = size - total < chunk_size ? size - total : chunk_size;
+        res = copy_from_user(proc, bounce, data + total, chunk);
+        if (res < 0)
+        {
+            break;
+        }
+
+        size_t bytes_written = 0;
+        if (offset)
+        {
+            res = stream_pwrite(s, bounce, chunk, *offset, &bytes_written);
+        }
+        else
+        {
+            res = nowait ? stream_write_nowait(s, bounce, chunk, &bytes_written) : stream_write(s, bounce, chunk, &bytes_written);
+        }
+        if (res < 0)
+        {
+            break;
+        }
+
+        total += bytes_written;
+        if (offset)
+        {
+            *offset += bytes_written;
+        }
+
+        if (bytes_written < chunk)
+        {
+            *partial = true;
+            break;
+        }
+
+        cond_resched();
+    }
+
+    if (res < 0)
+    {
+        *partial = true;
+    }
+
+    return (total || res >= 0) ? (int64_t)total : res;
+}
+
+static int64_t do_read(process_t *proc, int64_t stream, int64_t data, int64_t size, size_t *offset, bool nowait)
+{
+    stream_t *s = process_get_stream(proc, stream);
+    if (!s || size < 0)
+    {
+        return -RES_INVARG;
+    }
+
+    uint8_t small[SYSCALL_IO_SMALL_SIZE];
+    uint8_t *bounce = bounce_alloc(small, (size_t)size);
+    if (!bounce)
+    {
+        return -RES_NOMEM;
+    }
+
+    bool partial;
+    int64_t res = read_to_user(proc, s, (uintptr_t)data, (size_t)size, offset, nowait, bounce, bounce_size((size_t)size), &partial);
+
+    bounce_free(bounce, small);
+    return res;
+}
+
+static int64_t do_write(process_t *proc, int64_t stream, int64_t data, int64_t size, size_t *offset, bool nowait)
+{
+    stream_t *s = process_get_stream(proc, stream);
+    if (!s || size < 0)
+    {
+        return -RES_INVARG;
+    }
+
+    uint8_t small[SYSCALL_IO_SMALL_SIZE];
+    uint8_t *bounce = bounce_alloc(small, (size_t)size);
+    if (!bounce)
+    {
+        return -RES_NOMEM;
+    }
+
+    bool partial;
+    int64_t res = write_from_user(proc, s, (uintptr_t)data, (size_t)size, offset, nowait, bounce, bounce_size((size_t)size), &partial);
+
+    bounce_free(bounce, small);
+    return res;
+}
+
 int64_t syscall_read(process_t *proc, int64_t stream, int64_t data, int64_t size, int64_t, int64_t, int64_t, task_state_t *)
 {
-    uint8_t *buf = (uint8_t *)process_get_pointer(proc, data);
-    if (!buf)
+    return do_read(proc, stream, data, size, NULL, false);
+}
+
+int64_t syscall_write(process_t *proc, int64_t stream, int64_t data, int64_t size, int64_t, int64_t, int64_t, task_state_t *)
+{
+    return do_write(proc, stream, data, size, NULL, false);
+}
+
+int64_t syscall_pread(process_t *proc, int64_t stream, int64_t data, int64_t size, int64_t offset, int64_t, int64_t, task_state_t *)
+{
+    if (offset < 0)
+    {
+        return -RES_INVARG;
+    }
+
+    size_t pos = (size_t)offset;
+    return do_read(proc, stream, data, size, &pos, false);
+}
+
+int64_t syscall_pwrite(process_t *proc, int64_t stream, int64_t data, int64_t size, int64_t offset, int64_t, int64_t, task_state_t *)
+{
+    if (offset < 0)
+    {
+        return -RES_INVARG;
+    }
+
+    size_t pos = (size_t)offset;
+    return do_write(proc, stream, data, size, &pos, false);
+}
+
+// iovec arrays are copied in batches of this many entries
+#define SYSCALL_IOV_BATCH 16
+
+// sums the lengths so the bounce buffer can be sized once for the whole call
+static int64_t iov_total(process_t *proc, uintptr_t iov, size_t count, size_t *total)
+{
+    iovec_t vecs[SYSCALL_IOV_BATCH];
+
+    *total = 0;
+    for (size_t i = 0; i < count; i += SYSCALL_IOV_BATCH)
+    {
+        size_t n = count - i < SYSCALL_IOV_BATCH ? count - i : SYSCALL_IOV_BATCH;
+        int res = copy_from_user(proc, vecs, iov + i * sizeof(iovec_t), n * sizeof(iovec_t));
+        if (res < 0)
+        {
+            return res;
+        }
+
+        for (size_t j = 0; j < n; j++)
+        {
+            if (vecs[j].len > INT64_MAX - *total)
+            {
+                return -RES_OVERFLOW;
+            }
+            *total += vecs[j].len;
+        }
+    }
+
+    return RES_SUCCESS;
+}
+
+static int64_t do_vectored(process_t *proc, int64_t stream, int64_t _iov, int64_t count, bool write)
+{
+    stream_t *s = process_get_stream(proc, stream);
+    if (!s || count < 0 || count > SYSCALL_IOV_MAX)
+    {
+        return -RES_INVARG;
+    }
+
+    size_t size;
+    int64_t res = iov_total(proc, (uintptr_t)_iov, (size_t)count, &size);
+    if (res < 0)
+    {
+        return res;
+    }
+
+    uint8_t small[SYSCALL_IO_SMALL_SIZE];
+    uint8_t *bounce = bounce_alloc(small, size);
+    if (!bounce)
+    {
+        return -RES_NOMEM;
+    }
+
+    // the array is copied again batch by batch while the data moves
+    size_t chunk_size = bounce_size(size);
+    iovec_t vecs[SYSCALL_IOV_BATCH];
+    size_t total = 0;
+    res = RES_SUCCESS;
+    for (size_t i = 0; i < (size_t)count; i++)
+    {
+        if (i % SYSCALL_IOV_BATCH == 0)
+        {
+            size_t n = (size_t)count - i < SYSCALL_IOV_BATCH ? (size_t)count - i : SYSCALL_IOV_BATCH;
+            res = copy_from_user(proc, vecs, (uintptr_t)_iov + i * sizeof(iovec_t), n * sizeof(iovec_t));
+            if (res < 0)
+            {
+                break;
+            }
+        }
+
+        iovec_t *vec = &vecs[i % SYSCALL_IOV_BATCH];
+        if (vec->len == 0)
+        {
+            continue;
+        }
+
+        bool partial;
+        if (write)
+        {
+            res = write_from_user(proc, s, (uintptr_t)vec->base, vec->len, NULL, false, bounce, chunk_size, &partial);
+        }
+        else
+        {
+            res = read_to_user(proc, s, (uintptr_t)vec->base, vec->len, NULL, false, bounce, chunk_size, &partial);
+        }
+
+        if (res < 0)
+        {
+            break;
+        }
+
+        total += (size_t)res;
+        if (partial)
+        {
+            break;
+        }
+    }
+
+    bounce_free(bounce, small);
+    return (total || res >= 0) ? (int64_t)total : res;
+}
+
+int64_t syscall_readv(process_t *proc, int64_t stream, int64_t iov, int64_t count, int64_t, int64_t, int64_t, task_state_t *)
+{
+    return do_vectored(proc, stream, iov, count, false);
+}
+
+int64_t syscall_writev(process_t *proc, int64_t stream, int64_t iov, int64_t count, int64_t, int64_t, int64_t, task_state_t *)
+{
+    return do_vectored(proc, stream, iov, count, true);
+}
+
+// moves data between two streams without going through user space
+// an offset reads the input file from there and leaves its position alone, like pread
+int64_t syscall_splice(process_t *proc, int64_t in, int64_t out, int64_t size, int64_t _offset, int64_t, int64_t, task_state_t *)
+{
+    stream_t *in_stream = process_get_stream(proc, in);
+    stream_t *out_stream = process_get_stream(proc, out);
+    if (!in_stream || !out_stream || in_stream == out_stream || size < 0)
+    {
+        return -RES_INVARG;
+    }
+
+    // an explicit offset is a private cursor, the offset of the stream is shared with clones and other threads
+    int64_t offset = 0;
+    size_t pos = 0;
+    if (_offset)
+    {
+        if (in_stream->type != STREAM_TYPE_FILE)
+        {
+            return -RES_INVARG;
+        }
+
+        int res = copy_from_user(proc, &offset, (uintptr_t)_offset, sizeof(offset));
+        if (res < 0)
+        {
+            return res;
+        }
+
+        if (offset < 0)
+        {
+            return -RES_INVARG;
+        }
+
+        pos = (size_t)offset;
+    }
+
+    // a pipe on either side is the buffer, everything else goes through one in the kernel
+    uint8_t small[SYSCALL_IO_SMALL_SIZE];
+    uint8_t *bounce = NULL;
+    size_t chunk_size = SYSCALL_IO_CHUNK_SIZE;
+    if (in_stream->type != STREAM_TYPE_PIPE && out_stream->type != STREAM_TYPE_PIPE)
+    {
+        bounce = bounce_alloc(small, (size_t)size);
+        if (!bounce)
+        {
+            return -RES_NOMEM;
+        }
+        chunk_size = bounce_size((size_t)size);
+    }
+
+    int res = RES_SUCCESS;
+    size_t total = 0;
+    while (total < (size_t)size)
+    {
+        size_t chunk = (size_t)size - total < chunk_size ? (size_t)size - total : chunk_size;
+        size_t moved = 0;
+        res = stream_splice(in_stream, out_stream, _offset ? &pos : NULL, chunk, bounce, &moved);
+        if (res < 0 || moved == 0)
+        {
+            break;
+        }
+
+        total += moved;
+        pos += moved;
+
+        // only files are read until the request is filled, everything else returns what is there
+        if (in_stream->type != STREAM_TYPE_FILE)
+        {
+            break;
+        }
+
+        cond_resched();
+    }
+
+    if (bounce)
+    {
+        bounce_free(bounce, small);
+    }
+
+    if (_offset)
+    {
+        offset = (int64_t)pos;
+
+        int copy_res = copy_to_user(proc, (uintptr_t)_offset, &offset, sizeof(offset));
+        if (copy_res < 0 && res >= 0)
+        {
+            res = copy_res;
+        }
+    }
+
+    return (total || res >= 0) ? (int64_t)total : res;
+}
+
+int64_t syscall_fork(process_t *proc, int64_t, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    process_t *fork = process_clone(proc, get_current_task()); // TODO: maybe the file changed
+    if (!fork)
+    {
+        PANIC("failed to fork process");
+    }
+
+    fork->task.state.rax = 0; // return value
+
+    if (process_register(fork) < 0)
+    {
+        PANIC("failed to register process");
+    }
+
+    return fork->pid;
+}
+
+int64_t syscall_exit(process_t *proc, int64_t, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    process_exit(proc);
+
+    return 0;
+}
+
+int64_t syscall_ping(process_t *, int64_t pid, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    if (get_process_from_pid((uint64_t)pid) != NULL)
+    {
+        return pid;
+    }
+
+    return 0;
+}
+
+// copies a user array of strings into the kernel
+static char **strings_from_user(process_t *proc, uintptr_t array, size_t count)
+{
+    char **strings = kmalloc((count ? count : 1) * sizeof(char *));
+    if (!strings)
+    {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uintptr_t string;
+        if (copy_from_user(proc, &string, array + i * sizeof(uintptr_t), sizeof(string)) < 0 || !(strings[i] = strdup_from_user(proc, string, SYSCALL_MAX_STRING)))
+        {
+            for (size_t j = 0; j < i; j++)
+            {
+                kfree(strings[j]);
+            }
+            kfree(strings);
+            return NULL;
+        }
+    }
+
+    return strings;
+}
+
+// builds a new process from the create info of proc, NULL on failure
+static process_t *process_create_from_info(process_t *proc, uintptr_t _path, uintptr_t _create_info)
+{
+    char path[MAX_PATH];
+    if (strncpy_from_user(proc, path, _path, MAX_PATH) < 0)
+    {
+        return NULL;
+    }
+
+    process_create_info_t create_info;
+    if (copy_from_user(proc, &create_info, _create_info, sizeof(create_info)) < 0)
+    {
+        return NULL;
+    }
+
+    stream_t *stdin = process_get_stream(proc, (int64_t)create_info.stdin_idx);
+    stream_t *stdout = process_get_stream(proc, (int64_t)create_info.stdout_idx);
+    stream_t *stderr = process_get_stream(proc, (int64_t)create_info.stderr_idx);
+    if (!stdin || !stdout || !stderr)
+    {
+        return NULL;
+    }
+
+    if (create_info.num_args > UINT16_MAX || create_info.num_envars > UINT16_MAX)
+    {
+        return NULL;
+    }
+
+    process_t *exec = process_create(path);
+    if (!exec)
+    {
+        return NULL;
+    }
+
+    // the process owns the arrays once they are set, process_free takes care of them from then on
+    char **arguments = strings_from_user(proc, (uintptr_t)create_info.args, create_info.num_args);
+    if (!arguments)
+    {
+        goto error;
+    }
+    process_set_args(exec, arguments, create_info.num_args);
+
+    char **environment_variables = strings_from_user(proc, (uintptr_t)create_info.envars, create_info.num_envars);
+    if (!environment_variables)
+    {
+        goto error;
+    }
+    process_set_envars(exec, environment_variables, create_info.num_envars);
+
+    if (process_set_stdin(exec, stdin) < 0 || process_set_stdout(exec, stdout) < 0 || process_set_stderr(exec, stderr) < 0)
+    {
+        goto error;
+    }
+
+    if (setup_initial_stack(exec) < 0)
+    {
+        goto error;
+    }
+
+    return exec;
+
+error:
+    process_free(exec);
+    return NULL;
+}
+
+int64_t syscall_exec(process_t *proc, int64_t _path, int64_t _create_info, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    process_t *exec = process_create_from_info(proc, (uintptr_t)_path, (uintptr_t)_create_info);
+    if (!exec)
+    {
+        return -RES_EUNKNOWN;
+    }
+
+    exec->pid = proc->pid;
+
+    // a successful exec never returns to the handler, so it is traced here before the trace moves on
+    if (proc->syscall_trace)
+    {
+        const int64_t args[6] = {_path, _create_info, 0, 0, 0, 0};
+        systrace_record(proc, SYSCALL_EXEC, args, 0, get_current_task()->syscall_tsc, cpu_read_tsc());
+    }
+
+    // same pid, so the trace carries over
+    exec->syscall_trace = proc->syscall_trace;
+    proc->syscall_trace = NULL;
+
+    if (IS_ERROR(process_register(exec)))
+    {
+        PANIC("failed to register process");
+    }
+
+    // we are still running on the kernel stack of proc
+    process_exit(proc);
+
+    return 0;
+}
+
+// like fork + exec, but the child is built directly instead of copying the parent first
+int64_t syscall_spawn(process_t *proc, int64_t _path, int64_t _create_info, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    process_t *spawn = process_create_from_info(proc, (uintptr_t)_path, (uintptr_t)_create_info);
+    if (!spawn)
+    {
+        return -RES_EUNKNOWN;
+    }
+
+    if (systrace_inherit(spawn, proc) < 0)
+    {
+        process_free(spawn);
+        return -RES_NOMEM;
+    }
+
+    if (IS_ERROR(process_register(spawn)))
+    {
+        PANIC("failed to register process");
+    }
+
+    return (int64_t)spawn->pid;
+}
+
+int64_t syscall_alloc(process_t *proc, int64_t, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    return (int64_t)process_allocate_page(proc);
+}
+
+int64_t syscall_open(process_t *proc, int64_t _path, int64_t _open_actions, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    char path[MAX_PATH];
+    if (strncpy_from_user(proc, path, (uintptr_t)_path, MAX_PATH) < 0)
+    {
+        return -RES_INVARG;
+    }
+
+    return process_insert_file(proc, path, (uint8_t)_open_actions);
+}
+
+int64_t syscall_close(process_t *proc, int64_t stream, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    if (!process_get_stream(proc, stream))
+    {
+        return -RES_INVARG;
+    }
+
+    process_remove_stream(proc, (size_t)stream);
+    return 0;
+}
+
+int64_t syscall_video_get_display_rect(process_t *proc, int64_t display_id, int64_t _rect, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    video_rect_t rect;
+    if (copy_from_user(proc, &rect, (uintptr_t)_rect, sizeof(rect)) < 0)
+    {
+        return -RES_INVARG;
+    }
+
+    device_t *dev = get_device_by_type(DEVICE_VIDEO, 0);
+    if (!dev)
+    {
+        return -RES_INVARG;
+    }
+
+    int status = device_get_display_rect(&rect, display_id, dev);
+    if (status < 0)
+    {
+        return status;
+    }
+
+    return copy_to_user(proc, (uintptr_t)_rect, &rect, sizeof(rect));
+}
+
+int64_t syscall_video_create_framebuffer(process_t *proc, int64_t display_id, int64_t _rect, int64_t _vaddr, int64_t, int64_t, int64_t, task_state_t *)
+{
+    video_rect_t rect;
+    if (copy_from_user(proc, &rect, (uintptr_t)_rect, sizeof(rect)) < 0)
+    {
+        return -RES_INVARG;
+    }
+
+    device_t *dev = get_device_by_type(DEVICE_VIDEO, 0);
+    if (!dev)
+    {
+        return -RES_INVARG;
+    }
+
+    uint32_t *fb = device_create_framebuffer(&rect, display_id, dev);
+    if (!fb)
+    {
+        return -RES_EUNKNOWN;
+    }
+
+    size_t num_pages = (get_framebuffer_size(&rect) + PAGE_SIZE - 1) / PAGE_SIZE;
+    if (_vaddr < 0x900000 || _vaddr > 0x1000000)
+    {
+        return -RES_ACCESS_DENIED;
+    }
+
+    for (size_t i = 0; i < num_pages; i++)
+    {
+        if (pml4_get_phys(proc->pml4, (void *)((uintptr_t)_vaddr + PAGE_SIZE * i), false) != 0)
+        {
+            return -RES_ACCESS_DENIED;
+        }
+    }
+
+    int status = pml4_map_range(proc->pml4, (void *)_vaddr, fb, num_pages, PAGE_PRESENT | PAGE_WRITABLE | PAGE_USER);
+
+    return status;
+}
+
+int64_t syscall_video_update_display(process_t *proc, int64_t _fb, int64_t _rect, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    video_rect_t rect;
+    if (copy_from_user(proc, &rect, (uintptr_t)_rect, sizeof(rect)) < 0)
     {
-        return -RES_EUNKNOWN;
+        return -RES_INVARG;
     }
 
-    size_t bytes_read = 0;
-    int res = stream_read(proc->streams[stream], buf, size, &bytes_read);
-    if (res < 0)
+    // the framebuffer is mapped from contiguous device memory, so its first frame is enough
+    uint32_t *fb = process_get_pointer(proc, (uintptr_t)_fb);
+    if (!fb)
     {
-        return res;
+        return -RES_INVARG;
+    }
+
+    device_t *dev = get_device_by_type(DEVICE_VIDEO, 0);
+    if (!dev)
+    {
+        return -RES_INVARG;
     }
 
-    return (int64_t)bytes_read;
+    int status = device_update_display(&rect, fb, dev);
+    return status;
 }
 
-int64_t syscall_write(process_t *proc, int64_t stream, int64_t data, int64_t size, int64_t, int64_t, int64_t, task_state_t *)
+int64_t syscall_pipe(process_t *proc, int64_t _fds, int64_t capacity, int64_t, int64_t, int64_t, int64_t, task_state_t *)
 {
-    uint8_t *buf = (uint8_t *)process_get_pointer(proc, data);
-    if (!buf)
+    if (capacity < 0 || capacity > PIPE_MAX_CAPACITY)
     {
-        return -RES_EUNKNOWN;
+        return -RES_INVARG;
     }
 
-    size_t bytes_written = 0;
-    int res = stream_write(proc->streams[stream], buf, size, &bytes_written);
-    if (res < 0)
+    pipe_t *pipe = pipe_create((size_t)capacity);
+    if (!pipe)
     {
-        return res;
+        return -RES_NOMEM;
     }
 
-    return (int64_t)bytes_written;
-}
+    stream_t *read_end = stream_create_pipe(pipe, STREAM_FLAG_READ);
+    if (!read_end)
+    {
+        pipe_free(pipe);
+        return -RES_NOMEM;
+    }
 
-int64_t syscall_fork(process_t *proc, int64_t, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
-{
-    process_t *fork = process_clone(proc); // TODO: maybe the file changed
-    if (!fork)
+    stream_t *write_end = stream_create_pipe(pipe, STREAM_FLAG_WRITE);
+    if (!write_end)
     {
-        PANIC("failed to fork process");
+        stream_free(read_end); // takes the pipe with it
+        return -RES_NOMEM;
     }
 
-    fork->task.state.rax = 0; // return value
+    int64_t read_index = process_insert_stream(proc, read_end);
+    if (read_index < 0)
+    {
+        stream_free(read_end);
+        stream_free(write_end);
+        return read_index;
+    }
 
-    if (process_register(fork) < 0)
+    int64_t write_index = process_insert_stream(proc, write_end);
+    if (write_index < 0)
     {
-        PANIC("failed to register process");
+        process_remove_stream(proc, (size_t)read_index);
+        stream_free(write_end);
+        return write_index;
     }
 
-    return fork->pid;
+    int32_t fds[2] = {(int32_t)read_index, (int32_t)write_index};
+
+    int res = copy_to_user(proc, (uintptr_t)_fds, fds, sizeof(fds));
+    if (res < 0)
+    {
+        process_remove_stream(proc, (size_t)fds[0]);
+        process_remove_stream(proc, (size_t)fds[1]);
+        return res;
+    }
+
+    return RES_SUCCESS;
 }
 
-int64_t syscall_exit(process_t *proc, int64_t, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+int64_t syscall_fcntl(process_t *proc, int64_t index, int64_t cmd, int64_t arg, int64_t, int64_t, int64_t, task_state_t *)
 {
-    process_unregister(proc);
-    process_free(proc);
-    execute_next_process();
+    stream_t *stream = process_get_stream(proc, index);
+    if (!stream)
+    {
+        return -RES_INVARG;
+    }
 
-    PANIC("failed to execute process");
+    switch (cmd)
+    {
+    case F_GETFL:
+        return (stream->flags & STREAM_FLAG_NONBLOCK) ? O_NONBLOCK : 0;
+    case F_SETFL:
+        if (arg & ~(int64_t)O_NONBLOCK)
+        {
+            return -RES_INVARG;
+        }
 
-    return 0;
+        uint64_t flags = cpu_irq_save();
+        if (arg & O_NONBLOCK)
+        {
+            stream->flags |= STREAM_FLAG_NONBLOCK;
+        }
+        else
+        {
+            stream->flags &= ~STREAM_FLAG_NONBLOCK;
+        }
+        cpu_irq_restore(flags);
+        return RES_SUCCESS;
+    default:
+        return -RES_INVARG;
+    }
 }
 
-int64_t syscall_ping(process_t *, int64_t pid, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+#define SYSCALL_POLL_MAX 256 // entries per poll or events per epoll_wait
+
+int64_t syscall_poll(process_t *proc, int64_t _fds, int64_t count, int64_t timeout_ns, int64_t, int64_t, int64_t, task_state_t *)
 {
-    if (get_process_from_pid((uint64_t)pid) != NULL)
+    if (count < 0 || count > SYSCALL_POLL_MAX)
     {
-        return pid;
+        return -RES_INVARG;
     }
 
-    return 0;
-}
+    poll_fd_t *fds = kmalloc((count ? (size_t)count : 1) * sizeof(poll_fd_t));
+    stream_t **streams = kmalloc((count ? (size_t)count : 1) * sizeof(stream_t *));
+    if (!fds || !streams)
+    {
+        kfree(fds);
+        kfree(streams);
+        return -RES_NOMEM;
+    }
 
-typedef struct
-{
-    const char **args;
-    size_t num_args;
-    
-    const char **envars;
-    size_t num_envars;
+    int64_t res = copy_from_user(proc, fds, (uintptr_t)_fds, (size_t)count * sizeof(poll_fd_t));
+    if (res >= 0)
+    {
+        // held while waiting, another thread may close the fds and the queues must stay around
+        for (int64_t i = 0; i < count; i++)
+        {
+            streams[i] = process_hold_stream(proc, fds[i].fd);
+        }
 
-    uint64_t stdin_idx;
-    uint64_t stdout_idx;
-    uint64_t stderr_idx;
-} __attribute__((packed)) process_create_info_t;
+        res = poll_streams(get_current_task(), streams, fds, (size_t)count, timeout_ns);
 
-int64_t syscall_exec(process_t *proc, int64_t _path, int64_t _create_info, int64_t, int64_t, int64_t, int64_t, task_state_t *)
-{
-    process_create_info_t *create_info = (process_create_info_t *)process_get_pointer(proc, (uintptr_t)_create_info);
+        for (int64_t i = 0; i < count; i++)
+        {
+            if (streams[i])
+            {
+                stream_free(streams[i]);
+            }
+        }
+    }
+
+    if (res >= 0)
+    {
+        int copy_res = copy_to_user(proc, (uintptr_t)_fds, fds, (size_t)count * sizeof(poll_fd_t));
+        if (copy_res < 0)
+        {
+            res = copy_res;
+        }
+    }
 
-    const char *path = process_get_pointer(proc, (uintptr_t)_path);
-    const char **args = (const char **)process_get_pointer(proc, (uintptr_t)create_info->args);
-    const char **envars = (const char **)process_get_pointer(proc, (uintptr_t)create_info->envars);
-    uint64_t pid = proc->pid;
+    kfree(fds);
+    kfree(streams);
+    return res;
+}
 
-    process_t *exec = process_create(path);
-    if (!exec)
+int64_t syscall_epoll_create(process_t *proc, int64_t, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    epoll_t *epoll = epoll_create();
+    if (!epoll)
     {
-        return -RES_EUNKNOWN;
+        return -RES_NOMEM;
     }
 
-    char **arguments = kmalloc(create_info->num_args * sizeof(char *));
-    if (!arguments)
+    stream_t *stream = stream_create_epoll(epoll);
+    if (!stream)
     {
-        PANIC("out of kernel heap memory");
+        epoll_put(epoll);
+        return -RES_NOMEM;
     }
 
-    for (uint16_t i = 0; i < create_info->num_args; i++)
+    int64_t index = process_insert_stream(proc, stream);
+    if (index < 0)
     {
-        arguments[i] = strdup(process_get_pointer(proc, (uintptr_t)args[i]));
-        if (!arguments[i])
-        {
-            PANIC("out of kernel heap memory");
-        }
+        stream_free(stream);
     }
 
-    char **environment_variables = kmalloc(create_info->num_envars * sizeof(char *));
-    if (!environment_variables)
+    return index;
+}
+
+int64_t syscall_epoll_ctl(process_t *proc, int64_t epfd, int64_t op, int64_t fd, int64_t _event, int64_t, int64_t, task_state_t *)
+{
+    stream_t *ep = process_get_stream(proc, epfd);
+    stream_t *s = process_get_stream(proc, fd);
+    if (!ep || ep->type != STREAM_TYPE_EPOLL || !s)
     {
-        PANIC("out of kernel heap memory");
+        return -RES_INVARG;
     }
 
-    for (uint16_t i = 0; i < create_info->num_envars; i++)
+    epoll_event_t event = {0};
+    if (op != EPOLL_CTL_DEL)
     {
-        environment_variables[i] = strdup(process_get_pointer(proc, (uintptr_t)envars[i]));
-        if (!environment_variables[i])
+        int res = copy_from_user(proc, &event, (uintptr_t)_event, sizeof(event));
+        if (res < 0)
         {
-            PANIC("out of kernel heap memory");
+            return res;
         }
     }
 
-    if (process_set_args(exec, arguments, create_info->num_args) < 0)
+    return epoll_ctl(ep->epoll, (int)op, (int32_t)fd, s, &event);
+}
+
+int64_t syscall_epoll_wait(process_t *proc, int64_t epfd, int64_t _events, int64_t max, int64_t timeout_ns, int64_t, int64_t, task_state_t *)
+{
+    stream_t *ep = process_get_stream(proc, epfd);
+    if (!ep || ep->type != STREAM_TYPE_EPOLL || max <= 0)
     {
-        return -RES_EUNKNOWN;
+        return -RES_INVARG;
     }
 
-    if (process_set_envars(exec, environment_variables, create_info->num_envars) < 0)
+    if (max > SYSCALL_POLL_MAX)
     {
-        return -RES_EUNKNOWN;
+        max = SYSCALL_POLL_MAX;
     }
 
-    if (process_set_stdin(exec, proc->streams[create_info->stdin_idx]) < 0)
+    epoll_event_t *events = kmalloc((size_t)max * sizeof(epoll_event_t));
+    if (!events)
     {
-        return -RES_EUNKNOWN;
+        return -RES_NOMEM;
     }
 
-    if (process_set_stdout(exec, proc->streams[create_info->stdout_idx]) < 0)
+    int64_t res = epoll_wait(ep->epoll, get_current_task(), events, (size_t)max, timeout_ns);
+    if (res > 0)
     {
-        return -RES_EUNKNOWN;
+        int copy_res = copy_to_user(proc, (uintptr_t)_events, events, (size_t)res * sizeof(epoll_event_t));
+        if (copy_res < 0)
+        {
+            res = copy_res;
+        }
     }
 
-    if (process_set_stderr(exec, proc->streams[create_info->stderr_idx]) < 0)
+    kfree(events);
+    return res;
+}
+
+int64_t syscall_lseek(process_t *proc, int64_t stream, int64_t offset, int64_t action, int64_t, int64_t, int64_t, task_state_t *)
+{
+    stream_t *s = process_get_stream(proc, stream);
+    if (!s)
     {
-        return -RES_EUNKNOWN;
+        return 0;
     }
 
-    if (setup_initial_stack(exec) < 0)
+    if (s->type != STREAM_TYPE_FILE)
     {
-        return -RES_EUNKNOWN;
+        return 0;
     }
 
-    exec->pid = pid;
+    vfs_seek(s, (size_t)offset, (uint8_t)action);
     
-    if (process_unregister(proc) < 0)
+    return s->node->offset;
+}
+
+int64_t syscall_clock_gettime(process_t *proc, int64_t clock_id, int64_t _ts, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    if (clock_id != CLOCK_MONOTONIC)
     {
-        return -RES_EUNKNOWN;
+        return -RES_UNAVAILABLE; // no rtc yet
     }
 
-    process_free(proc);
+    uint64_t ns = time_get_ns();
+    timespec_t ts = {
+        .tv_sec = ns / NSEC_PER_SEC,
+        .tv_nsec = ns % NSEC_PER_SEC,
+    };
 
-    if (IS_ERROR(process_register(exec)))
+    return copy_to_user(proc, (uintptr_t)_ts, &ts, sizeof(ts));
+}
+
+static void sleep_timeout(hrtimer_t *timer)
+{
+    task_wakeup((task_t *)timer->data);
+}
+
+int64_t syscall_nanosleep(process_t *, int64_t ns, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    if (ns <= 0)
     {
-        PANIC("failed to register process");
+        return RES_SUCCESS;
     }
 
-    execute_next_process();
-    PANIC("failed to execute process");
+    // the timer must not fire before the process is marked as blocked
+    uint64_t flags = cpu_irq_save();
 
-    return 0;
+    task_t *task = get_current_task();
+    hrtimer_init(&task->timeout, &sleep_timeout, task);
+    if (hrtimer_start(&task->timeout, time_get_ns() + (uint64_t)ns) < 0)
+    {
+        cpu_irq_restore(flags);
+        return -RES_NOMEM;
+    }
+
+    task->status = TASK_STATUS_BLOCKED;
+    schedule();
+
+    cpu_irq_restore(flags);
+
+    return RES_SUCCESS;
 }
 
-int64_t syscall_alloc(process_t *proc, int64_t, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+int64_t syscall_sched_stats(process_t *proc, int64_t _stats, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
 {
-    return (int64_t)process_allocate_page(proc);
+    sched_stats_t stats;
+    scheduler_get_stats(&stats);
+
+    return copy_to_user(proc, (uintptr_t)_stats, &stats, sizeof(stats));
 }
 
-int64_t syscall_open(process_t *proc, int64_t _path, int64_t _open_actions, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+int64_t syscall_thread_create(process_t *proc, int64_t entry, int64_t arg, int64_t stack, int64_t, int64_t, int64_t, task_state_t *)
 {
-    const char *path = process_get_pointer(proc, (uintptr_t)_path);
-    return (int64_t)process_insert_file(proc, path, (uint8_t)_open_actions);
+    if (!process_get_pointer(proc, (uintptr_t)entry) || !process_get_pointer(proc, (uintptr_t)stack - 1))
+    {
+        return -RES_INVARG;
+    }
+
+    task_t *thread = thread_create(proc, (uint64_t)entry, (uint64_t)stack, (uint64_t)arg);
+    if (!thread)
+    {
+        return -RES_NOMEM;
+    }
+
+    return (int64_t)thread->tid;
 }
 
-int64_t syscall_close(process_t *proc, int64_t stream, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+int64_t syscall_thread_exit(process_t *, int64_t, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
 {
-    process_remove_stream(proc, (size_t)stream);
+    thread_exit(get_current_task());
+
     return 0;
 }
 
-int64_t syscall_video_get_display_rect(process_t *proc, int64_t display_id, int64_t _rect, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+int64_t syscall_thread_join(process_t *, int64_t tid, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    return thread_join(get_current_task(), (uint64_t)tid);
+}
+
+int64_t syscall_yield(process_t *, int64_t, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    schedule();
+
+    return RES_SUCCESS;
+}
+
+int64_t syscall_gettid(process_t *, int64_t, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    return (int64_t)get_current_task()->tid;
+}
+
+int64_t syscall_futex_wait(process_t *proc, int64_t addr, int64_t val, int64_t timeout_ns, int64_t, int64_t, int64_t, task_state_t *)
 {
-    video_rect_t *rect = process_get_pointer(proc, (uintptr_t)_rect);
-    if (!rect)
+    // aligned words never cross a page
+    if (addr % sizeof(uint32_t) != 0 || timeout_ns < 0)
     {
         return -RES_INVARG;
     }
 
-    device_t *dev = get_device_by_type(DEVICE_VIDEO, 0);
-    if (!dev)
+    uint32_t *uaddr = process_get_pointer(proc, (uintptr_t)addr);
+    if (!uaddr)
     {
         return -RES_INVARG;
     }
 
-    int status = device_get_display_rect(rect, display_id, dev);
-    return status;
+    return futex_wait(get_current_task(), uaddr, (uintptr_t)addr, (uint32_t)val, (uint64_t)timeout_ns);
 }
 
-int64_t syscall_video_create_framebuffer(process_t *proc, int64_t display_id, int64_t _rect, int64_t _vaddr, int64_t, int64_t, int64_t, task_state_t *)
+int64_t syscall_futex_wake(process_t *proc, int64_t addr, int64_t count, int64_t, int64_t, int64_t, int64_t, task_state_t *)
 {
-    video_rect_t *rect = process_get_pointer(proc, (uintptr_t)_rect);
-    if (!rect)
+    if (addr % sizeof(uint32_t) != 0 || count <= 0)
     {
         return -RES_INVARG;
     }
 
-    device_t *dev = get_device_by_type(DEVICE_VIDEO, 0);
-    if (!dev)
+    return (int64_t)futex_wake(proc->pml4, (uintptr_t)addr, (size_t)count);
+}
+
+int64_t syscall_ring_setup(process_t *proc, int64_t entries, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    if (entries <= 0 || entries > IO_RING_MAX_ENTRIES)
     {
         return -RES_INVARG;
     }
 
-    uint32_t *fb = device_create_framebuffer(rect, display_id, dev);
-    if (!fb)
+    return io_ring_setup(proc, (uint32_t)entries);
+}
+
+int64_t syscall_ring_enter(process_t *proc, int64_t to_submit, int64_t min_complete, int64_t flags, int64_t, int64_t, int64_t, task_state_t *)
+{
+    if (to_submit < 0 || min_complete < 0)
     {
-        return -RES_EUNKNOWN;
+        return -RES_INVARG;
     }
 
-    size_t num_pages = (get_framebuffer_size(rect) + PAGE_SIZE - 1) / PAGE_SIZE;
-    if (_vaddr < 0x900000 || _vaddr > 0x1000000)
+    return io_ring_enter(proc, (uint32_t)to_submit, (uint32_t)min_complete, (uint32_t)flags);
+}
+
+// ring operations may run on the shared workqueue, so reads and writes never wait on a pipe
+int64_t syscall_ring_execute(process_t *proc, const io_ring_sqe_t *sqe)
+{
+    if ((int64_t)sqe->len < 0)
     {
-        return -RES_ACCESS_DENIED;
+        return -RES_INVARG;
     }
 
-    for (size_t i = 0; i < num_pages; i++)
+    switch (sqe->opcode)
     {
-        if (pml4_get_phys(proc->pml4, (void *)((uintptr_t)_vaddr + PAGE_SIZE * i), false) != 0)
+    case IO_RING_OP_NOP:
+        return RES_SUCCESS;
+    case IO_RING_OP_READ:
+    case IO_RING_OP_WRITE:
+    {
+        size_t pos = (size_t)sqe->offset;
+        size_t *offset = sqe->offset < 0 ? NULL : &pos;
+        if (sqe->opcode == IO_RING_OP_READ)
         {
-            return -RES_ACCESS_DENIED;
+            return do_read(proc, sqe->stream, (int64_t)sqe->addr, (int64_t)sqe->len, offset, true);
         }
+        return do_write(proc, sqe->stream, (int64_t)sqe->addr, (int64_t)sqe->len, offset, true);
     }
+    case IO_RING_OP_OPEN:
+        return syscall_open(proc, (int64_t)sqe->addr, (int64_t)sqe->len, 0, 0, 0, 0, NULL);
+    case IO_RING_OP_CLOSE:
+        return syscall_close(proc, sqe->stream, 0, 0, 0, 0, 0, NULL);
+    case IO_RING_OP_SEEK:
+        return syscall_lseek(proc, sqe->stream, sqe->offset, (int64_t)sqe->len, 0, 0, 0, NULL);
+    default:
+        return -RES_INVARG;
+    }
+}
 
-    int status = pml4_map_range(proc->pml4, (void *)_vaddr, fb, num_pages, PAGE_PRESENT | PAGE_WRITABLE | PAGE_USER);
-
-    return status;
+static syscall_trace_t *trace_lookup(process_t *proc, int64_t pid)
+{
+    return pid == 0 ? proc->syscall_trace : systrace_find((uint64_t)pid);
 }
 
-int64_t syscall_video_update_display(process_t *proc, int64_t _fb, int64_t _rect, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+int64_t syscall_trace(process_t *proc, int64_t pid, int64_t flags, int64_t, int64_t, int64_t, int64_t, task_state_t *)
 {
-    video_rect_t *rect = process_get_pointer(proc, (uintptr_t)_rect);
-    if (!rect)
+    process_t *target = pid == 0 ? proc : get_process_from_pid((uint64_t)pid);
+    if (!target)
     {
         return -RES_INVARG;
     }
 
-    uint32_t *fb = process_get_pointer(proc, (uintptr_t)_fb);
-    if (!fb)
-    {
-        return -RES_INVARG;
-    }
+    return systrace_enable(target, (uint32_t)flags);
+}
 
-    device_t *dev = get_device_by_type(DEVICE_VIDEO, 0);
-    if (!dev)
+int64_t syscall_trace_stats(process_t *proc, int64_t pid, int64_t _stats, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+{
+    syscall_trace_t *trace = trace_lookup(proc, pid);
+    if (!trace)
     {
         return -RES_INVARG;
     }
 
-    int status = device_update_display(rect, fb, dev);
-    return status;
+    return copy_to_user(proc, (uintptr_t)_stats, &trace->stats, sizeof(syscall_stats_t));
 }
 
-int64_t syscall_pipe(process_t *proc, int64_t, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
+int64_t syscall_pcache_stats(process_t *proc, int64_t _stats, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *)
 {
-    stream_t *stream = stream_create_bidirectional(0);
-    if (!stream)
-    {
-        return 0;
-    }
-    
-    return process_insert_stream(proc, stream);
+    pcache_stats_t stats;
+    pcache_get_stats(&stats);
+
+    return copy_to_user(proc, (uintptr_t)_stats, &stats, sizeof(pcache_stats_t));
 }
 
-int64_t syscall_lseek(process_t *proc, int64_t stream, int64_t offset, int64_t action, int64_t, int64_t, int64_t, task_state_t *)
+#define SYSCALL_TRACE_BATCH 16
+
+// returns the number of records, 0 once everything has been read
+int64_t syscall_trace_read(process_t *proc, int64_t pid, int64_t _records, int64_t max, int64_t, int64_t, int64_t, task_state_t *)
 {
-    stream_t *s = proc->streams[stream];
-    if (!stream)
+    if (max < 0)
     {
-        return 0;
+        return -RES_INVARG;
     }
 
-    if (s->type != STREAM_TYPE_FILE)
+    syscall_trace_t *trace = trace_lookup(proc, pid);
+    if (!trace)
     {
-        return 0;
+        return -RES_INVARG;
     }
 
-    vfs_seek(s, (size_t)offset, (uint8_t)action);
-    
-    return s->node->offset;
+    syscall_trace_record_t batch[SYSCALL_TRACE_BATCH];
+    size_t total = 0;
+    while (total < (size_t)max)
+    {
+        size_t n = (size_t)max - total < SYSCALL_TRACE_BATCH ? (size_t)max - total : SYSCALL_TRACE_BATCH;
+        n = systrace_read(trace, batch, n);
+        if (n == 0)
+        {
+            break; // an exited process may be gone after this
+        }
+
+        int res = copy_to_user(proc, (uintptr_t)_records + total * sizeof(syscall_trace_record_t), batch, n * sizeof(syscall_trace_record_t));
+        if (res < 0)
+        {
+            return res;
+        }
+        total += n;
+    }
+
+    return (int64_t)total;
 }
 
 extern page_table_t *kernel_pml4;
 
+typedef int64_t (*syscall_fn_t)(process_t *proc, int64_t, int64_t, int64_t, int64_t, int64_t, int64_t, task_state_t *);
+
+typedef struct
+{
+    syscall_fn_t func;
+    uint32_t flags;
+} syscall_entry_t;
+
+#define SYSCALL_ENTRY(number, name, flags) [number] = {&syscall_##name, flags},
+
+static const syscall_entry_t syscall_table[SYSCALL_COUNT] = {
+    SYSCALL_TABLE(SYSCALL_ENTRY)
+};
+
 int64_t syscall_handler(uint64_t num, int64_t arg0, int64_t arg1, int64_t arg2, int64_t arg3, int64_t arg4, int64_t arg5, task_state_t *state)
 {
     if (pml4_switch(kernel_pml4) < 0)
@@ -351,61 +1273,33 @@ int64_t syscall_handler(uint64_t num, int64_t arg0, int64_t arg1, int64_t arg2,
         while (1);
     }
 
-    memcpy(&proc->task.state, state, sizeof(task_state_t));
+    // untraced processes only pay for this check
+    uint64_t entry_tsc = proc->syscall_trace ? cpu_read_tsc() : 0;
+    const int64_t args[6] = {arg0, arg1, arg2, arg3, arg4, arg5};
+
+    memcpy(&get_current_task()->state, state, sizeof(task_state_t));
+    get_current_task()->syscall_tsc = entry_tsc;
 
     int64_t res = -1;
-    switch (num)
-    {
-    case 0:
-        res = syscall_read(proc, arg0, arg1, arg2, arg3, arg4, arg5, state);
-        break;
-    case 1:
-        res = syscall_write(proc, arg0, arg1, arg2, arg3, arg4, arg5, state);
-        break;
-    case 2:
-        res = syscall_fork(proc, arg0, arg1, arg2, arg3, arg4, arg5, state);
-        break;
-    case 3:
-        res = syscall_exit(proc, arg0, arg1, arg2, arg3, arg4, arg5, state);
-        break;
-    case 4:
-        res = syscall_ping(proc, arg0, arg1, arg2, arg3, arg4, arg5, state);
-        break;
-    case 5:
-        res = syscall_exec(proc, arg0, arg1, arg2, arg3, arg4, arg5, state);
-        break;
-    case 6:
-        res = syscall_alloc(proc, arg0, arg1, arg2, arg3, arg4, arg5, state);
-        break;
-    case 7:
-        res = syscall_open(proc, arg0, arg1, arg2, arg3, arg4, arg5, state);
-        break;
-    case 8:
-        res = syscall_close(proc, arg0, arg1, arg2, arg3, arg4, arg5, state);
-        break;
-
-        // TODO: this is a temporary api -> it will be replaced by a /dev directory with one syscall that can interact with mounted devices
-    case 9:
-        res = syscall_video_get_display_rect(proc, arg0, arg1, arg2, arg3, arg4, arg5, state);
-        break;
-    case 10:
-        res = syscall_video_create_framebuffer(proc, arg0, arg1, arg2, arg3, arg4, arg5, state);
-        break;
-    case 11:
-        res = syscall_video_update_display(proc, arg0, arg1, arg2, arg3, arg4, arg5, state);
-        break;
-        
-    case 12:
-        res = syscall_pipe(proc, arg0, arg1, arg2, arg3, arg4, arg5, state);
-        break;
-    case 13:
-        res = syscall_lseek(proc, arg0, arg1, arg2, arg3, arg4, arg5, state);
-        break;
+    if (num < SYSCALL_COUNT)
+    {
+        if (entry_tsc && (syscall_table[num].flags & SYSCALL_FLAG_NORETURN))
+        {
+            systrace_record(proc, num, args, 0, entry_tsc, cpu_read_tsc());
+        }
 
-    default:
-        break;
+        res = syscall_table[num].func(proc, arg0, arg1, arg2, arg3, arg4, arg5, state);
     }
 
+    // tracing may have been switched on or off by this call
+    if (entry_tsc && proc->syscall_trace)
+    {
+        systrace_record(proc, num, args, res, entry_tsc, cpu_read_tsc());
+    }
+
+    // returning to user mode is always a safe point
+    cond_resched();
+
     if (pml4_switch(proc->pml4) < 0)
     {
         PANIC("failed to switch pml4");
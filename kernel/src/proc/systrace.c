@@ -0,0 +1,232 @@
+#include <kernel/proc/systrace.h>
+#include <kernel/kmm.h>
+#include <kernel/cpu.h>
+#include <kernel/time.h>
+#include <kernel/string.h>
+
+static syscall_trace_t *orphans = NULL;
+static size_t num_orphans = 0;
+
+static void trace_free(syscall_trace_t *trace)
+{
+    if (trace->events)
+    {
+        kfree(trace->events);
+    }
+    kfree(trace);
+}
+
+KRES systrace_enable(process_t *proc, uint32_t flags)
+{
+    if (flags & ~(SYSTRACE_STATS | SYSTRACE_EVENTS | SYSTRACE_INHERIT))
+    {
+        return -RES_INVARG;
+    }
+
+    if (!flags)
+    {
+        if (proc->syscall_trace)
+        {
+            trace_free(proc->syscall_trace);
+            proc->syscall_trace = NULL;
+        }
+        return RES_SUCCESS;
+    }
+
+    syscall_trace_t *trace = proc->syscall_trace;
+    if (!trace)
+    {
+        trace = kmalloc(sizeof(syscall_trace_t));
+        if (!trace)
+        {
+            return -RES_NOMEM;
+        }
+        memset(trace, 0, sizeof(syscall_trace_t));
+        trace->pid = proc->pid;
+    }
+
+    if ((flags & SYSTRACE_EVENTS) && !trace->events)
+    {
+        trace->events = kmalloc(SYSTRACE_EVENTS_SIZE * sizeof(syscall_trace_record_t));
+        if (!trace->events)
+        {
+            if (!proc->syscall_trace)
+            {
+                kfree(trace);
+            }
+            return -RES_NOMEM;
+        }
+    }
+
+    trace->flags = flags;
+    proc->syscall_trace = trace;
+
+    return RES_SUCCESS;
+}
+
+KRES systrace_inherit(process_t *child, process_t *parent)
+{
+    if (!parent->syscall_trace || !(parent->syscall_trace->flags & SYSTRACE_INHERIT))
+    {
+        return RES_SUCCESS;
+    }
+
+    return systrace_enable(child, parent->syscall_trace->flags);
+}
+
+static void account(syscall_stat_t *stat, uint64_t ns)
+{
+    stat->count++;
+    stat->total_ns += ns;
+    if (ns > stat->max_ns)
+    {
+        stat->max_ns = ns;
+    }
+
+    size_t bucket = 0;
+    while (bucket < SYSCALL_LATENCY_BUCKETS - 1 && ns >= (256ULL << bucket))
+    {
+        bucket++;
+    }
+    stat->histogram[bucket]++;
+}
+
+void systrace_record(process_t *proc, uint64_t num, const int64_t args[6], int64_t result, uint64_t entry_tsc, uint64_t exit_tsc)
+{
+    syscall_trace_t *trace = proc->syscall_trace;
+    if (num >= SYSCALL_COUNT)
+    {
+        return;
+    }
+
+    uint64_t duration = time_tsc_to_ns(exit_tsc - entry_tsc);
+    if (trace->flags & SYSTRACE_STATS)
+    {
+        account(&trace->stats.calls[num], duration);
+    }
+
+    if (trace->flags & SYSTRACE_EVENTS)
+    {
+        uint64_t flags = cpu_irq_save();
+
+        if (trace->tail - trace->head == SYSTRACE_EVENTS_SIZE)
+        {
+            trace->head++;
+            trace->stats.dropped++;
+        }
+
+        syscall_trace_record_t *record = &trace->events[trace->tail % SYSTRACE_EVENTS_SIZE];
+        record->time_ns = time_get_ns() - duration;
+        record->duration_ns = duration;
+        record->tid = get_current_task()->tid;
+        record->num = (uint32_t)num;
+        record->reserved = 0;
+        memcpy(record->args, args, sizeof(record->args));
+        record->result = result;
+        trace->tail++;
+
+        cpu_irq_restore(flags);
+    }
+}
+
+syscall_trace_t *systrace_find(uint64_t pid)
+{
+    process_t *proc = get_process_from_pid(pid);
+    if (proc)
+    {
+        return proc->syscall_trace;
+    }
+
+    for (syscall_trace_t *trace = orphans; trace != NULL; trace = trace->next)
+    {
+        if (trace->pid == pid)
+        {
+            return trace;
+        }
+    }
+
+    return NULL;
+}
+
+static void orphan_remove(syscall_trace_t *trace)
+{
+    for (syscall_trace_t **link = &orphans; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == trace)
+        {
+            *link = trace->next;
+            num_orphans--;
+            return;
+        }
+    }
+}
+
+size_t systrace_read(syscall_trace_t *trace, syscall_trace_record_t *records, size_t max)
+{
+    uint64_t flags = cpu_irq_save();
+
+    size_t count = 0;
+    if (trace->events)
+    {
+        while (count < max && trace->head != trace->tail)
+        {
+            records[count++] = trace->events[trace->head % SYSTRACE_EVENTS_SIZE];
+            trace->head++;
+        }
+    }
+
+    // an orphan is dropped by the first read that finds it empty
+    bool orphan = false;
+    for (syscall_trace_t *o = orphans; o != NULL; o = o->next)
+    {
+        orphan |= o == trace;
+    }
+
+    if (orphan && count == 0)
+    {
+        orphan_remove(trace);
+        trace_free(trace);
+    }
+
+    cpu_irq_restore(flags);
+    return count;
+}
+
+void systrace_release(process_t *proc)
+{
+    syscall_trace_t *trace = proc->syscall_trace;
+    if (!trace)
+    {
+        return;
+    }
+    proc->syscall_trace = NULL;
+
+    uint64_t flags = cpu_irq_save();
+
+    if (trace->head == trace->tail && !(trace->flags & SYSTRACE_STATS))
+    {
+        cpu_irq_restore(flags);
+        trace_free(trace);
+        return;
+    }
+
+    if (num_orphans == SYSTRACE_MAX_ORPHANS)
+    {
+        // drop the oldest, which is the last in the list
+        syscall_trace_t **link = &orphans;
+        while ((*link)->next)
+        {
+            link = &(*link)->next;
+        }
+        syscall_trace_t *oldest = *link;
+        *link = NULL;
+        num_orphans--;
+        trace_free(oldest);
+    }
+
+    trace->next = orphans;
+    orphans = trace;
+    num_orphans++;
+
+    cpu_irq_restore(flags);
+}
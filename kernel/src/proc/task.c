@@ -3,10 +3,252 @@
 #include <kernel/string.h>
 #include <kernel/kprintf.h>
 #include <kernel/pmm.h>
+#include <kernel/time.h>
+#include <kernel/fpu.h>
+#include <kernel/cpu.h>
+#include <kernel/smm.h>
+#include <kernel/proc/kstack.h>
+#include <kernel/proc/scheduler.h>
+#include <kernel/proc/futex.h>
+#include <kernel/proc/ioring.h>
+#include <kernel/proc/systrace.h>
+#include <kernel/proc/waitqueue.h>
 
 extern int __kernel_start;
 extern int __kernel_end;
 
+static void task_entry(void);
+static void kthread_entry(void);
+
+static uint64_t current_tid = 0;
+
+// switch_context into a new task returns into entry
+static int task_setup(task_t *task, process_t *proc, void (*entry)(void))
+{
+    task->kernel_stack = kstack_alloc();
+    if (!task->kernel_stack)
+    {
+        return -RES_NOMEM;
+    }
+
+    uint64_t *sp = (uint64_t *)task->kernel_stack;
+    *--sp = 0; // return address of entry
+    *--sp = (uint64_t)entry;
+    for (int i = 0; i < 6; i++)
+    {
+        *--sp = 0; // rbx, rbp, r12 - r15 popped by switch_context
+    }
+    task->kernel_rsp = (uint64_t)sp;
+
+    task->proc = proc;
+    task->tid = current_tid++;
+    task->status = TASK_STATUS_READY;
+    task->next = NULL;
+
+    return RES_SUCCESS;
+}
+
+// grows the stream table until index fits, the arrays are swapped so lookups never see a half copied table
+static int process_reserve_streams(process_t *proc, size_t index)
+{
+    if (index >= PROCESS_MAX_STREAMS)
+    {
+        return -RES_OVERFLOW;
+    }
+
+    if (index < proc->streams_size)
+    {
+        return RES_SUCCESS;
+    }
+
+    size_t size = proc->streams_size ? proc->streams_size : PROCESS_INITIAL_STREAMS;
+    while (size <= index)
+    {
+        size *= 2;
+    }
+
+    stream_t **streams = kmalloc(size * sizeof(stream_t *));
+    uint64_t *used = kmalloc(size / 64 * sizeof(uint64_t));
+    if (!streams || !used)
+    {
+        kfree(streams);
+        kfree(used);
+        return -RES_NOMEM;
+    }
+
+    memset(streams, 0, size * sizeof(stream_t *));
+    memset(used, 0, size / 64 * sizeof(uint64_t));
+
+    uint64_t flags = cpu_irq_save();
+
+    // another thread of the process may have grown it in the meantime
+    if (proc->streams_size >= size)
+    {
+        cpu_irq_restore(flags);
+        kfree(streams);
+        kfree(used);
+        return RES_SUCCESS;
+    }
+
+    if (proc->streams)
+    {
+        memcpy(streams, proc->streams, proc->streams_size * sizeof(stream_t *));
+        memcpy(used, proc->streams_used, proc->streams_size / 64 * sizeof(uint64_t));
+    }
+
+    stream_t **old_streams = proc->streams;
+    uint64_t *old_used = proc->streams_used;
+    proc->streams = streams;
+    proc->streams_used = used;
+    proc->streams_size = size;
+
+    cpu_irq_restore(flags);
+
+    kfree(old_streams);
+    kfree(old_used);
+
+    return RES_SUCCESS;
+}
+
+static void process_claim_stream(process_t *proc, size_t index, stream_t *stream)
+{
+    proc->streams[index] = stream;
+    proc->streams_used[index / 64] |= 1ULL << (index % 64);
+}
+
+// for a fixed index like stdin, fails if it is taken, the stream is freed on failure
+static int process_set_stream(process_t *proc, size_t index, stream_t *stream)
+{
+    if (!stream)
+    {
+        return -RES_NOMEM;
+    }
+
+    int res = process_reserve_streams(proc, index);
+    if (res < 0)
+    {
+        stream_free(stream);
+        return res;
+    }
+
+    uint64_t flags = cpu_irq_save();
+    if (proc->streams[index] != NULL)
+    {
+        cpu_irq_restore(flags);
+        stream_free(stream);
+        return -RES_INVARG;
+    }
+
+    process_claim_stream(proc, index, stream);
+    cpu_irq_restore(flags);
+
+    return RES_SUCCESS;
+}
+
+int64_t process_insert_stream(process_t *proc, stream_t *stream)
+{
+    if (!stream)
+    {
+        return -RES_INVARG;
+    }
+
+    for (;;)
+    {
+        uint64_t flags = cpu_irq_save();
+
+        for (size_t i = 0; i < proc->streams_size / 64; i++)
+        {
+            if (proc->streams_used[i] != UINT64_MAX)
+            {
+                size_t index = i * 64 + (size_t)__builtin_ctzll(~proc->streams_used[i]);
+                process_claim_stream(proc, index, stream);
+                cpu_irq_restore(flags);
+                return (int64_t)index;
+            }
+        }
+
+        size_t size = proc->streams_size;
+        cpu_irq_restore(flags);
+
+        // full, the first index past the end is the lowest free one after growing
+        int res = process_reserve_streams(proc, size);
+        if (res < 0)
+        {
+            return res;
+        }
+    }
+}
+
+int64_t process_insert_file(process_t *proc, const char *path, uint8_t open_action)
+{
+    stream_t *stream = vfs_open(path, open_action);
+    if (!stream)
+    {
+        return -RES_UNAVAILABLE;
+    }
+
+    int64_t index = process_insert_stream(proc, stream);
+    if (index < 0)
+    {
+        stream_free(stream);
+    }
+
+    return index;
+}
+
+stream_t *process_get_stream(process_t *proc, int64_t index)
+{
+    if (index < 0)
+    {
+        return NULL;
+    }
+
+    // the table may be swapped by another thread growing it
+    uint64_t flags = cpu_irq_save();
+    stream_t *stream = (size_t)index < proc->streams_size ? proc->streams[index] : NULL;
+    cpu_irq_restore(flags);
+
+    return stream;
+}
+
+stream_t *process_hold_stream(process_t *proc, int64_t index)
+{
+    if (index < 0)
+    {
+        return NULL;
+    }
+
+    // a close from another thread either happens before this or finds the reference taken
+    uint64_t flags = cpu_irq_save();
+    stream_t *stream = (size_t)index < proc->streams_size ? proc->streams[index] : NULL;
+    if (stream)
+    {
+        stream_hold(stream);
+    }
+    cpu_irq_restore(flags);
+
+    return stream;
+}
+
+void process_remove_stream(process_t *proc, size_t index)
+{
+    uint64_t flags = cpu_irq_save();
+
+    if (index >= proc->streams_size || proc->streams[index] == NULL)
+    {
+        cpu_irq_restore(flags);
+        return;
+    }
+
+    stream_t *stream = proc->streams[index];
+    proc->streams[index] = NULL;
+    proc->streams_used[index / 64] &= ~(1ULL << (index % 64));
+
+    cpu_irq_restore(flags);
+
+    stream_free(stream);
+}
+
 static uint64_t current_pid = 0;
 process_t *process_create(const char *path)
 {
@@ -20,15 +262,15 @@ process_t *process_create(const char *path)
 
     memset(proc, 0, sizeof(process_t));
 
-    proc->elf = elf_load(path);
-    if (!proc->elf)
+    proc->image = image_get(path);
+    if (!proc->image || proc->image->header.e_type != ET_EXEC)
     {
         process_free(proc);
         return NULL;
     }
 
     memset(&proc->task.state, 0, sizeof(task_state_t));
-    proc->task.state.rip = elf_entry(proc->elf);
+    proc->task.state.rip = image_entry(proc->image);
 
     strncpy(proc->path, path, MAX_PATH);
     proc->pml4 = pmm_alloc();
@@ -48,6 +290,20 @@ process_t *process_create(const char *path)
         }
     }
 
+    if (pml4_map(proc->pml4, (void *)PROCESS_TIME_PAGE_VADDR, time_get_page(), PAGE_PRESENT | PAGE_USER) < 0)
+    {
+        process_free(proc);
+        return NULL;
+    }
+
+    kstack_share(proc->pml4);
+    if (task_setup(&proc->task, proc, &task_entry) < 0)
+    {
+        process_free(proc);
+        return NULL;
+    }
+    proc->num_threads = 1;
+
     proc->task.num_stack_pages = PROCESS_STACK_SIZE / PAGE_SIZE;
     proc->task.stack_pages = kmalloc(proc->task.num_stack_pages * sizeof(void *));
     if (!proc->task.stack_pages)
@@ -72,26 +328,21 @@ process_t *process_create(const char *path)
         }
     }
 
-    if (elf_load_and_map(proc, proc->elf) < 0)
+    if (image_map(proc, proc->image, NULL) < 0)
     {
         process_free(proc);
         return NULL;
     }
 
-    memset(proc->streams, 0, PROCESS_MAX_STREAMS * sizeof(stream_t *));
-
     proc->task.state.rsp = PROCESS_STACK_VADDR_BASE + PROCESS_STACK_SIZE - 16;
     proc->next = NULL;
 
     proc->pid = current_pid++;
 
-    elf_free(proc->elf);
-    proc->elf = NULL;
-
     return proc;
 }
 
-process_t *process_clone(process_t *_proc)
+process_t *process_clone(process_t *_proc, task_t *task)
 {
     process_t *proc = kmalloc(sizeof(process_t));
     if (!proc)
@@ -103,15 +354,18 @@ process_t *process_clone(process_t *_proc)
 
     memset(proc, 0, sizeof(process_t));
 
-    proc->elf = elf_load(_proc->path);
-    if (!proc->elf)
+    // the child runs the same image even if the file changed since
+    image_hold(_proc->image);
+    proc->image = _proc->image;
+
+    memcpy(&proc->task.state, &task->state, sizeof(task_state_t));
+
+    if (fpu_clone(&proc->task, task) < 0)
     {
         process_free(proc);
         return NULL;
     }
 
-    memcpy(&proc->task.state, &_proc->task.state, sizeof(task_state_t));
-
     strncpy(proc->path, _proc->path, MAX_PATH);
     proc->pml4 = pmm_alloc();
     memset(proc->pml4, 0, PAGE_SIZE);
@@ -130,6 +384,20 @@ process_t *process_clone(process_t *_proc)
         }
     }
 
+    if (pml4_map(proc->pml4, (void *)PROCESS_TIME_PAGE_VADDR, time_get_page(), PAGE_PRESENT | PAGE_USER) < 0)
+    {
+        process_free(proc);
+        return NULL;
+    }
+
+    kstack_share(proc->pml4);
+    if (task_setup(&proc->task, proc, &task_entry) < 0)
+    {
+        process_free(proc);
+        return NULL;
+    }
+    proc->num_threads = 1;
+
     proc->task.num_stack_pages = _proc->task.num_stack_pages;
     proc->task.stack_pages = kmalloc(proc->task.num_stack_pages * sizeof(void *));
     if (!proc->task.stack_pages)
@@ -174,31 +442,29 @@ process_t *process_clone(process_t *_proc)
         }
     }
 
-    if (elf_load_and_map_copy(proc, proc->elf, _proc) < 0)
+    if (image_map(proc, proc->image, _proc) < 0)
     {
         process_free(proc);
         return NULL;
     }
 
-    memset(proc->streams, 0, PROCESS_MAX_STREAMS * sizeof(stream_t *));
-    for (uint64_t i = 0; i < PROCESS_MAX_STREAMS; i++)
+    for (size_t i = 0; i < _proc->streams_size; i++)
     {
-        if (_proc->streams[i] != NULL)
+        if (_proc->streams[i] != NULL && process_set_stream(proc, i, stream_clone(_proc->streams[i])) < 0)
         {
-            proc->streams[i] = stream_clone(_proc->streams[i]);
-            if (!proc->streams[i])
-            {
-                process_free(proc);
-                return NULL;
-            }
+            process_free(proc);
+            return NULL;
         }
     }
 
     proc->next = NULL;
     proc->pid = current_pid++;
 
-    elf_free(proc->elf);
-    proc->elf = NULL;
+    if (systrace_inherit(proc, _proc) < 0)
+    {
+        process_free(proc);
+        return NULL;
+    }
 
     return proc;
 }
@@ -221,15 +487,13 @@ int process_set_envars(process_t *proc, char **envars, uint16_t num_envars)
 
 int process_set_stdin(process_t *proc, stream_t *stdin)
 {
-    if (proc->streams[0] != NULL)
+    if (process_get_stream(proc, 0) != NULL)
     {
         return -RES_EUNKNOWN;
     }
 
-    proc->streams[0] = stream_clone(stdin);
-    if (!proc->streams[0])
+    if (process_set_stream(proc, 0, stream_clone(stdin)) < 0)
     {
-        process_free(proc);
         return -RES_EUNKNOWN;
     }
     return RES_SUCCESS;
@@ -237,15 +501,13 @@ int process_set_stdin(process_t *proc, stream_t *stdin)
 
 int process_set_stdout(process_t *proc, stream_t *stdout)
 {
-    if (proc->streams[1] != NULL)
+    if (process_get_stream(proc, 1) != NULL)
     {
         return -RES_EUNKNOWN;
     }
 
-    proc->streams[1] = stream_clone(stdout);
-    if (!proc->streams[1])
+    if (process_set_stream(proc, 1, stream_clone(stdout)) < 0)
     {
-        process_free(proc);
         return -RES_EUNKNOWN;
     }
     return RES_SUCCESS;
@@ -253,15 +515,13 @@ int process_set_stdout(process_t *proc, stream_t *stdout)
 
 int process_set_stderr(process_t *proc, stream_t *stderr)
 {
-    if (proc->streams[2] != NULL)
+    if (process_get_stream(proc, 2) != NULL)
     {
         return -RES_EUNKNOWN;
     }
 
-    proc->streams[2] = stream_clone(stderr);
-    if (!proc->streams[2])
+    if (process_set_stream(proc, 2, stream_clone(stderr)) < 0)
     {
-        process_free(proc);
         return -RES_EUNKNOWN;
     }
     return RES_SUCCESS;
@@ -272,7 +532,14 @@ int setup_initial_stack(process_t *proc)
     uint8_t *stack_top = (uint8_t *)pml4_get_phys(proc->pml4, (void *)proc->task.state.rsp, true);
     uint8_t *sp = stack_top;
 
-    char **argv_pointers = (char **)kmalloc(proc->num_arguments * sizeof(char *));
+    char **argv_pointers = (char **)kmalloc((proc->num_arguments ? proc->num_arguments : 1) * sizeof(char *));
+    char **envar_pointers = (char **)kmalloc((proc->num_envars ? proc->num_envars : 1) * sizeof(char *));
+    if (!argv_pointers || !envar_pointers)
+    {
+        kfree(argv_pointers);
+        kfree(envar_pointers);
+        return -RES_NOMEM;
+    }
 
     for (int i = proc->num_arguments - 1; i >= 0; i--)
     {
@@ -283,8 +550,6 @@ int setup_initial_stack(process_t *proc)
         argv_pointers[i] = (char *)(proc->task.state.rsp - ((uint64_t)stack_top - (uint64_t)sp));
     }
 
-    char **envar_pointers = (char **)kmalloc(proc->num_arguments * sizeof(char *));
-
     for (int i = proc->num_envars - 1; i >= 0; i--)
     {
         size_t len = strlen(proc->envars[i]) + 1;
@@ -325,6 +590,8 @@ int setup_initial_stack(process_t *proc)
     proc->task.state.rdx = proc->num_envars;
     proc->task.state.rcx = (uint64_t)envp_start;
 
+    kfree(argv_pointers);
+    kfree(envar_pointers);
     return RES_SUCCESS;
 }
 
@@ -354,49 +621,6 @@ void *process_allocate_page(process_t *proc)
     return virt;
 }
 
-size_t process_insert_stream(process_t *proc, stream_t *stream)
-{
-    if (!stream)
-    {
-        return 0;
-    }
-
-    for (size_t i = 0; i < PROCESS_MAX_STREAMS; i++)
-    {
-        if (proc->streams[i] == NULL)
-        {
-            proc->streams[i] = stream;
-            return i;
-        }
-    }
-
-    return 0;
-}
-
-size_t process_insert_file(process_t *proc, const char *path, uint8_t open_action)
-{
-    for (size_t i = 0; i < PROCESS_MAX_STREAMS; i++)
-    {
-        if (proc->streams[i] == NULL)
-        {
-            proc->streams[i] = vfs_open(path, open_action);
-            if (!proc->streams[i])
-            {
-                return 0;
-            }
-            return i;
-        }
-    }
-
-    return 0;
-}
-
-void process_remove_stream(process_t *proc, size_t index)
-{
-    stream_free(proc->streams[index]);
-    proc->streams[index] = NULL;
-}
-
 void process_free(process_t *proc)
 {
     if (!proc)
@@ -413,9 +637,22 @@ void process_free(process_t *proc)
         kfree(proc->arguments);
     }
 
-    if (proc->elf)
+    if (proc->envars != NULL)
+    {
+        for (uint16_t i = 0; i < proc->num_envars; i++)
+        {
+            kfree(proc->envars[i]);
+        }
+        kfree(proc->envars);
+    }
+
+    hrtimer_cancel(&proc->task.timeout);
+    fpu_release(&proc->task);
+    kstack_free(proc->task.kernel_stack);
+
+    if (proc->image)
     {
-        elf_free(proc->elf);
+        image_put(proc->image);
     }
     if (proc->pml4)
     {
@@ -438,23 +675,71 @@ void process_free(process_t *proc)
         kfree(proc->task.stack_pages);
     }
 
-    for (int i = 0; i < PROCESS_MAX_STREAMS; i++)
+    for (size_t i = 0; i < proc->streams_size; i++)
     {
         if (proc->streams[i] != NULL)
         {
             stream_free(proc->streams[i]);
         }
     }
+    kfree(proc->streams);
+    kfree(proc->streams_used);
+
+    io_ring_free(proc);
+    systrace_release(proc);
 
     kfree(proc);
 }
 
 process_t *proc_head = NULL;
-process_t *current_proc = NULL;
+
+static task_t *task_head = NULL;
+static task_t *current_task = NULL;
+static task_t *zombie_head = NULL;
+
+static void task_link(task_t *task)
+{
+    uint64_t flags = cpu_irq_save();
+
+    task->next = NULL;
+    if (!task_head)
+    {
+        task_head = task;
+    }
+    else
+    {
+        task_t *tail = task_head;
+        while (tail->next)
+        {
+            tail = tail->next;
+        }
+        tail->next = task;
+    }
+
+    cpu_irq_restore(flags);
+}
+
+static void task_unlink(task_t *task)
+{
+    uint64_t flags = cpu_irq_save();
+
+    for (task_t **link = &task_head; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == task)
+        {
+            *link = task->next;
+            break;
+        }
+    }
+
+    cpu_irq_restore(flags);
+}
 
 int process_register(process_t *proc)
 {
     proc->next = NULL;
+    task_link(&proc->task);
+
     if (!proc_head)
     {
         proc_head = proc;
@@ -481,14 +766,7 @@ int process_unregister(process_t *proc)
         return -RES_CORRUPT;
     }
 
-    if (current_proc == proc)
-    {
-        current_proc = proc_head;
-        if (proc_head == proc)
-        {
-            current_proc = proc_head->next;
-        }
-    }
+    task_unlink(&proc->task);
 
     if (proc_head == proc)
     {
@@ -528,44 +806,331 @@ int process_unregister(process_t *proc)
 }
 
 void task_execute(uint64_t rip, uint64_t rsp, uint64_t eflags, task_state_t *state);
+void switch_context(uint64_t *save_rsp, uint64_t load_rsp);
+
+extern page_table_t *kernel_pml4;
+
+uint64_t kernel_stack_top = 0; // loaded by syscall_wrapper
+static uint64_t boot_rsp = 0;  // the boot context is never resumed
+
+static task_t *find_next_ready_task(void)
+{
+    // a dead task is no longer linked, so start over at the head
+    task_t *start = (current_task && current_task->status != TASK_STATUS_DEAD && current_task->next) ? current_task->next : task_head;
+    task_t *task = start;
+
+    do
+    {
+        if (task->status == TASK_STATUS_READY)
+        {
+            return task;
+        }
+
+        task = task->next ? task->next : task_head;
+    } while (task != start);
+
+    return NULL;
+}
+
+static void task_free(task_t *task)
+{
+    if (task->proc && task == &task->proc->task)
+    {
+        process_free(task->proc); // the main thread is part of the process
+        return;
+    }
+
+    hrtimer_cancel(&task->timeout);
+    fpu_release(task);
+    kstack_free(task->kernel_stack);
+    kfree(task);
+}
+
+static void reap_zombies(void)
+{
+    while (zombie_head)
+    {
+        task_t *task = zombie_head;
+        zombie_head = task->next;
+        task_free(task);
+    }
+}
+
+void schedule(void)
+{
+    uint64_t flags = cpu_irq_save();
+
+    if (!task_head)
+    {
+        PANIC("no task running");
+    }
+
+    task_t *prev = current_task;
+    task_t *next = find_next_ready_task();
+    while (!next)
+    {
+        // every task is blocked, wait for an interrupt to wake one up
+        __asm__ volatile("sti; hlt; cli");
+        next = find_next_ready_task();
+    }
+
+    scheduler_account_switch(prev, next);
+
+    if (next != prev)
+    {
+        current_task = next;
+        kernel_stack_top = next->kernel_stack;
+        tss_set_rsp0(next->kernel_stack);
+        fpu_switch(next);
+
+        switch_context(prev ? &prev->kernel_rsp : &boot_rsp, next->kernel_rsp);
+
+        // back on our own stack, nothing runs on the stacks of dead tasks anymore
+        reap_zombies();
+    }
+
+    cpu_irq_restore(flags);
+}
+
+static void task_exit(task_t *task)
+{
+    cpu_irq_save();
+
+    task->status = TASK_STATUS_DEAD;
+    hrtimer_cancel(&task->timeout);
+    task_unlink(task);
+
+    // the kernel stack is still in use, it is freed by the next task
+    task->next = zombie_head;
+    zombie_head = task;
+
+    schedule();
+    PANIC("dead task was scheduled");
+}
+
+static void task_entry(void)
+{
+    reap_zombies();
+
+    task_state_t state = current_task->state; // needs to be copied because the task is allocated and not mapped in processes pml4
+
+    if (pml4_switch(current_task->proc->pml4) < 0)
+    {
+        PANIC("failed to switch pml4");
+    }
+
+    // TODO: execute global constructors
+    task_execute(state.rip, state.rsp, 0x202, &state);
+}
+
+static void kthread_entry(void)
+{
+    reap_zombies();
+
+    // schedule switched here with interrupts disabled
+    enable_interrupts();
+
+    current_task->func(current_task->arg);
+    task_exit(current_task);
+}
+
+task_t *kthread_create(void (*func)(void *), void *arg)
+{
+    task_t *task = kmalloc(sizeof(task_t));
+    if (!task)
+    {
+        return NULL;
+    }
+    memset(task, 0, sizeof(task_t));
+
+    if (task_setup(task, NULL, &kthread_entry) < 0)
+    {
+        kfree(task);
+        return NULL;
+    }
+
+    task->func = func;
+    task->arg = arg;
+    task_link(task);
+
+    return task;
+}
 
 int execute_next_process(void)
 {
-    if (!proc_head)
+    if (!task_head)
     {
         return -RES_CORRUPT;
     }
 
-    if (!current_proc)
+    schedule();
+
+    return -RES_CORRUPT; // never executed
+}
+
+static void task_kill(task_t *task)
+{
+    task->status = TASK_STATUS_DEAD;
+    hrtimer_cancel(&task->timeout);
+    futex_cancel(task); // the waiter is on the stack that is about to be freed
+    wait_queue_cancel(task);
+    task_unlink(task);
+
+    task->next = zombie_head;
+    zombie_head = task;
+}
+
+void process_exit(process_t *proc)
+{
+    io_ring_shutdown(proc); // may block until the worker is done with the ring
+
+    cpu_irq_save();
+    process_unregister(proc);
+
+    // the other threads are not running, so they can go right away
+    task_t *self = current_task;
+    for (task_t *thread = proc->threads; thread != NULL; thread = thread->thread_next)
     {
-        current_proc = proc_head;
+        if (thread != self)
+        {
+            task_kill(thread);
+        }
     }
-    else
+    proc->threads = NULL;
+
+    if (self != &proc->task)
+    {
+        task_kill(&proc->task); // frees the process once reaped
+    }
+
+    task_exit(self);
+}
+
+task_t *thread_create(process_t *proc, uint64_t rip, uint64_t rsp, uint64_t arg)
+{
+    task_t *task = kmalloc(sizeof(task_t));
+    if (!task)
+    {
+        return NULL;
+    }
+    memset(task, 0, sizeof(task_t));
+
+    task->state.rip = rip;
+    task->state.rsp = rsp;
+    task->state.rdi = arg;
+
+    if (task_setup(task, proc, &task_entry) < 0)
     {
-        current_proc = current_proc->next;
-        if (!current_proc)
+        kfree(task);
+        return NULL;
+    }
+
+    uint64_t flags = cpu_irq_save();
+    task->thread_next = proc->threads;
+    proc->threads = task;
+    proc->num_threads++;
+    cpu_irq_restore(flags);
+
+    task_link(task);
+
+    return task;
+}
+
+void thread_exit(task_t *task)
+{
+    process_t *proc = task->proc;
+
+    cpu_irq_save();
+
+    if (proc->num_threads == 1)
+    {
+        process_exit(proc); // last one out frees the process
+    }
+    proc->num_threads--;
+
+    for (task_t **link = &proc->threads; *link != NULL; link = &(*link)->thread_next)
+    {
+        if (*link == task)
         {
-            current_proc = proc_head;
+            *link = task->thread_next;
+            break;
         }
     }
 
-    task_state_t state = current_proc->task.state; // needs to be copied because proc is allocated and not mapped in processes pml4
+    if (task->joiner)
+    {
+        task_wakeup(task->joiner);
+    }
 
-    int status = pml4_switch(current_proc->pml4);
-    if (status < 0)
+    if (task == &proc->task)
     {
-        return status;
+        // the main thread is part of the process, its stack is freed together with it
+        task->status = TASK_STATUS_DEAD;
+        hrtimer_cancel(&task->timeout);
+        task_unlink(task);
+        schedule();
+        PANIC("dead task was scheduled");
     }
 
-    // TODO: execute global constructors
-    task_execute(state.rip, state.rsp, 0x202, &state);
+    task_exit(task);
+}
+
+int thread_join(task_t *task, uint64_t tid)
+{
+    uint64_t flags = cpu_irq_save();
 
-    return 0; // never executed
+    task_t *thread = task->proc->threads;
+    while (thread && thread->tid != tid)
+    {
+        thread = thread->thread_next;
+    }
+
+    if (!thread)
+    {
+        // already gone
+        cpu_irq_restore(flags);
+        return RES_SUCCESS;
+    }
+
+    if (thread == task || thread->joiner)
+    {
+        cpu_irq_restore(flags);
+        return -RES_INVARG;
+    }
+
+    thread->joiner = task;
+    task->status = TASK_STATUS_BLOCKED;
+    schedule();
+
+    cpu_irq_restore(flags);
+    return RES_SUCCESS;
 }
 
 process_t *get_current_process(void)
 {
-    return current_proc;
+    return current_task ? current_task->proc : NULL;
+}
+
+task_t *get_current_task(void)
+{
+    return current_task;
+}
+
+void task_wakeup(task_t *task)
+{
+    if (task->status != TASK_STATUS_BLOCKED)
+    {
+        return;
+    }
+
+    task->wake_time = time_get_ns();
+    task->status = TASK_STATUS_READY;
+
+    // bottom halves should not wait for the next tick
+    if (!task->proc)
+    {
+        set_need_resched();
+    }
 }
 
 process_t *get_process_from_pid(uint64_t pid)
@@ -0,0 +1,120 @@
+#include <kernel/proc/uaccess.h>
+#include <kernel/string.h>
+#include <kernel/kmm.h>
+
+// returns the identity mapped address of vaddr and how many bytes are left in its page
+static uint8_t *user_translate(process_t *proc, uintptr_t vaddr, bool write, size_t *avail)
+{
+    uint64_t entry = pml4_get_entry(proc->pml4, (void *)vaddr);
+    if (!(entry & PAGE_USER))
+    {
+        return NULL;
+    }
+
+    // read only frames are shared with other processes
+    if (write && !(entry & PAGE_WRITABLE))
+    {
+        return NULL;
+    }
+
+    *avail = PAGE_SIZE - vaddr % PAGE_SIZE;
+    return (uint8_t *)(pml4_get_phys(proc->pml4, (void *)vaddr, true));
+}
+
+KRES copy_from_user(process_t *proc, void *dest, uintptr_t src, size_t size)
+{
+    if (src + size < src)
+    {
+        return -RES_INVARG;
+    }
+
+    while (size > 0)
+    {
+        size_t avail;
+        uint8_t *p = user_translate(proc, src, false, &avail);
+        if (!p)
+        {
+            return -RES_INVARG;
+        }
+
+        size_t len = size < avail ? size : avail;
+        memcpy(dest, p, len);
+        dest = (uint8_t *)dest + len;
+        src += len;
+        size -= len;
+    }
+
+    return RES_SUCCESS;
+}
+
+KRES copy_to_user(process_t *proc, uintptr_t dest, const void *src, size_t size)
+{
+    if (dest + size < dest)
+    {
+        return -RES_INVARG;
+    }
+
+    while (size > 0)
+    {
+        size_t avail;
+        uint8_t *p = user_translate(proc, dest, true, &avail);
+        if (!p)
+        {
+            return -RES_INVARG;
+        }
+
+        size_t len = size < avail ? size : avail;
+        memcpy(p, src, len);
+        src = (const uint8_t *)src + len;
+        dest += len;
+        size -= len;
+    }
+
+    return RES_SUCCESS;
+}
+
+int64_t strncpy_from_user(process_t *proc, char *dest, uintptr_t src, size_t size)
+{
+    size_t copied = 0;
+    while (copied < size)
+    {
+        size_t avail;
+        uint8_t *p = user_translate(proc, src + copied, false, &avail);
+        if (!p)
+        {
+            return -RES_INVARG;
+        }
+
+        for (size_t i = 0; i < avail && copied < size; i++)
+        {
+            dest[copied] = p[i];
+            if (p[i] == '\0')
+            {
+                return (int64_t)copied;
+            }
+            copied++;
+        }
+    }
+
+    return -RES_OVERFLOW; // not terminated within size
+}
+
+char *strdup_from_user(process_t *proc, uintptr_t src, size_t max)
+{
+    char *buf = kmalloc(max);
+    if (!buf)
+    {
+        return NULL;
+    }
+
+    int64_t len = strncpy_from_user(proc, buf, src, max);
+    if (len < 0)
+    {
+        kfree(buf);
+        return NULL;
+    }
+
+    char *res = strdup(buf);
+    kfree(buf);
+    return res;
+}
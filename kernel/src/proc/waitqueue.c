@@ -0,0 +1,96 @@
+#include <kernel/proc/waitqueue.h>
+#include <kernel/proc/task.h>
+
+void wait_queue_init(wait_queue_t *queue)
+{
+    queue->head = NULL;
+}
+
+void wait_queue_add(wait_queue_t *queue, wait_entry_t *entry, task_t *task)
+{
+    entry->task = task;
+    entry->queue = queue;
+    entry->woken = false;
+    entry->func = NULL;
+    entry->data = NULL;
+
+    entry->next = queue->head;
+    queue->head = entry;
+
+    entry->task_next = task->wait_entries;
+    task->wait_entries = entry;
+}
+
+void wait_queue_add_callback(wait_queue_t *queue, wait_entry_t *entry, void (*func)(wait_entry_t *entry), void *data)
+{
+    entry->task = NULL;
+    entry->queue = queue;
+    entry->woken = false;
+    entry->func = func;
+    entry->data = data;
+
+    entry->next = queue->head;
+    queue->head = entry;
+    entry->task_next = NULL;
+}
+
+void wait_queue_remove(wait_entry_t *entry)
+{
+    for (wait_entry_t **link = &entry->queue->head; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == entry)
+        {
+            *link = entry->next;
+            break;
+        }
+    }
+
+    if (!entry->task)
+    {
+        return;
+    }
+
+    for (wait_entry_t **link = &entry->task->wait_entries; *link != NULL; link = &(*link)->task_next)
+    {
+        if (*link == entry)
+        {
+            *link = entry->task_next;
+            break;
+        }
+    }
+}
+
+void wait_queue_sleep(wait_queue_t *queue, task_t *task)
+{
+    wait_entry_t entry;
+    wait_queue_add(queue, &entry, task);
+
+    task->status = TASK_STATUS_BLOCKED;
+    schedule();
+
+    wait_queue_remove(&entry);
+}
+
+void wait_queue_wake_all(wait_queue_t *queue)
+{
+    for (wait_entry_t *entry = queue->head; entry != NULL; entry = entry->next)
+    {
+        entry->woken = true;
+        if (entry->func)
+        {
+            entry->func(entry);
+        }
+        else
+        {
+            task_wakeup(entry->task);
+        }
+    }
+}
+
+void wait_queue_cancel(task_t *task)
+{
+    while (task->wait_entries != NULL)
+    {
+        wait_queue_remove(task->wait_entries);
+    }
+}
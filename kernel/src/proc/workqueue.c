@@ -0,0 +1,128 @@
+#include <kernel/proc/workqueue.h>
+#include <kernel/proc/task.h>
+#include <kernel/proc/scheduler.h>
+#include <kernel/cpu.h>
+
+static work_t *work_head = NULL;
+static work_t *work_tail = NULL;
+static task_t *worker = NULL;
+
+static void worker_thread(void *)
+{
+    while (1)
+    {
+        uint64_t flags = cpu_irq_save();
+
+        work_t *work = work_head;
+        if (!work)
+        {
+            // interrupts stay disabled until we are off the cpu, so no wakeup is lost
+            worker->status = TASK_STATUS_BLOCKED;
+            schedule();
+            cpu_irq_restore(flags);
+            continue;
+        }
+
+        work_head = work->next;
+        if (!work_head)
+        {
+            work_tail = NULL;
+        }
+        work->pending = false; // may be queued again while it runs
+
+        cpu_irq_restore(flags);
+
+        work->func(work);
+        cond_resched();
+    }
+}
+
+int workqueue_init(void)
+{
+    worker = kthread_create(&worker_thread, NULL);
+    if (!worker)
+    {
+        return -RES_NOMEM;
+    }
+
+    return RES_SUCCESS;
+}
+
+void work_init(work_t *work, void (*func)(work_t *work), void *data)
+{
+    work->func = func;
+    work->data = data;
+    work->pending = false;
+    work->next = NULL;
+}
+
+bool work_queue(work_t *work)
+{
+    uint64_t flags = cpu_irq_save();
+
+    if (work->pending)
+    {
+        cpu_irq_restore(flags);
+        return false;
+    }
+
+    work->pending = true;
+    work->next = NULL;
+    if (work_tail)
+    {
+        work_tail->next = work;
+    }
+    else
+    {
+        work_head = work;
+    }
+    work_tail = work;
+
+    if (worker)
+    {
+        task_wakeup(worker);
+    }
+
+    cpu_irq_restore(flags);
+    return true;
+}
+
+bool work_cancel(work_t *work)
+{
+    uint64_t flags = cpu_irq_save();
+
+    if (!work->pending)
+    {
+        cpu_irq_restore(flags);
+        return false;
+    }
+
+    work_t *prev = NULL;
+    for (work_t *item = work_head; item; prev = item, item = item->next)
+    {
+        if (item != work)
+        {
+            continue;
+        }
+
+        if (prev)
+        {
+            prev->next = work->next;
+        }
+        else
+        {
+            work_head = work->next;
+        }
+        if (work_tail == work)
+        {
+            work_tail = prev;
+        }
+        break;
+    }
+
+    work->pending = false;
+    work->next = NULL;
+
+    cpu_irq_restore(flags);
+    return true;
+}
@@ -0,0 +1,161 @@
+#include <kernel/hrtimer.h>
+#include <kernel/time.h>
+#include <kernel/kmm.h>
+#include <kernel/cpu.h>
+
+// binary min-heap ordered by expiry
+static hrtimer_t **heap = NULL;
+static size_t heap_size = 0;
+static size_t heap_capacity = 0;
+
+static void heap_swap(size_t a, size_t b)
+{
+    hrtimer_t *tmp = heap[a];
+    heap[a] = heap[b];
+    heap[b] = tmp;
+
+    heap[a]->index = a;
+    heap[b]->index = b;
+}
+
+static void heap_up(size_t i)
+{
+    while (i > 0)
+    {
+        size_t parent = (i - 1) / 2;
+        if (heap[parent]->expires <= heap[i]->expires)
+        {
+            break;
+        }
+
+        heap_swap(parent, i);
+        i = parent;
+    }
+}
+
+static void heap_down(size_t i)
+{
+    while (1)
+    {
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        size_t smallest = i;
+
+        if (left < heap_size && heap[left]->expires < heap[smallest]->expires)
+        {
+            smallest = left;
+        }
+        if (right < heap_size && heap[right]->expires < heap[smallest]->expires)
+        {
+            smallest = right;
+        }
+        if (smallest == i)
+        {
+            break;
+        }
+
+        heap_swap(i, smallest);
+        i = smallest;
+    }
+}
+
+static void heap_remove(size_t i)
+{
+    hrtimer_t *timer = heap[i];
+    size_t last = --heap_size;
+
+    if (i != last)
+    {
+        heap_swap(i, last);
+        heap_down(i);
+        heap_up(i);
+    }
+
+    heap[last] = NULL;
+    timer->active = false;
+}
+
+void hrtimer_init(hrtimer_t *timer, void (*func)(hrtimer_t *timer), void *data)
+{
+    timer->expires = 0;
+    timer->func = func;
+    timer->data = data;
+    timer->index = 0;
+    timer->active = false;
+}
+
+KRES hrtimer_start(hrtimer_t *timer, uint64_t expires)
+{
+    if (!timer || !timer->func)
+    {
+        return -RES_INVARG;
+    }
+
+    uint64_t flags = cpu_irq_save();
+
+    if (timer->active)
+    {
+        heap_remove(timer->index);
+    }
+
+    if (heap_size >= heap_capacity)
+    {
+        size_t new_capacity = heap_capacity ? heap_capacity * 2 : 32;
+        hrtimer_t **new_heap = krealloc(heap, heap_capacity * sizeof(hrtimer_t *), new_capacity * sizeof(hrtimer_t *));
+        if (!new_heap)
+        {
+            cpu_irq_restore(flags);
+            return -RES_NOMEM;
+        }
+
+        heap = new_heap;
+        heap_capacity = new_capacity;
+    }
+
+    timer->expires = expires;
+    timer->index = heap_size;
+    timer->active = true;
+    heap[heap_size++] = timer;
+    heap_up(timer->index);
+
+    bool first = timer->index == 0;
+
+    cpu_irq_restore(flags);
+
+    if (first)
+    {
+        clockevent_reprogram();
+    }
+
+    return RES_SUCCESS;
+}
+
+void hrtimer_cancel(hrtimer_t *timer)
+{
+    if (!timer)
+    {
+        return;
+    }
+
+    uint64_t flags = cpu_irq_save();
+    if (timer->active)
+    {
+        heap_remove(timer->index);
+    }
+    cpu_irq_restore(flags);
+}
+
+uint64_t hrtimer_next_expiry(void)
+{
+    return heap_size ? heap[0]->expires : UINT64_MAX;
+}
+
+void hrtimer_run(uint64_t now)
+{
+    while (heap_size > 0 && heap[0]->expires <= now)
+    {
+        hrtimer_t *timer = heap[0];
+        heap_remove(0);
+        timer->func(timer);
+    }
+}
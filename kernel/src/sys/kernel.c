@@ -12,9 +12,15 @@
 #include <kernel/fs/vpt.h>
 #include <kernel/fs/vfs.h>
 #include <kernel/fs/devfs.h>
+#include <kernel/fs/pcache.h>
 #include <kernel/proc/task.h>
 #include <kernel/proc/scheduler.h>
 #include <kernel/pit.h>
+#include <kernel/lapic.h>
+#include <kernel/time.h>
+#include <kernel/fpu.h>
+#include <kernel/proc/kstack.h>
+#include <kernel/proc/workqueue.h>
 
 extern driver_t e9_driver;
 extern driver_t vga_driver;
@@ -262,6 +268,18 @@ void early_init(uint32_t multiboot_signature, uint64_t multiboot_information_str
         PANIC("failed to initialize kernel heap");
     }
 
+    pcache_init();
+
+    if (IS_ERROR(kstack_init(kernel_pml4)))
+    {
+        PANIC("failed to initialize kernel stacks");
+    }
+
+    if (IS_ERROR(fpu_init()))
+    {
+        PANIC("failed to initialize fpu");
+    }
+
     if (IS_ERROR(pci_init()))
     {
         PANIC("failed to initialize pci");
@@ -272,10 +290,25 @@ void early_init(uint32_t multiboot_signature, uint64_t multiboot_information_str
         PANIC("failed to initialize interrupts");
     }
 
+    if (IS_ERROR(lapic_init(kernel_pml4)))
+    {
+        PANIC("failed to initialize local apic");
+    }
+
     if (IS_ERROR(pit_init(100)))
     {
         PANIC("failed to initialize pit");
     }
+
+    if (IS_ERROR(time_init()))
+    {
+        PANIC("failed to initialize timekeeping");
+    }
+
+    if (IS_ERROR(workqueue_init()))
+    {
+        PANIC("failed to initialize workqueue");
+    }
     
     enable_interrupts();
     
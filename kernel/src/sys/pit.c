@@ -1,5 +1,6 @@
 #include <kernel/pit.h>
 #include <kernel/port.h>
+#include <kernel/time.h>
 
 #define MAX_PIT_HANDLERS 255
 
@@ -7,16 +8,16 @@ void (*pit_handlers[MAX_PIT_HANDLERS])(interrupt_frame_t *frame, uint32_t freque
 uint8_t num_pit_handlers = 0;
 
 static uint32_t _frequency;
-static uint64_t sleep_ticks = 0;
+static volatile uint64_t ticks = 0;
 
 static void timer_irq(interrupt_frame_t *frame)
 {
+    ticks++; // before the handlers, the scheduler may switch away
+
     for (uint8_t i = 0; i < num_pit_handlers; i++)
     {
         pit_handlers[i](frame, _frequency);
     }
-
-    sleep_ticks++;
 }
 
 int pit_init(uint32_t frequency)
@@ -48,10 +49,17 @@ void register_pit_handler(void (*func)(interrupt_frame_t *frame, uint32_t freque
     pit_handlers[num_pit_handlers++] = func;
 }
 
+uint64_t pit_get_ticks(void)
+{
+    return ticks;
+}
+
 void sleep(uint64_t ms)
 {
-    uint64_t ticks_needed = (_frequency * ms) / 1000;
-    sleep_ticks = 0;
+    uint64_t end = time_get_ns() + ms * NSEC_PER_MSEC;
 
-    while (sleep_ticks < ticks_needed);
+    while (time_get_ns() < end)
+    {
+        __asm__ volatile("pause");
+    }
 }
@@ -10,6 +10,8 @@ struct
     uint64_t max_addr;
 } page_allocator;
 
+static size_t (*reclaim_func)(size_t num_pages) = NULL;
+
 static void bit_set(uint64_t *bitmap, uint64_t index)
 {
     uint64_t array_index = index / 64;
@@ -90,9 +92,9 @@ void pmm_reserve(uint64_t *page)
     bit_set(page_allocator.bitmap, (uintptr_t)page / PAGE_SIZE);
 }
 
-void *pmm_alloc(void)
+static void *pmm_find(uint64_t start, uint64_t end)
 {
-    for (uint64_t i = page_allocator.last_index; i < page_allocator.num_pages; i++)
+    for (uint64_t i = start; i < end; i++)
     {
         if (bit_get(page_allocator.bitmap, i))
             continue;
@@ -103,10 +105,39 @@ void *pmm_alloc(void)
         return (void *)(i * PAGE_SIZE);
     }
 
+    return NULL;
+}
+
+void *pmm_alloc(void)
+{
+    while (true)
+    {
+        void *page = pmm_find(page_allocator.last_index, page_allocator.num_pages);
+        if (!page)
+        {
+            page = pmm_find(0, page_allocator.last_index);
+        }
+        if (page)
+        {
+            return page;
+        }
+
+        // caches give memory back before the allocation fails for good
+        if (!reclaim_func || reclaim_func(1) == 0)
+        {
+            break;
+        }
+    }
+
     PANIC("page allocation failed");
     return NULL;
 }
 
+void pmm_set_reclaim(size_t (*reclaim)(size_t num_pages))
+{
+    reclaim_func = reclaim;
+}
+
 void *pmm_alloc_contiguous(size_t num_pages)
 {
     if (num_pages == 0 || num_pages > page_allocator.num_pages)
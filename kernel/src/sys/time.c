@@ -0,0 +1,275 @@
+#include <kernel/time.h>
+#include <kernel/hrtimer.h>
+#include <kernel/lapic.h>
+#include <kernel/cpu.h>
+#include <kernel/pit.h>
+#include <kernel/port.h>
+#include <kernel/pmm.h>
+#include <kernel/string.h>
+#include <kernel/log.h>
+
+#define PIT_FREQUENCY 1193182
+#define CALIBRATION_MS 10
+#define CALIBRATION_RUNS 3
+
+#define TICK_NS (NSEC_PER_SEC / TIME_TICK_HZ)
+
+#define MAX_TICK_HANDLERS 16
+
+#define CPUID_EXT_EDX_INVARIANT_TSC (1 << 8)
+
+static uint64_t tsc_frequency = 0;
+static uint64_t tsc_base = 0;
+static uint32_t tsc_mult = 0;
+static uint32_t tsc_shift = 0;
+
+static time_page_t *time_page = NULL;
+
+static bool clockevent_active = false;
+static uint64_t next_tick = 0;
+
+static void (*tick_handlers[MAX_TICK_HANDLERS])(interrupt_frame_t *frame);
+static uint8_t num_tick_handlers = 0;
+
+// counts the tsc while pit channel 2 counts down CALIBRATION_MS
+static uint64_t calibrate_tsc_once(void)
+{
+    uint16_t latch = PIT_FREQUENCY * CALIBRATION_MS / 1000;
+
+    port_byte_out(0x61, (port_byte_in(0x61) & ~0x02) | 0x01); // gate high, speaker off
+    port_byte_out(0x43, 0xB0);                                 // channel 2, lobyte/hibyte, mode 0
+    port_byte_out(0x42, latch & 0xFF);
+    port_byte_out(0x42, latch >> 8);
+
+    uint64_t start = cpu_read_tsc();
+    while (!(port_byte_in(0x61) & 0x20));
+    uint64_t end = cpu_read_tsc();
+
+    return (end - start) * (1000 / CALIBRATION_MS);
+}
+
+static uint64_t calibrate_tsc(void)
+{
+    // interruptions only make a run longer, so the smallest result is the most accurate
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < CALIBRATION_RUNS; i++)
+    {
+        uint64_t freq = calibrate_tsc_once();
+        if (freq < best)
+        {
+            best = freq;
+        }
+    }
+
+    return best == UINT64_MAX ? 0 : best;
+}
+
+static inline uint64_t tsc_to_ns(uint64_t delta)
+{
+    return (uint64_t)(((unsigned __int128)delta * tsc_mult) >> tsc_shift);
+}
+
+uint64_t time_get_ns(void)
+{
+    if (!tsc_frequency)
+    {
+        return pit_get_ticks() * (NSEC_PER_SEC / pit_get_frequency());
+    }
+
+    return tsc_to_ns(cpu_read_tsc() - tsc_base);
+}
+
+uint64_t time_get_tsc_frequency(void)
+{
+    return tsc_frequency;
+}
+
+uint64_t time_tsc_to_ns(uint64_t cycles)
+{
+    if (!tsc_frequency)
+    {
+        return 0;
+    }
+
+    return tsc_to_ns(cycles);
+}
+
+void *time_get_page(void)
+{
+    return time_page;
+}
+
+static void time_page_update(void)
+{
+    if (!time_page)
+    {
+        return;
+    }
+
+    uint64_t flags = cpu_irq_save();
+
+    time_page->seq++; // odd while the parameters are inconsistent
+    __sync_synchronize();
+
+    time_page->valid = tsc_frequency != 0;
+    time_page->mult = tsc_mult;
+    time_page->shift = tsc_shift;
+    time_page->tsc_base = tsc_base;
+    time_page->ns_base = 0;
+    time_page->tsc_frequency = tsc_frequency;
+
+    __sync_synchronize();
+    time_page->seq++;
+
+    cpu_irq_restore(flags);
+}
+
+void register_tick_handler(void (*func)(interrupt_frame_t *frame))
+{
+    if (num_tick_handlers >= MAX_TICK_HANDLERS)
+    {
+        PANIC("too many tick handlers");
+    }
+
+    tick_handlers[num_tick_handlers++] = func;
+}
+
+static void run_tick_handlers(interrupt_frame_t *frame)
+{
+    for (uint8_t i = 0; i < num_tick_handlers; i++)
+    {
+        tick_handlers[i](frame);
+    }
+}
+
+static void clockevent_program(void)
+{
+    uint64_t next = next_tick;
+    uint64_t timer = hrtimer_next_expiry();
+    if (timer < next)
+    {
+        next = timer;
+    }
+
+    uint64_t now = time_get_ns();
+    lapic_timer_oneshot(next > now ? next - now : 0);
+}
+
+void clockevent_reprogram(void)
+{
+    if (!clockevent_active)
+    {
+        return;
+    }
+
+    uint64_t flags = cpu_irq_save();
+    clockevent_program();
+    cpu_irq_restore(flags);
+}
+
+static void clockevent_irq(interrupt_frame_t *frame)
+{
+    uint64_t now = time_get_ns();
+    hrtimer_run(now);
+
+    bool tick = now >= next_tick;
+    if (tick)
+    {
+        next_tick += TICK_NS;
+        if (next_tick <= now)
+        {
+            next_tick = now + TICK_NS;
+        }
+    }
+
+    // rearm before the tick handlers, the scheduler may switch away before it returns
+    clockevent_program();
+
+    if (tick)
+    {
+        run_tick_handlers(frame);
+    }
+}
+
+// fallback when there is no usable lapic timer, everything runs at pit resolution
+static void pit_tick(interrupt_frame_t *frame, uint32_t)
+{
+    if (clockevent_active)
+    {
+        return;
+    }
+
+    hrtimer_run(time_get_ns());
+    run_tick_handlers(frame);
+}
+
+static void compute_tsc_scale(void)
+{
+    // ns = (tsc * mult) >> shift, pick the largest shift that keeps mult in 32 bits
+    for (tsc_shift = 32; tsc_shift > 0; tsc_shift--)
+    {
+        uint64_t mult = (NSEC_PER_SEC << tsc_shift) / tsc_frequency;
+        if (mult <= UINT32_MAX)
+        {
+            tsc_mult = (uint32_t)mult;
+            break;
+        }
+    }
+}
+
+int time_init(void)
+{
+    uint32_t max_ext, edx = 0;
+    cpu_cpuid(0x80000000, 0, &max_ext, NULL, NULL, NULL);
+    if (max_ext >= 0x80000007)
+    {
+        cpu_cpuid(0x80000007, 0, NULL, NULL, NULL, &edx);
+    }
+    if (!(edx & CPUID_EXT_EDX_INVARIANT_TSC))
+    {
+        LOG_WARNING("tsc is not invariant, time may drift with frequency changes");
+    }
+
+    tsc_frequency = calibrate_tsc();
+    if (tsc_frequency)
+    {
+        compute_tsc_scale();
+        tsc_base = cpu_read_tsc();
+        LOG_INFO("tsc calibrated to %ld kHz", tsc_frequency / 1000);
+    }
+    else
+    {
+        LOG_WARNING("tsc calibration failed, using the pit as clocksource");
+    }
+
+    time_page = pmm_alloc();
+    if (!time_page)
+    {
+        return -RES_NOMEM;
+    }
+    memset(time_page, 0, PAGE_SIZE);
+    time_page_update();
+
+    register_pit_handler(&pit_tick);
+
+    if (register_interrupt_handler(LAPIC_TIMER_VECTOR, &clockevent_irq) < 0)
+    {
+        return -RES_EUNKNOWN;
+    }
+
+    if (tsc_frequency && lapic_timer_init(tsc_frequency) == RES_SUCCESS)
+    {
+        clockevent_active = true;
+        next_tick = time_get_ns() + TICK_NS;
+        clockevent_program();
+
+        // the pit is only needed as fallback, mask irq 0
+        port_byte_out(0x21, port_byte_in(0x21) | 0x01);
+    }
+    else
+    {
+        LOG_WARNING("no lapic timer, using the pit as clockevent");
+    }
+
+    return RES_SUCCESS;
+}
@@ -0,0 +1,89 @@
+// types passed through syscalls, pasted into both generated headers
+
+typedef struct
+{
+    const char **args;
+    size_t num_args;
+
+    const char **envars;
+    size_t num_envars;
+
+    uint64_t stdin_idx;
+    uint64_t stdout_idx;
+    uint64_t stderr_idx;
+} __attribute__((packed)) process_create_info_t;
+
+typedef struct
+{
+    void *base;
+    size_t len;
+} __attribute__((packed)) iovec_t;
+
+#define SYSTRACE_STATS (1 << 0)   // count calls and keep latency histograms
+#define SYSTRACE_EVENTS (1 << 1)  // record every call in the trace buffer
+#define SYSTRACE_INHERIT (1 << 2) // processes created by the traced process are traced as well
+
+#define SYSCALL_LATENCY_BUCKETS 16 // bucket i counts latencies below 2^(i + 8) nanoseconds, the last one everything above
+
+typedef struct
+{
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t histogram[SYSCALL_LATENCY_BUCKETS];
+} __attribute__((packed)) syscall_stat_t;
+
+typedef struct
+{
+    uint64_t dropped; // events overwritten before they were read
+    syscall_stat_t calls[SYSCALL_COUNT];
+} __attribute__((packed)) syscall_stats_t;
+
+typedef struct
+{
+    uint64_t time_ns; // at entry
+    uint64_t duration_ns;
+    uint64_t tid;
+    uint32_t num;
+    uint32_t reserved;
+    int64_t args[6];
+    int64_t result;
+} __attribute__((packed)) syscall_trace_record_t;
+
+#define POLLIN (1 << 0)   // a read would not block
+#define POLLOUT (1 << 2)  // a write would not block
+#define POLLERR (1 << 3)  // every read end of the pipe is closed, always reported
+#define POLLHUP (1 << 4)  // every write end of the pipe is closed, always reported
+#define POLLNVAL (1 << 5) // not an open stream
+
+typedef struct
+{
+    int32_t fd; // negative entries are skipped
+    int16_t events;
+    int16_t revents;
+} __attribute__((packed)) poll_fd_t;
+
+#define EPOLL_CTL_ADD 1
+#define EPOLL_CTL_DEL 2
+#define EPOLL_CTL_MOD 3
+
+typedef struct
+{
+    uint32_t events; // POLL* flags
+    uint64_t data;   // handed back untouched
+} __attribute__((packed)) epoll_event_t;
+
+#define F_GETFL 1 // returns the O_* flags of the stream
+#define F_SETFL 2 // replaces the O_* flags of the stream
+
+#define O_NONBLOCK (1 << 0) // reads and writes fail with RES_WOULDBLOCK instead of waiting
+
+typedef struct
+{
+    uint64_t hits; // file pages served from memory
+    uint64_t misses; // file pages read from the filesystem
+    uint64_t evictions; // pages dropped to make room or under memory pressure
+    uint64_t pages; // pages currently cached
+    uint64_t readahead; // pages prefetched for sequential readers
+    uint64_t readahead_hits; // prefetched pages that were read afterwards
+} __attribute__((packed)) pcache_stats_t;
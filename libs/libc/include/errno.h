@@ -0,0 +1,28 @@
+#ifndef _ERRNO_H
+#define _ERRNO_H 1
+
+/*
+    https://pubs.opengroup.org/onlinepubs/7908799/xsh/errno.h.html
+    numbers match the strerror table, there is no errno variable yet
+*/
+
+#define EPERM 1
+#define ENOENT 2
+#define ESRCH 3
+#define EINTR 4
+#define EIO 5
+#define EBADF 9
+#define EAGAIN 11
+#define ENOMEM 12
+#define EACCES 13
+#define EFAULT 14
+#define EBUSY 16
+#define EEXIST 17
+#define EINVAL 22
+#define ENOSPC 28
+#define ESPIPE 29
+#define EPIPE 32
+#define ERANGE 34
+#define ETIMEDOUT 60
+
+#endif
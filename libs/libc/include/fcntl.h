@@ -0,0 +1,16 @@
+#ifndef _FCNTL_H
+#define _FCNTL_H 1
+
+/*
+    https://pubs.opengroup.org/onlinepubs/7908799/xsh/fcntl.h.html
+*/
+
+#define F_GETFL 1
+#define F_SETFL 2
+
+#define O_NONBLOCK (1 << 0)
+
+// only F_GETFL and F_SETFL are supported, the third argument is the new flags
+int fcntl(int fildes, int cmd, ...);
+
+#endif
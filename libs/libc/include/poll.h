@@ -0,0 +1,26 @@
+#ifndef _POLL_H
+#define _POLL_H 1
+
+/*
+    https://pubs.opengroup.org/onlinepubs/7908799/xsh/poll.h.html
+*/
+
+#define POLLIN (1 << 0)
+#define POLLOUT (1 << 2)
+#define POLLERR (1 << 3)
+#define POLLHUP (1 << 4)
+#define POLLNVAL (1 << 5)
+
+typedef unsigned int nfds_t;
+
+struct pollfd
+{
+    int fd;
+    short events;
+    short revents;
+};
+
+// timeout is in milliseconds, -1 waits forever
+int poll(struct pollfd fds[], nfds_t nfds, int timeout);
+
+#endif
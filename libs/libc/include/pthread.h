@@ -0,0 +1,66 @@
+#ifndef _PTHREAD_H
+#define _PTHREAD_H 1
+
+/*
+    https://pubs.opengroup.org/onlinepubs/7908799/xsh/pthread.h.html
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct _pthread *pthread_t;
+
+typedef struct
+{
+    size_t stack_size;
+} pthread_attr_t;
+
+typedef struct
+{
+    volatile uint32_t state;
+} pthread_mutex_t;
+
+typedef struct
+{
+    int unused;
+} pthread_mutexattr_t;
+
+typedef struct
+{
+    volatile uint32_t seq;
+} pthread_cond_t;
+
+typedef struct
+{
+    int unused;
+} pthread_condattr_t;
+
+#define PTHREAD_STACK_MIN 4096
+#define PTHREAD_STACK_DEFAULT (64 * 1024)
+
+#define PTHREAD_MUTEX_INITIALIZER {0}
+#define PTHREAD_COND_INITIALIZER {0}
+
+int pthread_attr_init(pthread_attr_t *attr);
+int pthread_attr_destroy(pthread_attr_t *attr);
+int pthread_attr_setstacksize(pthread_attr_t *attr, size_t stacksize);
+
+int pthread_create(pthread_t *thread, const pthread_attr_t *attr, void *(*start_routine)(void *), void *arg);
+int pthread_join(pthread_t thread, void **value_ptr);
+void pthread_exit(void *value_ptr);
+pthread_t pthread_self(void);
+int pthread_equal(pthread_t t1, pthread_t t2);
+
+int pthread_mutex_init(pthread_mutex_t *mutex, const pthread_mutexattr_t *attr);
+int pthread_mutex_destroy(pthread_mutex_t *mutex);
+int pthread_mutex_lock(pthread_mutex_t *mutex);
+int pthread_mutex_trylock(pthread_mutex_t *mutex);
+int pthread_mutex_unlock(pthread_mutex_t *mutex);
+
+int pthread_cond_init(pthread_cond_t *cond, const pthread_condattr_t *attr);
+int pthread_cond_destroy(pthread_cond_t *cond);
+int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex);
+int pthread_cond_signal(pthread_cond_t *cond);
+int pthread_cond_broadcast(pthread_cond_t *cond);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef _SYS_EPOLL_H
+#define _SYS_EPOLL_H 1
+
+#include <stdint.h>
+
+#define EPOLLIN (1 << 0)
+#define EPOLLOUT (1 << 2)
+#define EPOLLERR (1 << 3)
+#define EPOLLHUP (1 << 4)
+
+#define EPOLL_CTL_ADD 1
+#define EPOLL_CTL_DEL 2
+#define EPOLL_CTL_MOD 3
+
+typedef union epoll_data
+{
+    void *ptr;
+    int fd;
+    uint32_t u32;
+    uint64_t u64;
+} epoll_data_t;
+
+struct epoll_event
+{
+    uint32_t events;
+    epoll_data_t data;
+} __attribute__((packed));
+
+// size is only checked to be positive, the interest set grows as needed
+int epoll_create(int size);
+int epoll_ctl(int epfd, int op, int fd, struct epoll_event *event);
+// level triggered, timeout is in milliseconds, -1 waits forever
+int epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout);
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef _SYS_SENDFILE_H
+#define _SYS_SENDFILE_H 1
+
+#include <sys/types.h>
+
+// copies between two streams without a user buffer, offset NULL reads from the position of in_fd
+ssize_t sendfile(int out_fd, int in_fd, off_t *offset, size_t count);
+
+#endif
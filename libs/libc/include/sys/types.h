@@ -0,0 +1,14 @@
+#ifndef _SYS_TYPES_H
+#define _SYS_TYPES_H 1
+
+/*
+    https://pubs.opengroup.org/onlinepubs/7908799/xsh/systypes.h.html
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int64_t ssize_t;
+typedef int64_t off_t;
+
+#endif
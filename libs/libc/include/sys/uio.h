@@ -0,0 +1,20 @@
+#ifndef _SYS_UIO_H
+#define _SYS_UIO_H 1
+
+/*
+    https://pubs.opengroup.org/onlinepubs/7908799/xsh/sysuio.h.html
+*/
+
+#include <sys/types.h>
+
+struct iovec
+{
+    void *iov_base;
+    size_t iov_len;
+};
+
+// stream handles are the values returned by fopen
+ssize_t readv(int fildes, const struct iovec *iov, int iovcnt);
+ssize_t writev(int fildes, const struct iovec *iov, int iovcnt);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef _TIME_H
+#define _TIME_H 1
+
+/*
+    https://pubs.opengroup.org/onlinepubs/7908799/xsh/time.h.html
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int64_t time_t;
+typedef int clockid_t;
+
+struct timespec
+{
+    time_t tv_sec;
+    long tv_nsec;
+};
+
+#define CLOCK_REALTIME 0
+#define CLOCK_MONOTONIC 1
+
+int clock_gettime(clockid_t clock_id, struct timespec *tp);
+int nanosleep(const struct timespec *rqtp, struct timespec *rmtp);
+
+#endif
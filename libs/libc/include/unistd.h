@@ -0,0 +1,15 @@
+#ifndef _UNISTD_H
+#define _UNISTD_H 1
+
+/*
+    https://pubs.opengroup.org/onlinepubs/7908799/xsh/unistd.h.html
+*/
+
+#include <sys/types.h>
+
+int pipe(int fildes[2]);
+
+ssize_t pread(int fildes, void *buf, size_t nbyte, off_t offset);
+ssize_t pwrite(int fildes, const void *buf, size_t nbyte, off_t offset);
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef _LIBC_PRIVAT_LOCK_H
+#define _LIBC_PRIVAT_LOCK_H
+
+#include <stdint.h>
+
+int syscall_futex_wait(volatile uint32_t *addr, uint32_t val, uint64_t timeout_ns);
+int syscall_futex_wake(volatile uint32_t *addr, uint32_t count);
+
+/*
+ futex based lock, only enters the kernel when contended
+ 0: unlocked, 1: locked, 2: locked and someone might be sleeping on it
+*/
+typedef volatile uint32_t libc_lock_t;
+
+#define LIBC_LOCK_INIT 0
+
+static inline int libc_trylock(libc_lock_t *lock)
+{
+    return __sync_bool_compare_and_swap(lock, 0, 1);
+}
+
+static inline void libc_lock(libc_lock_t *lock)
+{
+    uint32_t c = __sync_val_compare_and_swap(lock, 0, 1);
+    if (c == 0)
+    {
+        return;
+    }
+
+    // mark the lock as contended before sleeping so the owner knows to wake us
+    if (c != 2)
+    {
+        c = __sync_lock_test_and_set(lock, 2);
+    }
+
+    while (c != 0)
+    {
+        syscall_futex_wait(lock, 2, 0);
+        c = __sync_lock_test_and_set(lock, 2);
+    }
+}
+
+static inline void libc_unlock(libc_lock_t *lock)
+{
+    if (__sync_fetch_and_sub(lock, 1) != 1)
+    {
+        *lock = 0;
+        syscall_futex_wake(lock, 1);
+    }
+}
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef _LIBC_PRIVAT_PTHREAD_IMPL_H
+#define _LIBC_PRIVAT_PTHREAD_IMPL_H
+
+#include <pthread.h>
+#include <lock.h>
+
+struct _pthread
+{
+    uint64_t tid;
+    void *(*start_routine)(void *);
+    void *arg;
+    void *result;
+    void *stack; // NULL for the main thread
+
+    struct _pthread *next;
+};
+
+// every thread created by pthread_create, looked up by tid
+extern struct _pthread *_pthread_list;
+extern libc_lock_t _pthread_list_lock;
+
+#endif
@@ -0,0 +1,25 @@
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdint.h>
+
+int64_t syscall_fcntl(uint64_t stream, int cmd, int64_t arg);
+
+int fcntl(int fildes, int cmd, ...)
+{
+    int arg = 0;
+    if (cmd == F_SETFL)
+    {
+        va_list args;
+        va_start(args, cmd);
+        arg = va_arg(args, int);
+        va_end(args);
+    }
+
+    int64_t res = syscall_fcntl((uint64_t)fildes, cmd, arg);
+    if (res < 0)
+    {
+        return -1;
+    }
+
+    return (int)res;
+}
@@ -0,0 +1,55 @@
+#include <sys/epoll.h>
+#include <stddef.h>
+
+int64_t syscall_epoll_create(void);
+int syscall_epoll_ctl(uint64_t epfd, int op, uint64_t fd, const struct epoll_event *event);
+int64_t syscall_epoll_wait(uint64_t epfd, struct epoll_event *events, size_t max, int64_t timeout_ns);
+
+int epoll_create(int size)
+{
+    if (size <= 0)
+    {
+        return -1;
+    }
+
+    int64_t res = syscall_epoll_create();
+    if (res < 0)
+    {
+        return -1;
+    }
+
+    return (int)res;
+}
+
+int epoll_ctl(int epfd, int op, int fd, struct epoll_event *event)
+{
+    if (epfd < 0 || fd < 0)
+    {
+        return -1;
+    }
+
+    if (syscall_epoll_ctl((uint64_t)epfd, op, (uint64_t)fd, event) < 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+int epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout)
+{
+    if (epfd < 0 || maxevents <= 0)
+    {
+        return -1;
+    }
+
+    int64_t timeout_ns = timeout < 0 ? -1 : (int64_t)timeout * 1000000;
+
+    int64_t res = syscall_epoll_wait((uint64_t)epfd, events, (size_t)maxevents, timeout_ns);
+    if (res < 0)
+    {
+        return -1;
+    }
+
+    return (int)res;
+}
@@ -0,0 +1,18 @@
+#include <poll.h>
+#include <stdint.h>
+#include <stddef.h>
+
+int64_t syscall_poll(struct pollfd *fds, size_t count, int64_t timeout_ns);
+
+int poll(struct pollfd fds[], nfds_t nfds, int timeout)
+{
+    int64_t timeout_ns = timeout < 0 ? -1 : (int64_t)timeout * 1000000;
+
+    int64_t res = syscall_poll(fds, nfds, timeout_ns);
+    if (res < 0)
+    {
+        return -1;
+    }
+
+    return (int)res;
+}
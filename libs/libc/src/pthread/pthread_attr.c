@@ -0,0 +1,25 @@
+#include <pthread.h>
+#include <errno.h>
+
+int pthread_attr_init(pthread_attr_t *attr)
+{
+    attr->stack_size = PTHREAD_STACK_DEFAULT;
+    return 0;
+}
+
+int pthread_attr_destroy(pthread_attr_t *attr)
+{
+    (void)attr;
+    return 0;
+}
+
+int pthread_attr_setstacksize(pthread_attr_t *attr, size_t stacksize)
+{
+    if (stacksize < PTHREAD_STACK_MIN)
+    {
+        return EINVAL;
+    }
+
+    attr->stack_size = stacksize;
+    return 0;
+}
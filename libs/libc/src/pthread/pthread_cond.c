@@ -0,0 +1,40 @@
+#include <pthread.h>
+#include <lock.h>
+
+int pthread_cond_init(pthread_cond_t *cond, const pthread_condattr_t *attr)
+{
+    (void)attr;
+    cond->seq = 0;
+    return 0;
+}
+
+int pthread_cond_destroy(pthread_cond_t *cond)
+{
+    (void)cond;
+    return 0;
+}
+
+int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex)
+{
+    // a signal between the unlock and the wait changes seq, so the kernel returns right away
+    uint32_t seq = cond->seq;
+
+    pthread_mutex_unlock(mutex);
+    syscall_futex_wait(&cond->seq, seq, 0);
+
+    return pthread_mutex_lock(mutex);
+}
+
+int pthread_cond_signal(pthread_cond_t *cond)
+{
+    __sync_fetch_and_add(&cond->seq, 1);
+    syscall_futex_wake(&cond->seq, 1);
+    return 0;
+}
+
+int pthread_cond_broadcast(pthread_cond_t *cond)
+{
+    __sync_fetch_and_add(&cond->seq, 1);
+    syscall_futex_wake(&cond->seq, UINT32_MAX);
+    return 0;
+}
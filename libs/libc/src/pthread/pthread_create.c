@@ -0,0 +1,62 @@
+#include <pthread_impl.h>
+#include <stdlib.h>
+#include <errno.h>
+
+int64_t syscall_thread_create(void (*entry)(void *), void *arg, void *stack_top);
+void syscall_thread_exit(void);
+
+struct _pthread *_pthread_list = NULL;
+libc_lock_t _pthread_list_lock = LIBC_LOCK_INIT;
+
+static void pthread_start(void *arg)
+{
+    pthread_t thread = (pthread_t)arg;
+    pthread_exit(thread->start_routine(thread->arg));
+}
+
+int pthread_create(pthread_t *thread, const pthread_attr_t *attr, void *(*start_routine)(void *), void *arg)
+{
+    size_t stack_size = attr ? attr->stack_size : PTHREAD_STACK_DEFAULT;
+
+    pthread_t t = malloc(sizeof(struct _pthread));
+    if (!t)
+    {
+        return ENOMEM;
+    }
+
+    t->stack = malloc(stack_size);
+    if (!t->stack)
+    {
+        free(t);
+        return ENOMEM;
+    }
+
+    t->start_routine = start_routine;
+    t->arg = arg;
+    t->result = NULL;
+
+    // pthread_start is entered like a call, so the stack has to look like a return address was pushed
+    uintptr_t stack_top = ((uintptr_t)t->stack + stack_size) & ~0xFULL;
+    stack_top -= 8;
+
+    // the list lock keeps the new thread from looking itself up before the tid is stored
+    libc_lock(&_pthread_list_lock);
+
+    int64_t tid = syscall_thread_create(&pthread_start, t, (void *)stack_top);
+    if (tid < 0)
+    {
+        libc_unlock(&_pthread_list_lock);
+        free(t->stack);
+        free(t);
+        return EAGAIN;
+    }
+
+    t->tid = (uint64_t)tid;
+    t->next = _pthread_list;
+    _pthread_list = t;
+
+    libc_unlock(&_pthread_list_lock);
+
+    *thread = t;
+    return 0;
+}
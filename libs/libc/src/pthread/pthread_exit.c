@@ -0,0 +1,15 @@
+#include <pthread_impl.h>
+
+void syscall_thread_exit(void);
+
+void pthread_exit(void *value_ptr)
+{
+    pthread_t self = pthread_self();
+    if (self)
+    {
+        self->result = value_ptr;
+    }
+
+    syscall_thread_exit();
+    while (1);
+}
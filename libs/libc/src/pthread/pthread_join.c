@@ -0,0 +1,40 @@
+#include <pthread_impl.h>
+#include <stdlib.h>
+#include <errno.h>
+
+int syscall_thread_join(uint64_t tid);
+
+int pthread_join(pthread_t thread, void **value_ptr)
+{
+    if (!thread || thread == pthread_self())
+    {
+        return EINVAL;
+    }
+
+    if (syscall_thread_join(thread->tid) < 0)
+    {
+        return EINVAL;
+    }
+
+    libc_lock(&_pthread_list_lock);
+    for (struct _pthread **link = &_pthread_list; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == thread)
+        {
+            *link = thread->next;
+            break;
+        }
+    }
+    libc_unlock(&_pthread_list_lock);
+
+    if (value_ptr)
+    {
+        *value_ptr = thread->result;
+    }
+
+    // the thread has left its stack for good once the kernel let us through
+    free(thread->stack);
+    free(thread);
+
+    return 0;
+}
@@ -0,0 +1,26 @@
+#include <pthread_impl.h>
+
+uint64_t syscall_gettid(void);
+
+// NULL for the main thread, it was not created by pthread_create
+pthread_t pthread_self(void)
+{
+    uint64_t tid = syscall_gettid();
+
+    libc_lock(&_pthread_list_lock);
+
+    pthread_t thread = _pthread_list;
+    while (thread && thread->tid != tid)
+    {
+        thread = thread->next;
+    }
+
+    libc_unlock(&_pthread_list_lock);
+
+    return thread;
+}
+
+int pthread_equal(pthread_t t1, pthread_t t2)
+{
+    return t1 == t2;
+}
@@ -5,7 +5,7 @@ uint64_t syscall_read(uint64_t stream, uint8_t *data, size_t size);
 
 int fgetc(FILE *f)
 {
-    uint8_t res;
+    uint8_t res = 0; // stays 0 when nothing was there
     if ((int64_t)syscall_read((uint64_t)f, &res, 1) < 0)
     {
         return -1;
@@ -32,5 +32,11 @@ FILE *fopen(const char *s, const char *a)
         break;
     }
 
-    return (FILE *)syscall_open((const uint8_t *)s, open_actions);
+    int64_t stream = (int64_t)syscall_open((const uint8_t *)s, open_actions);
+    if (stream < 0)
+    {
+        return NULL;
+    }
+
+    return (FILE *)stream;
 }
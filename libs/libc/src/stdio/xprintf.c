@@ -34,6 +34,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+uint64_t syscall_write(uint64_t stream, const uint8_t *data, size_t size);
+
 // define this globally (e.g. gcc -DPRINTF_INCLUDE_CONFIG_H ...) to include the
 // printf_config.h header file
 // default: undefined
@@ -164,6 +166,40 @@ static inline void _out_stream(char character, void *buffer, size_t idx, size_t
     }
 }
 
+// stream output is collected and written with one syscall per buffer instead of one per character
+#define PRINTF_STREAM_BUFFER_SIZE 256U
+
+typedef struct
+{
+    FILE *stream;
+    size_t len;
+    char data[PRINTF_STREAM_BUFFER_SIZE];
+} out_stream_buffer_type;
+
+static void _stream_buffer_flush(out_stream_buffer_type *buffer)
+{
+    if (buffer->len)
+    {
+        syscall_write((uint64_t)buffer->stream, (const uint8_t *)buffer->data, buffer->len);
+        buffer->len = 0;
+    }
+}
+
+static inline void _out_stream_buffered(char character, void *buffer, size_t idx, size_t maxlen)
+{
+    (void)idx;
+    (void)maxlen;
+    if (character)
+    {
+        out_stream_buffer_type *b = (out_stream_buffer_type *)buffer;
+        b->data[b->len++] = character;
+        if (b->len == PRINTF_STREAM_BUFFER_SIZE)
+        {
+            _stream_buffer_flush(b);
+        }
+    }
+}
+
 // internal output function wrapper
 static inline void _out_fct(char character, void *buffer, size_t idx, size_t maxlen)
 {
@@ -1003,12 +1039,21 @@ static int _vsnprintf(out_fct_type out, char *buffer, const size_t maxlen, const
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static int _vfprintf_buffered(FILE *stream, const char *format, va_list va)
+{
+    out_stream_buffer_type buffer;
+    buffer.stream = stream;
+    buffer.len = 0;
+    const int ret = _vsnprintf(_out_stream_buffered, (char *)&buffer, (size_t)-1, format, va);
+    _stream_buffer_flush(&buffer);
+    return ret;
+}
+
 int printf_(const char *format, ...)
 {
     va_list va;
     va_start(va, format);
-    char buffer[1];
-    const int ret = _vsnprintf(_out_char, buffer, (size_t)-1, format, va);
+    const int ret = _vfprintf_buffered(stdout, format, va);
     va_end(va);
     return ret;
 }
@@ -1031,14 +1076,14 @@ int fprintf_(FILE *stream, const char *format, ...)
 {
     va_list va;
     va_start(va, format);
-    const int ret = _vsnprintf(_out_stream, (char *)stream, (size_t)-1, format, va);
+    const int ret = _vfprintf_buffered(stream, format, va);
     va_end(va);
     return ret;
 }
 
 int vfprintf_(FILE *stream, const char *format, va_list va)
 {
-    return _vsnprintf(_out_stream, (char *)stream, (size_t)-1, format, va);
+    return _vfprintf_buffered(stream, format, va);
 }
 
 int snprintf_(char *buffer, size_t count, const char *format, ...)
@@ -1052,8 +1097,7 @@ int snprintf_(char *buffer, size_t count, const char *format, ...)
 
 int vprintf_(const char *format, va_list va)
 {
-    char buffer[1];
-    return _vsnprintf(_out_char, buffer, (size_t)-1, format, va);
+    return _vfprintf_buffered(stdout, format, va);
 }
 
 int vsnprintf_(char *buffer, size_t count, const char *format, va_list va)
@@ -1,7 +1,10 @@
 #include <stdlib.h>
+#include <lock.h>
 
 void buddy_allocator_free(void *ptr);
 
+extern libc_lock_t allocator_lock;
+
 void free(void *p)
 {
     if (!p)
@@ -9,5 +12,7 @@ void free(void *p)
         return;
     }
 
+    libc_lock(&allocator_lock);
     buddy_allocator_free(p);
+    libc_unlock(&allocator_lock);
 }
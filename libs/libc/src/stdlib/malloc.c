@@ -1,8 +1,15 @@
 #include <stdlib.h>
+#include <lock.h>
 
 void *buddy_allocator_alloc(size_t size);
 
+// the buddy allocator is shared by every thread of the process
+libc_lock_t allocator_lock = LIBC_LOCK_INIT;
+
 void *malloc(size_t s)
 {
-    return buddy_allocator_alloc(s);
+    libc_lock(&allocator_lock);
+    void *p = buddy_allocator_alloc(s);
+    libc_unlock(&allocator_lock);
+    return p;
 }
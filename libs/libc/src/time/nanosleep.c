@@ -0,0 +1,25 @@
+#include <time.h>
+#include <stdint.h>
+
+int syscall_nanosleep(uint64_t ns);
+
+int nanosleep(const struct timespec *rqtp, struct timespec *rmtp)
+{
+    if (!rqtp || rqtp->tv_sec < 0 || rqtp->tv_nsec < 0 || rqtp->tv_nsec >= 1000000000)
+    {
+        return -1;
+    }
+
+    if (syscall_nanosleep((uint64_t)rqtp->tv_sec * 1000000000 + (uint64_t)rqtp->tv_nsec) < 0)
+    {
+        return -1;
+    }
+
+    if (rmtp)
+    {
+        rmtp->tv_sec = 0;
+        rmtp->tv_nsec = 0;
+    }
+
+    return 0;
+}
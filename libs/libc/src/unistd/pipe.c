@@ -0,0 +1,14 @@
+#include <unistd.h>
+#include <stddef.h>
+
+int syscall_pipe(int fds[2], size_t capacity);
+
+int pipe(int fildes[2])
+{
+    if (syscall_pipe(fildes, 0) < 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
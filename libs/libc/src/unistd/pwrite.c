@@ -0,0 +1,20 @@
+#include <unistd.h>
+#include <stdint.h>
+
+int64_t syscall_pwrite(uint64_t stream, const uint8_t *data, size_t size, size_t offset);
+
+ssize_t pwrite(int fildes, const void *buf, size_t nbyte, off_t offset)
+{
+    if (fildes < 0 || offset < 0)
+    {
+        return -1;
+    }
+
+    int64_t res = syscall_pwrite((uint64_t)fildes, (const uint8_t *)buf, nbyte, (size_t)offset);
+    if (res < 0)
+    {
+        return -1;
+    }
+
+    return res;
+}
@@ -0,0 +1,20 @@
+#include <sys/uio.h>
+#include <stdint.h>
+
+int64_t syscall_readv(uint64_t stream, const struct iovec *iov, size_t count);
+
+ssize_t readv(int fildes, const struct iovec *iov, int iovcnt)
+{
+    if (fildes < 0 || iovcnt < 0)
+    {
+        return -1;
+    }
+
+    int64_t res = syscall_readv((uint64_t)fildes, iov, (size_t)iovcnt);
+    if (res < 0)
+    {
+        return -1;
+    }
+
+    return res;
+}
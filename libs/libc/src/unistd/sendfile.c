@@ -0,0 +1,20 @@
+#include <sys/sendfile.h>
+#include <stdint.h>
+
+int64_t syscall_splice(uint64_t in, uint64_t out, size_t size, int64_t *offset);
+
+ssize_t sendfile(int out_fd, int in_fd, off_t *offset, size_t count)
+{
+    if (out_fd < 0 || in_fd < 0)
+    {
+        return -1;
+    }
+
+    int64_t res = syscall_splice((uint64_t)in_fd, (uint64_t)out_fd, count, (int64_t *)offset);
+    if (res < 0)
+    {
+        return -1;
+    }
+
+    return res;
+}
@@ -4,17 +4,10 @@
 #include <stdint.h>
 #include <stddef.h>
 
-#define _SYSCALL_READ 0
-#define _SYSCALL_WRITE 1
-#define _SYSCALL_FORK 2
-#define _SYSCALL_EXIT 3
-#define _SYSCALL_PING 4
-#define _SYSCALL_EXEC 5
-#define _SYSCALL_ALLOC 6
-#define _SYSCALL_OPEN 7
-#define _SYSCALL_CLOSE 8
-#define _SYSCALL_PIPE 12
-#define _SYSCALL_LSEEK 13
+#include <hydra/syscalls.h>
+
+#define CLOCK_REALTIME 0
+#define CLOCK_MONOTONIC 1
 
 #define RES_SUCCESS 0
 #define RES_INVARG 1
@@ -24,6 +17,7 @@
 #define RES_UNAVAILABLE 6
 #define RES_TIMEOUT 7
 #define RES_ACCESS_DENIED 8
+#define RES_WOULDBLOCK 9
 
 #define RES_EUNKNOWN 10
 #define RES_ETEST 11
@@ -32,29 +26,99 @@ uint64_t syscall(uint64_t num, uint64_t arg1, uint64_t arg2, uint64_t arg3, uint
 
 uint64_t syscall_read(uint64_t stream, uint8_t *data, size_t size);
 uint64_t syscall_write(uint64_t stream, const uint8_t *data, size_t size);
+
+// move the buffers in order with one call, returns the total bytes or a negative error
+int64_t syscall_readv(uint64_t stream, const iovec_t *iov, size_t count);
+int64_t syscall_writev(uint64_t stream, const iovec_t *iov, size_t count);
+// file streams only, the stream position is left untouched
+int64_t syscall_pread(uint64_t stream, uint8_t *data, size_t size, size_t offset);
+int64_t syscall_pwrite(uint64_t stream, const uint8_t *data, size_t size, size_t offset);
+// moves up to size bytes from in to out inside the kernel, returns the bytes moved and 0 at the end of the input
+// offset is NULL for the stream position of in, otherwise in has to be a file and offset is advanced instead
+int64_t syscall_splice(uint64_t in, uint64_t out, size_t size, int64_t *offset);
+
 uint64_t syscall_fork(void);
 void syscall_exit(uint32_t result);
 uint64_t syscall_ping(uint64_t pid);
 
-typedef struct
-{
-    const char **args;
-    size_t num_args;
-    
-    const char **envars;
-    size_t num_envars;
-
-    uint64_t stdin_idx;
-    uint64_t stdout_idx;
-    uint64_t stderr_idx;
-} __attribute__((packed)) process_create_info_t;
-
 void syscall_exec(const uint8_t *path, process_create_info_t *create_info);
+// creates the child directly, returns its pid or a negative error
+int64_t syscall_spawn(const uint8_t *path, process_create_info_t *create_info);
 
 void *syscall_alloc(void);
 uint64_t syscall_open(const uint8_t *path, uint8_t open_actions);
 void syscall_close(uint64_t stream);
-int syscall_pipe(void);
+// fds[0] is the read end and fds[1] the write end, capacity 0 is one page, the maximum 16 pages
+// reads block until there is data and return 0 once every write end is closed, writes block while the pipe is full
+int syscall_pipe(int fds[2], size_t capacity);
 size_t syscall_lseek(uint64_t stream, size_t offset, int action);
 
+typedef struct
+{
+    int64_t tv_sec;
+    int64_t tv_nsec;
+} timespec_t;
+
+int syscall_clock_gettime(int clock_id, timespec_t *ts);
+int syscall_nanosleep(uint64_t ns);
+
+#define SCHED_LATENCY_BUCKETS 16 // bucket i counts latencies below 2^(i + 1) microseconds
+
+typedef struct
+{
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t histogram[SCHED_LATENCY_BUCKETS];
+} __attribute__((packed)) sched_latency_t;
+
+typedef struct
+{
+    uint64_t switches;
+    sched_latency_t wakeup;
+    sched_latency_t preempt;
+} __attribute__((packed)) sched_stats_t;
+
+int syscall_sched_stats(sched_stats_t *stats);
+
+// the thread starts at entry(arg) on the given stack, entry must not return
+int64_t syscall_thread_create(void (*entry)(void *), void *arg, void *stack_top);
+void syscall_thread_exit(void);
+int syscall_thread_join(uint64_t tid);
+void syscall_yield(void);
+uint64_t syscall_gettid(void);
+
+// sleeps while *addr == val, timeout_ns 0 waits forever
+int syscall_futex_wait(volatile uint32_t *addr, uint32_t val, uint64_t timeout_ns);
+// returns the number of woken threads
+int syscall_futex_wake(volatile uint32_t *addr, uint32_t count);
+
+// pid 0 is the calling process, flags are SYSTRACE_*, 0 switches tracing off
+int syscall_trace(uint64_t pid, uint32_t flags);
+int syscall_trace_stats(uint64_t pid, syscall_stats_t *stats);
+// returns the number of records copied, 0 once the trace is drained
+int64_t syscall_trace_read(uint64_t pid, syscall_trace_record_t *records, size_t max);
+
+// maps the rings and returns their address, see hydra/ring.h
+int64_t syscall_ring_setup(uint32_t entries);
+// consumes up to to_submit entries, then waits for min_complete completions
+int64_t syscall_ring_enter(uint32_t to_submit, uint32_t min_complete, uint32_t flags);
+
+// sleeps until one of the streams has one of its events, timeout_ns < 0 waits forever and 0 only checks
+// returns the number of entries with revents set
+int64_t syscall_poll(poll_fd_t *fds, size_t count, int64_t timeout_ns);
+
+// returns a stream that holds the interest set, closing it drops the set
+int64_t syscall_epoll_create(void);
+// op is EPOLL_CTL_*, event is unused for EPOLL_CTL_DEL
+int syscall_epoll_ctl(uint64_t epfd, int op, uint64_t fd, const epoll_event_t *event);
+// level triggered, returns the number of events written to events
+int64_t syscall_epoll_wait(uint64_t epfd, epoll_event_t *events, size_t max, int64_t timeout_ns);
+
+// cmd is F_GETFL or F_SETFL with O_* flags, a non-blocking stream fails with -RES_WOULDBLOCK instead of waiting
+int64_t syscall_fcntl(uint64_t stream, int cmd, int64_t arg);
+
+// counters of the kernel's file page cache
+int syscall_pcache_stats(pcache_stats_t *stats);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef _HYDRA_RING_H
+#define _HYDRA_RING_H 1
+
+#include <hydra/kernel.h>
+
+/*
+ submission and completion rings shared with the kernel
+ queue operations with ring_get_sqe, hand them over with ring_submit and collect the results with ring_wait_cqe
+ operations never wait, a read or write on a pipe that is not ready completes with RES_WOULDBLOCK
+*/
+
+#define RING_ADDR 0x8F0000
+#define RING_MAX_ENTRIES 256
+
+#define RING_OP_NOP 0
+#define RING_OP_READ 1  // offset < 0 uses the stream position
+#define RING_OP_WRITE 2 // offset < 0 uses the stream position
+#define RING_OP_OPEN 3  // addr is the path, len the open action
+#define RING_OP_CLOSE 4
+#define RING_OP_SEEK 5 // len is the seek type
+
+#define RING_ENTER_ASYNC (1 << 0)
+
+typedef struct
+{
+    volatile uint32_t sq_head;
+    volatile uint32_t sq_tail;
+    volatile uint32_t cq_head;
+    volatile uint32_t cq_tail;
+    uint32_t sq_entries;
+    uint32_t cq_entries;
+    uint32_t sq_offset;
+    uint32_t cq_offset;
+    uint32_t reserved[8];
+} ring_header_t;
+
+typedef struct
+{
+    uint8_t opcode;
+    uint8_t flags;
+    uint16_t reserved0;
+    uint32_t reserved1;
+    int64_t stream;
+    uint64_t addr;
+    uint64_t len;
+    int64_t offset;
+    uint64_t user_data;
+} __attribute__((packed)) ring_sqe_t;
+
+typedef struct
+{
+    uint64_t user_data;
+    int64_t result;
+} __attribute__((packed)) ring_cqe_t;
+
+typedef struct
+{
+    ring_header_t *header;
+    ring_sqe_t *sqes;
+    ring_cqe_t *cqes;
+    uint32_t sq_tail; // entries queued but not yet submitted are past header->sq_tail
+} ring_t;
+
+// entries must be a power of two, the completion ring is twice as large
+int ring_init(ring_t *ring, uint32_t entries);
+
+// returns NULL while the submission ring is full
+ring_sqe_t *ring_get_sqe(ring_t *ring);
+
+// makes the queued entries visible, returns how many the kernel consumed or a negative error
+int64_t ring_submit(ring_t *ring, uint32_t min_complete, uint32_t flags);
+
+// returns NULL if nothing has completed yet
+ring_cqe_t *ring_peek_cqe(ring_t *ring);
+// waits until a completion arrives or nothing is left in flight
+ring_cqe_t *ring_wait_cqe(ring_t *ring);
+void ring_cqe_seen(ring_t *ring);
+
+#endif
@@ -0,0 +1,188 @@
+// generated by scripts/gensyscalls.py from kernel/syscalls/syscalls.tbl, do not edit
+
+#ifndef _HYDRA_SYSCALLS_H
+#define _HYDRA_SYSCALLS_H 1
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define _SYSCALL_READ 0
+#define _SYSCALL_WRITE 1
+#define _SYSCALL_FORK 2
+#define _SYSCALL_EXIT 3
+#define _SYSCALL_PING 4
+#define _SYSCALL_EXEC 5
+#define _SYSCALL_ALLOC 6
+#define _SYSCALL_OPEN 7
+#define _SYSCALL_CLOSE 8
+#define _SYSCALL_VIDEO_GET_DISPLAY_RECT 9
+#define _SYSCALL_VIDEO_CREATE_FRAMEBUFFER 10
+#define _SYSCALL_VIDEO_UPDATE_DISPLAY 11
+#define _SYSCALL_PIPE 12
+#define _SYSCALL_LSEEK 13
+#define _SYSCALL_CLOCK_GETTIME 14
+#define _SYSCALL_NANOSLEEP 15
+#define _SYSCALL_SCHED_STATS 16
+#define _SYSCALL_THREAD_CREATE 17
+#define _SYSCALL_THREAD_EXIT 18
+#define _SYSCALL_THREAD_JOIN 19
+#define _SYSCALL_YIELD 20
+#define _SYSCALL_GETTID 21
+#define _SYSCALL_FUTEX_WAIT 22
+#define _SYSCALL_FUTEX_WAKE 23
+#define _SYSCALL_SPAWN 24
+#define _SYSCALL_READV 25
+#define _SYSCALL_WRITEV 26
+#define _SYSCALL_PREAD 27
+#define _SYSCALL_PWRITE 28
+#define _SYSCALL_RING_SETUP 29
+#define _SYSCALL_RING_ENTER 30
+#define _SYSCALL_TRACE 31
+#define _SYSCALL_TRACE_STATS 32
+#define _SYSCALL_TRACE_READ 33
+#define _SYSCALL_SPLICE 34
+#define _SYSCALL_POLL 35
+#define _SYSCALL_EPOLL_CREATE 36
+#define _SYSCALL_EPOLL_CTL 37
+#define _SYSCALL_EPOLL_WAIT 38
+#define _SYSCALL_FCNTL 39
+#define _SYSCALL_PCACHE_STATS 40
+
+#define SYSCALL_COUNT 41
+
+// initializer for a table of names indexed by syscall number
+#define SYSCALL_NAMES { \
+    "read", \
+    "write", \
+    "fork", \
+    "exit", \
+    "ping", \
+    "exec", \
+    "alloc", \
+    "open", \
+    "close", \
+    "video_get_display_rect", \
+    "video_create_framebuffer", \
+    "video_update_display", \
+    "pipe", \
+    "lseek", \
+    "clock_gettime", \
+    "nanosleep", \
+    "sched_stats", \
+    "thread_create", \
+    "thread_exit", \
+    "thread_join", \
+    "yield", \
+    "gettid", \
+    "futex_wait", \
+    "futex_wake", \
+    "spawn", \
+    "readv", \
+    "writev", \
+    "pread", \
+    "pwrite", \
+    "ring_setup", \
+    "ring_enter", \
+    "trace", \
+    "trace_stats", \
+    "trace_read", \
+    "splice", \
+    "poll", \
+    "epoll_create", \
+    "epoll_ctl", \
+    "epoll_wait", \
+    "fcntl", \
+    "pcache_stats", \
+}
+
+// types passed through syscalls, pasted into both generated headers
+
+typedef struct
+{
+    const char **args;
+    size_t num_args;
+
+    const char **envars;
+    size_t num_envars;
+
+    uint64_t stdin_idx;
+    uint64_t stdout_idx;
+    uint64_t stderr_idx;
+} __attribute__((packed)) process_create_info_t;
+
+typedef struct
+{
+    void *base;
+    size_t len;
+} __attribute__((packed)) iovec_t;
+
+#define SYSTRACE_STATS (1 << 0)   // count calls and keep latency histograms
+#define SYSTRACE_EVENTS (1 << 1)  // record every call in the trace buffer
+#define SYSTRACE_INHERIT (1 << 2) // processes created by the traced process are traced as well
+
+#define SYSCALL_LATENCY_BUCKETS 16 // bucket i counts latencies below 2^(i + 8) nanoseconds, the last one everything above
+
+typedef struct
+{
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t histogram[SYSCALL_LATENCY_BUCKETS];
+} __attribute__((packed)) syscall_stat_t;
+
+typedef struct
+{
+    uint64_t dropped; // events overwritten before they were read
+    syscall_stat_t calls[SYSCALL_COUNT];
+} __attribute__((packed)) syscall_stats_t;
+
+typedef struct
+{
+    uint64_t time_ns; // at entry
+    uint64_t duration_ns;
+    uint64_t tid;
+    uint32_t num;
+    uint32_t reserved;
+    int64_t args[6];
+    int64_t result;
+} __attribute__((packed)) syscall_trace_record_t;
+
+#define POLLIN (1 << 0)   // a read would not block
+#define POLLOUT (1 << 2)  // a write would not block
+#define POLLERR (1 << 3)  // every read end of the pipe is closed, always reported
+#define POLLHUP (1 << 4)  // every write end of the pipe is closed, always reported
+#define POLLNVAL (1 << 5) // not an open stream
+
+typedef struct
+{
+    int32_t fd; // negative entries are skipped
+    int16_t events;
+    int16_t revents;
+} __attribute__((packed)) poll_fd_t;
+
+#define EPOLL_CTL_ADD 1
+#define EPOLL_CTL_DEL 2
+#define EPOLL_CTL_MOD 3
+
+typedef struct
+{
+    uint32_t events; // POLL* flags
+    uint64_t data;   // handed back untouched
+} __attribute__((packed)) epoll_event_t;
+
+#define F_GETFL 1 // returns the O_* flags of the stream
+#define F_SETFL 2 // replaces the O_* flags of the stream
+
+#define O_NONBLOCK (1 << 0) // reads and writes fail with RES_WOULDBLOCK instead of waiting
+
+typedef struct
+{
+    uint64_t hits; // file pages served from memory
+    uint64_t misses; // file pages read from the filesystem
+    uint64_t evictions; // pages dropped to make room or under memory pressure
+    uint64_t pages; // pages currently cached
+    uint64_t readahead; // pages prefetched for sequential readers
+    uint64_t readahead_hits; // prefetched pages that were read afterwards
+} __attribute__((packed)) pcache_stats_t;
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef _HYDRA_TIME_H
+#define _HYDRA_TIME_H 1
+
+#include <hydra/kernel.h>
+
+#define TIME_PAGE_ADDR 0x8FF000
+
+#define NSEC_PER_SEC 1000000000ULL
+
+typedef struct
+{
+    volatile uint32_t seq;
+    uint32_t valid;
+    uint32_t mult;
+    uint32_t shift;
+    uint64_t tsc_base;
+    uint64_t ns_base;
+    uint64_t tsc_frequency;
+} __attribute__((packed)) time_page_t;
+
+// monotonic nanoseconds read from the kernel time page, falls back to the syscall
+uint64_t time_get_ns(void);
+int time_clock_gettime(int clock_id, timespec_t *ts);
+
+#endif
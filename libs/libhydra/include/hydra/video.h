@@ -3,10 +3,6 @@
 
 #include <hydra/kernel.h>
 
-#define _SYSCALL_VIDEO_GET_DISPLAY_RECT 9
-#define _SYSCALL_VIDEO_CREATE_FRAMEBUFFER 10
-#define _SYSCALL_VIDEO_UPDATE_DISPLAY 11
-
 #define FRAMEBUFFER_ADDR_BASE 0x900000
 
 typedef struct
@@ -2,6 +2,11 @@
 
 uint64_t syscall(uint64_t num, uint64_t arg1, uint64_t arg2, uint64_t arg3, uint64_t arg4, uint64_t arg5, uint64_t arg6)
 {
+    // the kernel expects the last three arguments in r10, r8 and r9
+    register uint64_t r10 asm("r10") = arg4;
+    register uint64_t r8 asm("r8") = arg5;
+    register uint64_t r9 asm("r9") = arg6;
+
     uint64_t result;
     asm volatile(
         "syscall"
@@ -10,9 +15,9 @@ uint64_t syscall(uint64_t num, uint64_t arg1, uint64_t arg2, uint64_t arg3, uint
             "D"(arg1),
             "S"(arg2),
             "d"(arg3),
-            "r"(arg5),
-            "r"(arg6),
-            "r"(arg4)
+            "r"(r10),
+            "r"(r8),
+            "r"(r9)
         : "rcx", "r11", "memory"
     );
 
@@ -48,6 +53,11 @@ void syscall_exec(const uint8_t *path, process_create_info_t *create_info)
 {
     syscall(_SYSCALL_EXEC, (uint64_t)path, (uint64_t)create_info, 0, 0, 0, 0);
 }
+
+int64_t syscall_spawn(const uint8_t *path, process_create_info_t *create_info)
+{
+    return syscall(_SYSCALL_SPAWN, (uint64_t)path, (uint64_t)create_info, 0, 0, 0, 0);
+}
  
 void *syscall_alloc(void)
 {
@@ -64,12 +74,142 @@ void syscall_close(uint64_t stream)
     syscall(_SYSCALL_CLOSE, stream, 0, 0, 0, 0, 0);
 }
 
-int syscall_pipe(void)
+int syscall_pipe(int fds[2], size_t capacity)
 {
-    return syscall(_SYSCALL_PIPE, 0, 0, 0, 0, 0, 0);
+    return syscall(_SYSCALL_PIPE, (uint64_t)fds, (uint64_t)capacity, 0, 0, 0, 0);
 }
 
 size_t syscall_lseek(uint64_t stream, size_t offset, int action)
 {
     return syscall(_SYSCALL_LSEEK, (uint64_t)stream, (uint64_t)offset, (uint64_t)action, 0, 0, 0);
 }
+
+int syscall_clock_gettime(int clock_id, timespec_t *ts)
+{
+    return syscall(_SYSCALL_CLOCK_GETTIME, (uint64_t)clock_id, (uint64_t)ts, 0, 0, 0, 0);
+}
+
+int syscall_nanosleep(uint64_t ns)
+{
+    return syscall(_SYSCALL_NANOSLEEP, ns, 0, 0, 0, 0, 0);
+}
+
+int syscall_sched_stats(sched_stats_t *stats)
+{
+    return syscall(_SYSCALL_SCHED_STATS, (uint64_t)stats, 0, 0, 0, 0, 0);
+}
+
+int64_t syscall_thread_create(void (*entry)(void *), void *arg, void *stack_top)
+{
+    return syscall(_SYSCALL_THREAD_CREATE, (uint64_t)entry, (uint64_t)arg, (uint64_t)stack_top, 0, 0, 0);
+}
+
+void syscall_thread_exit(void)
+{
+    syscall(_SYSCALL_THREAD_EXIT, 0, 0, 0, 0, 0, 0);
+}
+
+int syscall_thread_join(uint64_t tid)
+{
+    return syscall(_SYSCALL_THREAD_JOIN, tid, 0, 0, 0, 0, 0);
+}
+
+void syscall_yield(void)
+{
+    syscall(_SYSCALL_YIELD, 0, 0, 0, 0, 0, 0);
+}
+
+uint64_t syscall_gettid(void)
+{
+    return syscall(_SYSCALL_GETTID, 0, 0, 0, 0, 0, 0);
+}
+
+int syscall_futex_wait(volatile uint32_t *addr, uint32_t val, uint64_t timeout_ns)
+{
+    return syscall(_SYSCALL_FUTEX_WAIT, (uint64_t)addr, val, timeout_ns, 0, 0, 0);
+}
+
+int syscall_futex_wake(volatile uint32_t *addr, uint32_t count)
+{
+    return syscall(_SYSCALL_FUTEX_WAKE, (uint64_t)addr, count, 0, 0, 0, 0);
+}
+
+int64_t syscall_readv(uint64_t stream, const iovec_t *iov, size_t count)
+{
+    return syscall(_SYSCALL_READV, stream, (uint64_t)iov, count, 0, 0, 0);
+}
+
+int64_t syscall_writev(uint64_t stream, const iovec_t *iov, size_t count)
+{
+    return syscall(_SYSCALL_WRITEV, stream, (uint64_t)iov, count, 0, 0, 0);
+}
+
+int64_t syscall_pread(uint64_t stream, uint8_t *data, size_t size, size_t offset)
+{
+    return syscall(_SYSCALL_PREAD, stream, (uint64_t)data, size, offset, 0, 0);
+}
+
+int64_t syscall_pwrite(uint64_t stream, const uint8_t *data, size_t size, size_t offset)
+{
+    return syscall(_SYSCALL_PWRITE, stream, (uint64_t)data, size, offset, 0, 0);
+}
+
+int64_t syscall_splice(uint64_t in, uint64_t out, size_t size, int64_t *offset)
+{
+    return syscall(_SYSCALL_SPLICE, in, out, size, (uint64_t)offset, 0, 0);
+}
+
+int64_t syscall_ring_setup(uint32_t entries)
+{
+    return syscall(_SYSCALL_RING_SETUP, entries, 0, 0, 0, 0, 0);
+}
+
+int64_t syscall_ring_enter(uint32_t to_submit, uint32_t min_complete, uint32_t flags)
+{
+    return syscall(_SYSCALL_RING_ENTER, to_submit, min_complete, flags, 0, 0, 0);
+}
+
+int syscall_trace(uint64_t pid, uint32_t flags)
+{
+    return syscall(_SYSCALL_TRACE, pid, flags, 0, 0, 0, 0);
+}
+
+int syscall_trace_stats(uint64_t pid, syscall_stats_t *stats)
+{
+    return syscall(_SYSCALL_TRACE_STATS, pid, (uint64_t)stats, 0, 0, 0, 0);
+}
+
+int64_t syscall_trace_read(uint64_t pid, syscall_trace_record_t *records, size_t max)
+{
+    return syscall(_SYSCALL_TRACE_READ, pid, (uint64_t)records, max, 0, 0, 0);
+}
+
+int64_t syscall_poll(poll_fd_t *fds, size_t count, int64_t timeout_ns)
+{
+    return syscall(_SYSCALL_POLL, (uint64_t)fds, count, (uint64_t)timeout_ns, 0, 0, 0);
+}
+
+int64_t syscall_epoll_create(void)
+{
+    return syscall(_SYSCALL_EPOLL_CREATE, 0, 0, 0, 0, 0, 0);
+}
+
+int syscall_epoll_ctl(uint64_t epfd, int op, uint64_t fd, const epoll_event_t *event)
+{
+    return syscall(_SYSCALL_EPOLL_CTL, epfd, (uint64_t)op, fd, (uint64_t)event, 0, 0);
+}
+
+int syscall_pcache_stats(pcache_stats_t *stats)
+{
+    return syscall(_SYSCALL_PCACHE_STATS, (uint64_t)stats, 0, 0, 0, 0, 0);
+}
+
+int64_t syscall_fcntl(uint64_t stream, int cmd, int64_t arg)
+{
+    return syscall(_SYSCALL_FCNTL, stream, (uint64_t)cmd, (uint64_t)arg, 0, 0, 0);
+}
+
+int64_t syscall_epoll_wait(uint64_t epfd, epoll_event_t *events, size_t max, int64_t timeout_ns)
+{
+    return syscall(_SYSCALL_EPOLL_WAIT, epfd, (uint64_t)events, max, (uint64_t)timeout_ns, 0, 0);
+}
@@ -0,0 +1,77 @@
+#include <hydra/ring.h>
+
+int ring_init(ring_t *ring, uint32_t entries)
+{
+    int64_t addr = syscall_ring_setup(entries);
+    if (addr < 0)
+    {
+        return (int)addr;
+    }
+
+    ring->header = (ring_header_t *)addr;
+    ring->sqes = (ring_sqe_t *)(addr + ring->header->sq_offset);
+    ring->cqes = (ring_cqe_t *)(addr + ring->header->cq_offset);
+    ring->sq_tail = ring->header->sq_tail;
+
+    return RES_SUCCESS;
+}
+
+ring_sqe_t *ring_get_sqe(ring_t *ring)
+{
+    uint32_t head = __atomic_load_n(&ring->header->sq_head, __ATOMIC_ACQUIRE);
+    if (ring->sq_tail - head >= ring->header->sq_entries)
+    {
+        return NULL;
+    }
+
+    ring_sqe_t *sqe = &ring->sqes[ring->sq_tail & (ring->header->sq_entries - 1)];
+    ring->sq_tail++;
+
+    sqe->opcode = RING_OP_NOP;
+    sqe->flags = 0;
+    sqe->reserved0 = 0;
+    sqe->reserved1 = 0;
+    sqe->stream = 0;
+    sqe->addr = 0;
+    sqe->len = 0;
+    sqe->offset = -1;
+    sqe->user_data = 0;
+
+    return sqe;
+}
+
+int64_t ring_submit(ring_t *ring, uint32_t min_complete, uint32_t flags)
+{
+    uint32_t to_submit = ring->sq_tail - ring->header->sq_tail;
+    __atomic_store_n(&ring->header->sq_tail, ring->sq_tail, __ATOMIC_RELEASE);
+
+    return syscall_ring_enter(to_submit, min_complete, flags);
+}
+
+ring_cqe_t *ring_peek_cqe(ring_t *ring)
+{
+    uint32_t head = ring->header->cq_head;
+    if (head == __atomic_load_n(&ring->header->cq_tail, __ATOMIC_ACQUIRE))
+    {
+        return NULL;
+    }
+
+    return &ring->cqes[head & (ring->header->cq_entries - 1)];
+}
+
+ring_cqe_t *ring_wait_cqe(ring_t *ring)
+{
+    ring_cqe_t *cqe = ring_peek_cqe(ring);
+    if (!cqe)
+    {
+        syscall_ring_enter(0, 1, 0);
+        cqe = ring_peek_cqe(ring);
+    }
+
+    return cqe;
+}
+
+void ring_cqe_seen(ring_t *ring)
+{
+    __atomic_store_n(&ring->header->cq_head, ring->header->cq_head + 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,61 @@
+#include <hydra/time.h>
+
+static inline uint64_t read_tsc(void)
+{
+    uint32_t low, high;
+    __asm__ volatile("rdtsc" : "=a"(low), "=d"(high));
+    return ((uint64_t)high << 32) | low;
+}
+
+// (value * mult) >> shift without 128 bit helpers from libgcc
+static inline uint64_t mul_shift(uint64_t value, uint32_t mult, uint32_t shift)
+{
+    uint64_t low, high;
+    __asm__("mulq %3" : "=a"(low), "=d"(high) : "a"(value), "r"((uint64_t)mult));
+
+    if (shift == 0)
+    {
+        return low;
+    }
+    return (low >> shift) | (high << (64 - shift));
+}
+
+uint64_t time_get_ns(void)
+{
+    const time_page_t *page = (const time_page_t *)TIME_PAGE_ADDR;
+
+    uint32_t seq;
+    uint64_t ns;
+    do
+    {
+        seq = page->seq;
+        __asm__ volatile("" : : : "memory");
+
+        if (!page->valid)
+        {
+            timespec_t ts;
+            syscall_clock_gettime(CLOCK_MONOTONIC, &ts);
+            return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+        }
+
+        ns = page->ns_base + mul_shift(read_tsc() - page->tsc_base, page->mult, page->shift);
+
+        __asm__ volatile("" : : : "memory");
+    } while ((seq & 1) || seq != page->seq);
+
+    return ns;
+}
+
+int time_clock_gettime(int clock_id, timespec_t *ts)
+{
+    if (clock_id != CLOCK_MONOTONIC)
+    {
+        return syscall_clock_gettime(clock_id, ts);
+    }
+
+    uint64_t ns = time_get_ns();
+    ts->tv_sec = ns / NSEC_PER_SEC;
+    ts->tv_nsec = ns % NSEC_PER_SEC;
+
+    return RES_SUCCESS;
+}
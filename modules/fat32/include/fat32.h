@@ -5,8 +5,8 @@
 
 stream_t *fat32_open(const char *path, uint8_t action, mount_node_t *mount);
 int fat32_close(stream_t *stream_clone);
-int fat32_read(stream_t *stream_clone, size_t size, uint8_t *buf);
-int fat32_write(stream_t *stream_clone, size_t size, const uint8_t *buf);
+int fat32_read(stream_t *stream_clone, size_t offset, size_t size, uint8_t *buf);
+int fat32_write(stream_t *stream_clone, size_t offset, size_t size, const uint8_t *buf);
 int fat32_readdir(stream_t *stream_clone, int index, char *path);
 int fat32_delete(stream_t *stream_clone);
 
@@ -1,6 +1,8 @@
 #include <fat32.h>
 #include <kernel/kmm.h>
 #include <kernel/string.h>
+#include <kernel/fs/dcache.h>
+#include <kernel/cpu.h>
 
 /*
  known bugs / unsupported features:
@@ -564,6 +566,52 @@ static directory_entry_t *find_entry_by_name(const char *name, uint32_t director
     return NULL;
 }
 
+#define FAT32_NAME_COMPARE 11 // names are only compared this far, see find_entry_by_name
+
+// the dentry cache is keyed with the part of the name the lookups compare, so aliases share one entry
+static void dcache_key(const char *name, char *key)
+{
+    strncpy(key, name, FAT32_NAME_COMPARE);
+    key[FAT32_NAME_COMPARE] = '\0';
+}
+
+// find_entry_by_name through the dentry cache, keyed by the first cluster of the directory
+static directory_entry_t *lookup_entry(const char *name, uint32_t directory_cluster_num, boot_sector_t *boot_sector, virtual_blockdev_t *dev)
+{
+    char key[FAT32_NAME_COMPARE + 1];
+    dcache_key(name, key);
+
+    directory_entry_t cached;
+    switch (dcache_lookup(boot_sector, directory_cluster_num, key, &cached, sizeof(cached)))
+    {
+    case DCACHE_HIT:
+    {
+        directory_entry_t *res = kmalloc(sizeof(directory_entry_t));
+        if (res)
+        {
+            memcpy(res, &cached, sizeof(directory_entry_t));
+        }
+        return res;
+    }
+    case DCACHE_NEGATIVE:
+        return NULL;
+    default:
+        break;
+    }
+
+    directory_entry_t *direntry = find_entry_by_name(name, directory_cluster_num, boot_sector, dev);
+    dcache_insert(boot_sector, directory_cluster_num, key, direntry, direntry ? sizeof(directory_entry_t) : 0);
+    return direntry;
+}
+
+// keeps the dentry cache in line after the entry for name was rewritten, NULL for a deleted entry
+static void update_cached_entry(const char *name, uint32_t directory_cluster_num, const directory_entry_t *direntry, boot_sector_t *boot_sector)
+{
+    char key[FAT32_NAME_COMPARE + 1];
+    dcache_key(name, key);
+    dcache_insert(boot_sector, directory_cluster_num, key, direntry, direntry ? sizeof(directory_entry_t) : 0);
+}
+
 static int modify_direntry_in_directory(const char *name, uint32_t directory_cluster_num, directory_entry_t *new_direntry, boot_sector_t *boot_sector, virtual_blockdev_t *dev)
 {
     uint32_t current_cluster = directory_cluster_num;
@@ -625,6 +673,7 @@ static int modify_direntry_in_directory(const char *name, uint32_t directory_clu
             {
                 memcpy(&direntries[i], new_direntry, sizeof(directory_entry_t));
                 write_cluster(current_cluster, cluster_buf, boot_sector, dev);
+                kfree(cluster_buf);
                 return 0;
             }
         }
@@ -722,7 +771,7 @@ static directory_entry_t *direntry_from_path(const char *path, boot_sector_t *bo
     size_t current_cluster = boot_sector->bpb.root_cluster;
     while (pch != NULL)
     {
-        direntry = find_entry_by_name(pch, current_cluster, boot_sector, dev);
+        direntry = lookup_entry(pch, current_cluster, boot_sector, dev);
         if (!direntry)
         {
             kfree(path_cpy);
@@ -839,7 +888,7 @@ static int modify_direntry(const char *path, directory_entry_t *new_direntry, bo
     size_t current_cluster = boot_sector->bpb.root_cluster;
     while (pch != NULL)
     {
-        direntry = find_entry_by_name(pch, current_cluster, boot_sector, dev);
+        direntry = lookup_entry(pch, current_cluster, boot_sector, dev);
         if (!direntry)
         {
             kfree(new_path);
@@ -860,12 +909,15 @@ static int modify_direntry(const char *path, directory_entry_t *new_direntry, bo
         return -RES_EUNKNOWN;
     }
     
-    int status = modify_direntry_in_directory(path_end, first_cluster_from_direntry(direntry, boot_sector), new_direntry, boot_sector, dev);
+    uint32_t directory_cluster = first_cluster_from_direntry(direntry, boot_sector);
+    int status = modify_direntry_in_directory(path_end, directory_cluster, new_direntry, boot_sector, dev);
     if (status < 0)
     {
         return status;
     }
 
+    update_cached_entry(path_end, directory_cluster, new_direntry, boot_sector);
+
     kfree(path_end);
     if ((uintptr_t)direntry != 1)
     {
@@ -875,19 +927,6 @@ static int modify_direntry(const char *path, directory_entry_t *new_direntry, bo
     return 0;
 }
 
-static uint32_t find_last_cluster(uint32_t start_cluster, boot_sector_t *boot_sector, virtual_blockdev_t *dev)
-{
-    uint32_t current_cluster = start_cluster;
-    uint32_t next_cluster;
-
-    while ((next_cluster = read_fat_entry(current_cluster, boot_sector, dev)) < 0x0FFFFFF8)
-    {
-        current_cluster = next_cluster;
-    }
-
-    return current_cluster;
-}
-
 static uint32_t allocate_new_cluster(uint32_t last_cluster, boot_sector_t *boot_sector, virtual_blockdev_t *dev)
 {
     uint32_t fat_size = boot_sector->bpb.FAT_size_32;
@@ -977,159 +1016,475 @@ int new_direntry_in_cluster(const char *dir_path, directory_entry_t *new_direntr
     return 0;
 }
 
-int read_fat32(const char *path, boot_sector_t *boot_sector, virtual_blockdev_t *dev, size_t offset, size_t size, uint8_t *buffer)
+/*
+ one in-memory node per open file or directory, shared by every open of it so there is a single copy of the directory entry
+ it is resolved once at open, reads and writes go straight to the clusters and only rewrite the entry when it changed
+*/
+typedef struct _fat32_node
 {
-    directory_entry_t *direntry = direntry_from_path(path, boot_sector, dev);
-    if (direntry == NULL || (uintptr_t)direntry == 1)
+    boot_sector_t *boot_sector;
+    bool is_root; // the root directory has no entry of its own
+    bool deleted;
+    uint32_t dir_cluster; // first cluster of the directory holding the entry
+    char name[MAX_PATH]; // name of the entry within that directory
+    directory_entry_t entry;
+
+    // where the last read ended up in the cluster chain, sequential reads continue from there
+    size_t cursor_index;
+    uint32_t cursor_cluster;
+
+    size_t refcount;
+    struct _fat32_node *next;
+} fat32_node_t;
+
+static fat32_node_t *open_nodes = NULL;
+
+static uint32_t node_first_cluster(fat32_node_t *node)
+{
+    if (node->is_root)
     {
-        return -RES_EUNKNOWN;
+        return node->boot_sector->bpb.root_cluster;
     }
-    if ((direntry->attr & ATTR_DIRECTORY) == ATTR_DIRECTORY)
+    return first_cluster_from_direntry(&node->entry, node->boot_sector);
+}
+
+static fat32_node_t *node_get(const char *path, boot_sector_t *boot_sector, virtual_blockdev_t *dev)
+{
+    fat32_node_t *node = kmalloc(sizeof(fat32_node_t));
+    if (!node)
+    {
+        return NULL;
+    }
+    memset(node, 0, sizeof(fat32_node_t));
+    node->boot_sector = boot_sector;
+    node->refcount = 1;
+
+    // the vfs hands over normalized paths, only the root ends without a name
+    char *filename = get_filename(path);
+    if (!filename)
+    {
+        kfree(node);
+        return NULL;
+    }
+
+    if (filename[0] == '\0')
+    {
+        node->is_root = true;
+    }
+    else
     {
+        char *dirpath = get_parent_directory(path);
+        if (!dirpath)
+        {
+            kfree(filename);
+            kfree(node);
+            return NULL;
+        }
+
+        node->dir_cluster = first_cluster_from_path(dirpath, boot_sector, dev);
+        kfree(dirpath);
+
+        directory_entry_t *direntry = NULL;
+        if (node->dir_cluster >= 2 && node->dir_cluster < 0x0FFFFFF8)
+        {
+            direntry = lookup_entry(filename, node->dir_cluster, boot_sector, dev);
+        }
+
+        if (!direntry)
+        {
+            kfree(filename);
+            kfree(node);
+            return NULL;
+        }
+
+        strncpy(node->name, filename, MAX_PATH - 1);
+        memcpy(&node->entry, direntry, sizeof(directory_entry_t));
         kfree(direntry);
+    }
+    kfree(filename);
+
+    uint64_t flags = cpu_irq_save();
+    for (fat32_node_t *open = open_nodes; open; open = open->next)
+    {
+        if (open->boot_sector == boot_sector && !open->deleted && open->is_root == node->is_root && open->dir_cluster == node->dir_cluster && strncmp(open->name, node->name, FAT32_NAME_COMPARE) == 0)
+        {
+            // the fresh copy also has what a clear or create on the way to this open changed
+            memcpy(&open->entry, &node->entry, sizeof(directory_entry_t));
+            open->cursor_cluster = 0;
+            open->refcount++;
+            cpu_irq_restore(flags);
+            kfree(node);
+            return open;
+        }
+    }
+
+    node->next = open_nodes;
+    open_nodes = node;
+    cpu_irq_restore(flags);
+
+    return node;
+}
+
+static void node_put(fat32_node_t *node)
+{
+    uint64_t flags = cpu_irq_save();
+    if (--node->refcount > 0)
+    {
+        cpu_irq_restore(flags);
+        return;
+    }
+
+    fat32_node_t **link = &open_nodes;
+    while (*link && *link != node)
+    {
+        link = &(*link)->next;
+    }
+    if (*link)
+    {
+        *link = node->next;
+    }
+    cpu_irq_restore(flags);
+
+    kfree(node);
+}
+
+static int node_store(fat32_node_t *node, virtual_blockdev_t *dev)
+{
+    if (node->is_root || node->deleted)
+    {
+        return 0;
+    }
+
+    if (modify_direntry_in_directory(node->name, node->dir_cluster, &node->entry, node->boot_sector, dev) < 0)
+    {
         return -RES_EUNKNOWN;
     }
 
-    direntry->last_access_date = get_fat32_date();
-    if (modify_direntry(path, direntry, boot_sector, dev) < 0)
+    update_cached_entry(node->name, node->dir_cluster, &node->entry, node->boot_sector);
+    return 0;
+}
+
+// the access date only has day resolution, so most accesses do not write anything
+static int node_touch(fat32_node_t *node, virtual_blockdev_t *dev)
+{
+    uint16_t date = get_fat32_date();
+    if (node->is_root || node->entry.last_access_date == date)
+    {
+        return 0;
+    }
+
+    node->entry.last_access_date = date;
+    return node_store(node, dev);
+}
+
+static int node_read(fat32_node_t *node, virtual_blockdev_t *dev, size_t offset, size_t size, uint8_t *buffer)
+{
+    if (node->is_root || node->deleted || (node->entry.attr & ATTR_DIRECTORY) == ATTR_DIRECTORY)
     {
-        kfree(direntry);
         return -RES_EUNKNOWN;
     }
-    kfree(direntry);
 
-    uint32_t current_cluster = first_cluster_from_path(path, boot_sector, dev);
-    if (current_cluster == (uint32_t)-1)
+    if (node_touch(node, dev) < 0)
     {
         return -RES_EUNKNOWN;
     }
 
+    boot_sector_t *boot_sector = node->boot_sector;
     uint32_t bytes_per_cluster = boot_sector->bpb.sectors_per_cluster * boot_sector->bpb.bytes_per_sector;
-    uint8_t *cluster_buf = kmalloc(bytes_per_cluster);
 
-    uint32_t current_cluster_num = 0;
-    size_t buffer_index = 0;
+    size_t index = offset / bytes_per_cluster;
+    size_t current_index = 0;
+    uint32_t current_cluster = node_first_cluster(node);
 
-    while (current_cluster < 0x0FFFFFF8)
+    // read-ahead moves the cursor from the workqueue, so the pair is only touched as a whole
+    uint64_t flags = cpu_irq_save();
+    if (node->cursor_cluster && node->cursor_index <= index)
     {
-        uint32_t byte_offset = current_cluster_num * bytes_per_cluster;
-        if (offset >= byte_offset && offset < (byte_offset + bytes_per_cluster))
-        {
-            read_cluster(current_cluster, cluster_buf, boot_sector, dev);
-            uint32_t cluster_offset = offset - byte_offset;
-            size_t cpy_size = (size > (bytes_per_cluster - cluster_offset)) ? (bytes_per_cluster - cluster_offset) : size;
+        current_index = node->cursor_index;
+        current_cluster = node->cursor_cluster;
+    }
+    cpu_irq_restore(flags);
 
-            memcpy((void *)((uintptr_t)buffer + buffer_index), (void *)((uintptr_t)cluster_buf + cluster_offset), cpy_size);
-            buffer_index += cpy_size;
+    while (current_index < index && current_cluster < 0x0FFFFFF8)
+    {
+        current_cluster = read_fat_entry(current_cluster, boot_sector, dev);
+        current_index++;
+    }
 
-            if (buffer_index == size)
-            {
-                kfree(cluster_buf);
-                return 0;
-            }
+    uint8_t *cluster_buf = kmalloc(bytes_per_cluster);
+    if (!cluster_buf)
+    {
+        return -RES_NOMEM;
+    }
+
+    size_t done = 0;
+    size_t cluster_offset = offset % bytes_per_cluster;
+    while (done < size && current_cluster < 0x0FFFFFF8)
+    {
+        flags = cpu_irq_save();
+        node->cursor_index = current_index;
+        node->cursor_cluster = current_cluster;
+        cpu_irq_restore(flags);
+
+        size_t cpy_size = bytes_per_cluster - cluster_offset;
+        if (cpy_size > size - done)
+        {
+            cpy_size = size - done;
         }
-        else if (offset < byte_offset && (offset + size) >= (byte_offset + bytes_per_cluster))
+
+        if (cpy_size == bytes_per_cluster)
         {
-            read_cluster(current_cluster, cluster_buf, boot_sector, dev);
-            memcpy((void *)((uintptr_t)buffer + buffer_index), (void *)((uintptr_t)cluster_buf), bytes_per_cluster);
-            buffer_index += bytes_per_cluster;
+            read_cluster(current_cluster, buffer + done, boot_sector, dev);
         }
-        else if ((offset + size) >= byte_offset && (offset + size) < (byte_offset + bytes_per_cluster))
+        else
         {
             read_cluster(current_cluster, cluster_buf, boot_sector, dev);
-            memcpy((void *)((uintptr_t)buffer + buffer_index), cluster_buf, size - buffer_index);
-            kfree(cluster_buf);
-            return 0;
+            memcpy(buffer + done, cluster_buf + cluster_offset, cpy_size);
         }
 
-        current_cluster = read_fat_entry(current_cluster, boot_sector, dev);
-        current_cluster_num++;
+        done += cpy_size;
+        cluster_offset = 0;
+
+        if (done < size)
+        {
+            current_cluster = read_fat_entry(current_cluster, boot_sector, dev);
+            current_index++;
+        }
     }
 
     kfree(cluster_buf);
     return 0;
 }
 
-int write_fat32(const char *path, boot_sector_t *boot_sector, virtual_blockdev_t *dev, size_t size, const uint8_t *buffer)
+// overwrites from offset on and grows the file when the write ends past it
+static int node_write(fat32_node_t *node, virtual_blockdev_t *dev, size_t offset, size_t size, const uint8_t *buffer)
 {
-    directory_entry_t *direntry = direntry_from_path(path, boot_sector, dev);
-    if (direntry == NULL || (uintptr_t)direntry == 1)
+    if (node->is_root || node->deleted || (node->entry.attr & ATTR_DIRECTORY) == ATTR_DIRECTORY)
     {
         return -RES_EUNKNOWN;
     }
-    if ((direntry->attr & ATTR_DIRECTORY) == ATTR_DIRECTORY)
+
+    boot_sector_t *boot_sector = node->boot_sector;
+    uint32_t cluster_size = boot_sector->bpb.sectors_per_cluster * boot_sector->bpb.bytes_per_sector;
+
+    // a write past the end first fills the gap with zeros
+    if (offset > node->entry.file_size)
     {
-        kfree(direntry);
-        return -RES_EUNKNOWN;
+        uint8_t *zeros = kmalloc(cluster_size);
+        if (!zeros)
+        {
+            return -RES_NOMEM;
+        }
+        memset(zeros, 0, cluster_size);
+
+        while (offset > node->entry.file_size)
+        {
+            size_t gap = offset - node->entry.file_size;
+            if (node_write(node, dev, node->entry.file_size, gap < cluster_size ? gap : cluster_size, zeros) < 0)
+            {
+                kfree(zeros);
+                return -RES_EUNKNOWN;
+            }
+        }
+
+        kfree(zeros);
     }
 
-    size_t filesize = direntry->file_size;
-    uint32_t first_cluster = first_cluster_from_direntry(direntry, boot_sector);
+    if (size == 0)
+    {
+        return 0;
+    }
 
-    uint32_t cluster_size = boot_sector->bpb.sectors_per_cluster * boot_sector->bpb.bytes_per_sector;
-    uint32_t last_cluster = find_last_cluster(first_cluster, boot_sector, dev);
     uint8_t *cluster_buf = kmalloc(cluster_size);
     if (!cluster_buf)
     {
-        kfree(direntry);
-        return -RES_EUNKNOWN;
+        return -RES_NOMEM;
     }
 
-    size_t offset_in_cluster = filesize % cluster_size;
-    size_t space_in_cluster = cluster_size - offset_in_cluster;
-    size_t size_left = size;
-    size_t buf_index = 0;
+    // clusters past the end of the chain are allocated on the way, their old contents are never read
+    uint32_t cluster = node_first_cluster(node);
+    bool fresh = false;
+    for (size_t i = 0; i < offset / cluster_size; i++)
+    {
+        uint32_t next = read_fat_entry(cluster, boot_sector, dev);
+        fresh = next >= 0x0FFFFFF8;
+        if (fresh)
+        {
+            next = allocate_new_cluster(cluster, boot_sector, dev);
+        }
+        if (next >= 0x0FFFFFF8)
+        {
+            kfree(cluster_buf);
+            return -RES_EUNKNOWN;
+        }
+        cluster = next;
+    }
 
-    if (space_in_cluster > 0)
+    size_t done = 0;
+    size_t cluster_offset = offset % cluster_size;
+    while (done < size)
     {
-        read_cluster(last_cluster, cluster_buf, boot_sector, dev);
+        size_t to_copy = cluster_size - cluster_offset;
+        if (to_copy > size - done)
+        {
+            to_copy = size - done;
+        }
 
-        size_t to_copy = (size_left < space_in_cluster) ? size_left : space_in_cluster;
-        memcpy(cluster_buf + offset_in_cluster, buffer, to_copy);
+        if (to_copy < cluster_size)
+        {
+            if (fresh)
+            {
+                memset(cluster_buf, 0, cluster_size);
+            }
+            else
+            {
+                read_cluster(cluster, cluster_buf, boot_sector, dev);
+            }
+        }
+        memcpy(cluster_buf + cluster_offset, buffer + done, to_copy);
+        write_cluster(cluster, cluster_buf, boot_sector, dev);
 
-        write_cluster(last_cluster, cluster_buf, boot_sector, dev);
+        done += to_copy;
+        cluster_offset = 0;
 
-        buf_index += to_copy;
-        size_left -= to_copy;
+        if (done < size)
+        {
+            uint32_t next = read_fat_entry(cluster, boot_sector, dev);
+            fresh = next >= 0x0FFFFFF8;
+            if (fresh)
+            {
+                next = allocate_new_cluster(cluster, boot_sector, dev);
+            }
+            if (next >= 0x0FFFFFF8)
+            {
+                kfree(cluster_buf);
+                return -RES_EUNKNOWN;
+            }
+            cluster = next;
+        }
     }
 
-    while (size_left > 0)
+    kfree(cluster_buf);
+
+    if (offset + size > node->entry.file_size)
     {
-        last_cluster = allocate_new_cluster(last_cluster, boot_sector, dev);
-        if (last_cluster == (uint32_t)-1)
-        {
-            kfree(direntry);
-            kfree(cluster_buf);
-            return -RES_EUNKNOWN;
-        }
+        node->entry.file_size = offset + size;
+    }
+    node->entry.write_date = get_fat32_date();
+    node->entry.write_time = get_fat32_time();
+    node->entry.last_access_date = get_fat32_date();
 
-        size_t to_copy = (size_left < cluster_size) ? size_left : cluster_size;
-        memcpy(cluster_buf, buffer + buf_index, to_copy);
-        memset(cluster_buf + to_copy, 0, cluster_size - to_copy);
+    return node_store(node, dev);
+}
 
-        write_cluster(last_cluster, cluster_buf, boot_sector, dev);
+static size_t node_readdir(char *res, fat32_node_t *node, virtual_blockdev_t *dev, size_t index)
+{
+    if (!node->is_root && (node->deleted || (node->entry.attr & ATTR_DIRECTORY) != ATTR_DIRECTORY))
+    {
+        return 0;
+    }
 
-        buf_index += to_copy;
-        size_left -= to_copy;
+    if (!node->is_root)
+    {
+        index += 2; // skip . and ..
     }
 
-    kfree(cluster_buf);
+    if (node_touch(node, dev) < 0)
+    {
+        return 0;
+    }
 
-    direntry->file_size += size;
-    direntry->write_date = get_fat32_date();
-    direntry->write_time = get_fat32_time();
-    direntry->last_access_date = get_fat32_date();
+    char filename[256];
+    directory_entry_t *direntry = find_entry_by_index(index, node_first_cluster(node), filename, node->boot_sector, dev);
+    if (!direntry)
+    {
+        return 0;
+    }
 
-    if (modify_direntry(path, direntry, boot_sector, dev) < 0)
+    kfree(direntry);
+
+    strcpy(res, filename);
+    return strlen(filename);
+}
+
+static int node_delete(fat32_node_t *node, virtual_blockdev_t *dev)
+{
+    if (node->is_root || node->deleted || (node->entry.attr & ATTR_DIRECTORY) == ATTR_DIRECTORY)
     {
-        kfree(direntry);
         return -RES_EUNKNOWN;
     }
 
-    kfree(direntry);
+    boot_sector_t *boot_sector = node->boot_sector;
+    uint32_t first_cluster = node_first_cluster(node);
+    uint32_t current_cluster = first_cluster;
+    uint32_t next_cluster = 0;
+
+    while ((next_cluster = read_fat_entry(current_cluster, boot_sector, dev)) < 0x0FFFFFF8)
+    {
+        write_fat_entry(next_cluster, 0, boot_sector, dev);
+        current_cluster = next_cluster;
+    }
+    write_fat_entry(first_cluster, 0, boot_sector, dev);
+
+    directory_entry_t new_direntry;
+    new_direntry.name[0] = 0xE5;
+
+    if (modify_direntry_in_directory(node->name, node->dir_cluster, &new_direntry, boot_sector, dev) < 0)
+    {
+        return -RES_EUNKNOWN;
+    }
+
+    update_cached_entry(node->name, node->dir_cluster, NULL, boot_sector);
+
+    // later opens of the same name must not find this node anymore
+    node->deleted = true;
+    node->cursor_cluster = 0;
+
     return 0;
 }
 
+static void node_info(fat32_node_t *node, file_node_t *file)
+{
+    file->filesize = 0;
+    if (node->is_root)
+    {
+        file->flags = FS_DIRECTORY;
+        file->mask = MASK_SYSTEM;
+        return;
+    }
+
+    directory_entry_t *direntry = &node->entry;
+    file->creation_time = direntry->creation_time;
+    file->creation_date = direntry->creation_date;
+    file->write_time = direntry->write_time;
+    file->write_date = direntry->write_date;
+    file->last_access_date = direntry->last_access_date;
+
+    file->mask = 0;
+    if ((direntry->attr & ATTR_READ_ONLY) == ATTR_READ_ONLY)
+    {
+        file->mask |= MASK_READONLY;
+    }
+    if (direntry->attr & ATTR_HIDDEN)
+    {
+        file->mask |= MASK_HIDDEN;
+    }
+    if (direntry->attr & ATTR_SYSTEM)
+    {
+        file->mask |= MASK_SYSTEM;
+    }
+
+    if ((direntry->attr & ATTR_DIRECTORY) == ATTR_DIRECTORY)
+    {
+        file->flags = FS_DIRECTORY;
+    }
+    else
+    {
+        file->flags = FS_FILE;
+        file->filesize = direntry->file_size;
+    }
+}
+
 #define FS_FILE 0x01
 #define FS_DIRECTORY 0x02
 #define FS_SYMLINK 0x03
@@ -1217,47 +1572,6 @@ file_info_t *stat_fat32(file_info_t *file_info, const char *path, boot_sector_t
     return file_info;
 }
 
-size_t readdir_fat32(char *res, const char *path, size_t index, boot_sector_t *boot_sector, virtual_blockdev_t *dev)
-{
-    uint32_t cluster = first_cluster_from_path(path, boot_sector, dev);
-    if (cluster == (uint32_t)-1)
-    {
-        return 0;
-    }
-
-    if (cluster != boot_sector->bpb.root_cluster)
-    {
-        index += 2; // skip . and ..
-    }
-
-    if (strcmp(path, "/") != 0)
-    {
-        directory_entry_t *direntry = direntry_from_path(path, boot_sector, dev);
-        if (direntry == NULL)
-        {
-            return -RES_EUNKNOWN;
-        }
-        direntry->last_access_date = get_fat32_date();
-        if (modify_direntry(path, direntry, boot_sector, dev) < 0)
-        {
-            kfree(direntry);
-            return 0;
-        }
-    }
-
-    char filename[256];
-    directory_entry_t *direntry = find_entry_by_index(index, cluster, filename, boot_sector, dev);
-    if (!direntry)
-    {
-        return 0;
-    }
-
-    kfree(direntry);
-
-    strcpy(res, filename);
-    return strlen(filename);
-}
-
 int clear_fat32(const char *path, boot_sector_t *boot_sector, virtual_blockdev_t *dev)
 {
     directory_entry_t *direntry = direntry_from_path(path, boot_sector, dev);
@@ -1407,66 +1721,17 @@ int create_fat32(const char *path, uint32_t mask, uint32_t flags, boot_sector_t
         return -RES_EUNKNOWN;
     }
 
-    kfree(dirpath);
-    return 0;
-}
-
-int delete_fat32(const char *path, boot_sector_t *boot_sector, virtual_blockdev_t *dev)
-{
-    directory_entry_t *direntry = direntry_from_path(path, boot_sector, dev);
-    if (direntry == NULL || (uintptr_t)direntry == 1)
-    {
-        return -RES_EUNKNOWN;
-    }
-    if ((direntry->attr & ATTR_DIRECTORY) == ATTR_DIRECTORY)
-    {
-        kfree(direntry);
-        return -RES_EUNKNOWN;
-    }
-
-    uint32_t first_cluster = first_cluster_from_direntry(direntry, boot_sector);
-    uint32_t current_cluster = first_cluster;
-    uint32_t next_cluster = 0;
-
-    while ((next_cluster = read_fat_entry(current_cluster, boot_sector, dev)) < 0x0FFFFFF8)
-    {
-        write_fat_entry(next_cluster, 0, boot_sector, dev);
-        current_cluster = next_cluster;
-    }
-    write_fat_entry(first_cluster, 0, boot_sector, dev);
-    kfree(direntry);
-
-    char *dirpath = get_parent_directory(path);
-    if (!dirpath)
-    {
-        return -RES_EUNKNOWN;
-    }
-
-    uint32_t directory_cluster = first_cluster_from_path(dirpath, boot_sector, dev);
-    if (directory_cluster == 0)
-    {
-        kfree(dirpath);
-        return -RES_EUNKNOWN;
-    }
-    kfree(dirpath);
-
-    char *filename = get_filename(path);
-    if (!filename)
-    {
-        return -RES_EUNKNOWN;
-    }
-
-    directory_entry_t new_direntry;
-    new_direntry.name[0] = 0xE5;
-
-    if (modify_direntry_in_directory(filename, directory_cluster, &new_direntry, boot_sector, dev) < 0)
+    // drops the negative entry the existence check above left behind, the next lookup reads the name back from disk
+    filename = get_filename(path);
+    if (filename)
     {
+        char key[FAT32_NAME_COMPARE + 1];
+        dcache_key(filename, key);
+        dcache_remove(boot_sector, first_cluster_from_path(dirpath, boot_sector, dev), key);
         kfree(filename);
-        return -RES_EUNKNOWN;
     }
 
-    kfree(filename);
-    
+    kfree(dirpath);
     return 0;
 }
 
@@ -1477,49 +1742,62 @@ stream_t *fat32_open(const char *path, uint8_t action, mount_node_t *mount)
         return NULL;
     }
 
-    file_node_t *node = kmalloc(sizeof(file_node_t));
-    if (!node)
-    {
-        return NULL;
-    }
+    boot_sector_t *boot_sector = (boot_sector_t *)mount->fs_data;
 
     if (action == OPEN_ACTION_CREATE)
     {
-        if (create_fat32(path, 0, FS_FILE, (boot_sector_t *)mount->fs_data, mount->vbdev) < 0)
+        if (create_fat32(path, 0, FS_FILE, boot_sector, mount->vbdev) < 0)
         {
             return NULL;
         }
     }
     else if (action == OPEN_ACTION_CLEAR)
     {
-        if (clear_fat32(path, (boot_sector_t *)mount->fs_data, mount->vbdev) < 0)
+        if (clear_fat32(path, boot_sector, mount->vbdev) < 0)
         {
             return NULL;
         }
     }
-    
-    file_info_t info;
-    if (!stat_fat32(&info, path, (boot_sector_t *)mount->fs_data, mount->vbdev))
+
+    // the only path lookup for this file, everything after works on the node
+    fat32_node_t *fat_node = node_get(path, boot_sector, mount->vbdev);
+    if (!fat_node)
     {
         return NULL;
     }
 
-    node->filesize = info.filesize;
-    node->mask = info.mask;
-    node->creation_time = info.creation_time;
-    node->creation_date = info.creation_date;
-    node->write_time = info.write_time;
-    node->write_date = info.write_date;
-    node->last_access_date = info.last_access_date;
-    node->flags = info.flags;
-    node->_data = 0; // TODO: maybe cache cluster number here
+    if (node_touch(fat_node, mount->vbdev) < 0)
+    {
+        node_put(fat_node);
+        return NULL;
+    }
 
+    file_node_t *node = kmalloc(sizeof(file_node_t));
+    if (!node)
+    {
+        node_put(fat_node);
+        return NULL;
+    }
+
+    memset(node, 0, sizeof(file_node_t));
+    node_info(fat_node, node);
+
+    node->fs_node = fat_node;
+    node->ino = fat_node->is_root ? 0 : node_first_cluster(fat_node); // clusters of a file never move while it exists
     node->offset = 0;
     node->fs = mount->fs;
     node->mount = mount;
     strcpy(node->local_path, path);
 
-    return stream_create_file(node, mount);
+    stream_t *stream = stream_create_file(node, mount);
+    if (!stream)
+    {
+        kfree(node);
+        node_put(fat_node);
+        return NULL;
+    }
+
+    return stream;
 }
 
 int fat32_close(stream_t *stream)
@@ -1529,37 +1807,38 @@ int fat32_close(stream_t *stream)
         return -RES_EUNKNOWN;
     }
 
+    node_put((fat32_node_t *)stream->node->fs_node);
     kfree(stream->node);
 
     return 0;
 }
 
-int fat32_read(stream_t *stream, size_t size, uint8_t *buf)
+int fat32_read(stream_t *stream, size_t offset, size_t size, uint8_t *buf)
 {
-    if (read_fat32(stream->node->local_path, (boot_sector_t *)stream->mount->fs_data, stream->mount->vbdev, stream->node->offset, size, buf) < 0)
+    if (node_read((fat32_node_t *)stream->node->fs_node, stream->mount->vbdev, offset, size, buf) < 0)
     {
         return -RES_EUNKNOWN;
     }
 
-    stream->node->offset += size;
     return 0;
 }
 
-int fat32_write(stream_t *stream, size_t size, const uint8_t *buf)
+int fat32_write(stream_t *stream, size_t offset, size_t size, const uint8_t *buf)
 {
-    if (write_fat32(stream->node->local_path, (boot_sector_t *)stream->mount->fs_data, stream->mount->vbdev, size, buf) < 0)
+    fat32_node_t *fat_node = (fat32_node_t *)stream->node->fs_node;
+    if (node_write(fat_node, stream->mount->vbdev, offset, size, buf) < 0)
     {
         return -RES_EUNKNOWN;
     }
 
-    stream->node->offset += size;
+    stream->node->filesize = fat_node->entry.file_size;
     return 0;
 }
 
 int fat32_readdir(stream_t *stream, int index, char *path)
 {
     char filename[MAX_PATH];
-    if (readdir_fat32(filename, stream->node->local_path, (size_t)index, (boot_sector_t *)stream->mount->fs_data, stream->mount->vbdev) == 0)
+    if (node_readdir(filename, (fat32_node_t *)stream->node->fs_node, stream->mount->vbdev, (size_t)index) == 0)
     {
         return -RES_EUNKNOWN;
     }
@@ -1573,7 +1852,7 @@ int fat32_readdir(stream_t *stream, int index, char *path)
 
 int fat32_delete(stream_t *stream)
 {
-    if (delete_fat32(stream->node->local_path, (boot_sector_t *)stream->mount->fs_data, stream->mount->vbdev) < 0)
+    if (node_delete((fat32_node_t *)stream->node->fs_node, stream->mount->vbdev) < 0)
     {
         return -RES_EUNKNOWN;
     }
@@ -1599,6 +1878,7 @@ int fat32_free(virtual_blockdev_t *bdev, void *data)
         return -RES_EUNKNOWN;
     }
 
+    dcache_invalidate(data);
     free_fat((boot_sector_t *)data);
     return 0;
 }
@@ -25,8 +25,7 @@ int randomize_buffer(uint8_t *data, size_t size, device_t *dev)
 static void virtio_entropy_irq(interrupt_frame_t *frame)
 {
     (void)frame;
-    uint8_t isr_status = *(volatile uint8_t *)virtio_dev->isr;
-    (void)isr_status;
+    virtio_ack_interrupt(virtio_dev);
 }
 
 static uint32_t virtio_entropy_feature_negotiate(uint32_t features, virtio_device_t *device, bool *abort)
@@ -62,10 +61,8 @@ device_t *virtio_entropy_create(size_t index, pci_device_t *pci_dev)
 
     pci_enable_device(pci_dev);
 
-    register_interrupt_handler(42, &virtio_entropy_irq);
-
     virtio_dev = virtio_init(pci_dev, virtio_entropy_feature_negotiate);
-    vq = virtio_setup_queue(virtio_dev, 0);
+    vq = virtio_setup_queue(virtio_dev, 0, &virtio_entropy_irq);
     virtio_start(virtio_dev);
 
     return device;
@@ -3,6 +3,7 @@
 #include <kernel/kmm.h>
 #include <kernel/isr.h>
 #include <kernel/vec.h>
+#include <kernel/proc/workqueue.h>
 
 #define VIRTIO_NET_F_CSUM 0
 #define VIRTIO_NET_F_GUEST_CSUM 1
@@ -147,12 +148,32 @@ device_ops_t virtio_net_ops = {
     .send = &virtio_net_send,
 };
 
-static void virtio_net_irq(interrupt_frame_t *frame)
+static work_t receive_work;
+
+static device_t *net_device = NULL;
+
+static void virtio_net_receive(work_t *)
 {
     LOG_INFO("interrupt");
+
+    // nothing reads the packets yet, pollers only learn that something arrived
+    if (net_device)
+    {
+        device_notify(net_device);
+    }
+}
+
+static void virtio_net_receive_irq(interrupt_frame_t *frame)
+{
+    (void)frame;
+    virtio_ack_interrupt(virtio_dev);
+    work_queue(&receive_work);
+}
+
+static void virtio_net_transmit_irq(interrupt_frame_t *frame)
+{
     (void)frame;
-    uint8_t isr_status = *(volatile uint8_t *)virtio_dev->isr;
-    (void)isr_status;
+    virtio_ack_interrupt(virtio_dev);
 }
 
 device_t *virtio_net_create(size_t index, pci_device_t *pci_dev)
@@ -177,9 +198,6 @@ device_t *virtio_net_create(size_t index, pci_device_t *pci_dev)
 
     pci_enable_device(pci_dev);
 
-    register_interrupt_handler(42, &virtio_net_irq);
-    register_interrupt_handler(43, &virtio_net_irq);
-
     virtio_dev = virtio_init(pci_dev, virtio_video_feature_negotiate);
     if (!virtio_dev)
     {
@@ -188,19 +206,21 @@ device_t *virtio_net_create(size_t index, pci_device_t *pci_dev)
         return NULL;
     }
 
-    receive_queue = virtio_setup_queue(virtio_dev, 0);
+    work_init(&receive_work, &virtio_net_receive, NULL);
+    receive_queue = virtio_setup_queue(virtio_dev, 0, &virtio_net_receive_irq);
     if (!receive_queue)
     {
         return NULL;
     }
 
-    transmit_queue = virtio_setup_queue(virtio_dev, 1);
+    transmit_queue = virtio_setup_queue(virtio_dev, 1, &virtio_net_transmit_irq);
     if (!transmit_queue)
     {
         return NULL;
     }
 
     device_cfg = (virtio_net_config_t *)virtio_dev->device_cfg;
+    net_device = device;
 
     virtio_start(virtio_dev);
 
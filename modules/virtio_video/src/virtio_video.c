@@ -430,8 +430,7 @@ static uint32_t virtio_video_feature_negotiate(uint32_t features, virtio_device_
 static void virtio_video_irq(interrupt_frame_t *frame)
 {
     (void)frame;
-    uint8_t isr_status = *(volatile uint8_t *)virtio_dev->isr;
-    (void)isr_status;
+    virtio_ack_interrupt(virtio_dev);
 }
 
 extern driver_t virtio_video_driver;
@@ -464,8 +463,6 @@ device_t *virtio_video_create(size_t index, pci_device_t *pci_dev)
 
     pci_enable_device(pci_dev);
 
-    register_interrupt_handler(43, &virtio_video_irq);
-
     virtio_dev = virtio_init(pci_dev, virtio_video_feature_negotiate);
     if (!virtio_dev)
     {
@@ -473,7 +470,7 @@ device_t *virtio_video_create(size_t index, pci_device_t *pci_dev)
         return NULL;
     }
 
-    command_queue = virtio_setup_queue(virtio_dev, 0);
+    command_queue = virtio_setup_queue(virtio_dev, 0, &virtio_video_irq);
     if (!command_queue)
     {
         return NULL;
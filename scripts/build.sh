@@ -15,6 +15,9 @@ mkdir -p /tmp/hydra_root/mod
 mkdir -p /tmp/hydra_root/include
 mkdir -p /tmp/hydra_root/resources
 
+# syscall numbers and types for the kernel and libhydra come from kernel/syscalls/syscalls.tbl
+python3 gensyscalls.py
+
 cp -r ../kernel/include/* /tmp/hydra_root/include/
 
 for dir in ../modules/*/; do
@@ -34,18 +37,19 @@ pushd ../kernel
     cp build/kernel.elf /tmp/hydra_root/boot/hydrakernel
 popd
 
-for dir in ../libs/*/; do
-    if [ -d "$dir" ]; then
-        pushd $dir
-            lib=$(basename "$dir")
-            echo "Compiling $lib"
-            make build/$lib.a
-            cp build/$lib.a /tmp/hydra_root/lib/$lib.a
-            cp -r include/* /tmp/hydra_root/include
-        popd
-    fi
+# shared objects link against the ones they depend on, so the order matters
+for lib in libhydra libc libcanvas; do
+    pushd ../libs/$lib
+        echo "Compiling $lib"
+        make all
+        cp build/$lib.a /tmp/hydra_root/lib/$lib.a
+        cp build/$lib.so /tmp/hydra_root/lib/$lib.so
+        cp -r include/* /tmp/hydra_root/include
+    popd
 done
 
+cp ../libs/libc/build/crt0.o /tmp/hydra_root/lib/crt0.o
+
 for dir in ../apps/*/; do
     if [ -d "$dir" ]; then
         pushd $dir
@@ -0,0 +1,106 @@
+import os
+import sys
+
+
+ROOT: str = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+
+TABLE: str = os.path.join(ROOT, 'kernel', 'syscalls', 'syscalls.tbl')
+ABI: str = os.path.join(ROOT, 'kernel', 'syscalls', 'abi.h')
+
+KERNEL_HEADER: str = os.path.join(ROOT, 'kernel', 'include', 'kernel', 'proc', 'syscall_table.h')
+LIBHYDRA_HEADER: str = os.path.join(ROOT, 'libs', 'libhydra', 'include', 'hydra', 'syscalls.h')
+
+BANNER: str = '// generated by scripts/gensyscalls.py from kernel/syscalls/syscalls.tbl, do not edit\n'
+FLAGS: dict = {'noreturn': 'SYSCALL_FLAG_NORETURN'}
+
+
+def parse_table() -> list:
+    syscalls: list = []
+    with open(TABLE) as f:
+        for line_number, line in enumerate(f, 1):
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+
+            fields: list = line.split()
+            number: int = int(fields[0])
+            name: str = fields[1]
+            flags: list = fields[2:]
+
+            if number != len(syscalls):
+                print(f'error: {TABLE}:{line_number}: expected syscall {len(syscalls)}, got {number}')
+                sys.exit(1)
+
+            for flag in flags:
+                if flag not in FLAGS:
+                    print(f'error: {TABLE}:{line_number}: unknown flag "{flag}"')
+                    sys.exit(1)
+
+            syscalls.append((number, name, flags))
+
+    return syscalls
+
+
+def flags_expression(flags: list) -> str:
+    if not flags:
+        return '0'
+    return ' | '.join(FLAGS[flag] for flag in flags)
+
+
+def generate_kernel(syscalls: list, abi: str) -> str:
+    lines: list = [BANNER, '#ifndef _KERNEL_SYSCALL_TABLE_H', '#define _KERNEL_SYSCALL_TABLE_H', '',
+                   '#include <stdint.h>', '#include <stddef.h>', '']
+
+    for number, name, _ in syscalls:
+        lines.append(f'#define SYSCALL_{name.upper()} {number}')
+    lines += ['', f'#define SYSCALL_COUNT {len(syscalls)}', '', '#define SYSCALL_FLAG_NORETURN (1 << 0)', '']
+
+    lines.append('// X(number, name, flags) for every syscall in order')
+    lines.append('#define SYSCALL_TABLE(X) \\')
+    for number, name, flags in syscalls:
+        lines.append(f'    X({number}, {name}, {flags_expression(flags)}) \\')
+    lines += ['', '', abi.rstrip('\n'), '', '#endif', '']
+
+    return '\n'.join(lines)
+
+
+def generate_libhydra(syscalls: list, abi: str) -> str:
+    lines: list = [BANNER, '#ifndef _HYDRA_SYSCALLS_H', '#define _HYDRA_SYSCALLS_H 1', '',
+                   '#include <stdint.h>', '#include <stddef.h>', '']
+
+    for number, name, _ in syscalls:
+        lines.append(f'#define _SYSCALL_{name.upper()} {number}')
+    lines += ['', f'#define SYSCALL_COUNT {len(syscalls)}', '']
+
+    lines.append('// initializer for a table of names indexed by syscall number')
+    lines.append('#define SYSCALL_NAMES { \\')
+    for _, name, _ in syscalls:
+        lines.append(f'    "{name}", \\')
+    lines += ['}', '', abi.rstrip('\n'), '', '#endif', '']
+
+    return '\n'.join(lines)
+
+
+def write_if_changed(path: str, content: str) -> None:
+    # keeps timestamps so make does not rebuild everything on every run
+    if os.path.exists(path):
+        with open(path) as f:
+            if f.read() == content:
+                return
+
+    with open(path, 'w') as f:
+        f.write(content)
+    print(f'info: generated {os.path.relpath(path, ROOT)}')
+
+
+def main() -> None:
+    syscalls: list = parse_table()
+    with open(ABI) as f:
+        abi: str = f.read()
+
+    write_if_changed(KERNEL_HEADER, generate_kernel(syscalls, abi))
+    write_if_changed(LIBHYDRA_HEADER, generate_libhydra(syscalls, abi))
+
+
+if __name__ == '__main__':
+    main()